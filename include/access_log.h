@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <unordered_map>
+#include <cstdint>
+
+// Formato em disco: cabeçalho de 16 bytes seguido de registros de tamanho fixo (little-endian).
+// Os caminhos ficam em um dicionário à parte (<arquivo>.paths, um por linha, id = número da
+// linha) compartilhado por todos os arquivos rotacionados.
+constexpr char kAccessLogMagic[4] = {'C', 'S', 'A', 'L'};
+constexpr uint32_t kAccessLogVersion = 1;
+constexpr uint32_t kAccessLogOtherPath = UINT32_MAX;    // Dicionário cheio
+
+struct AccessLogHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+};
+
+struct AccessRecord {
+    uint64_t timestampUs = 0;   // Início da requisição (Unix, µs)
+    uint8_t address[16] = {};   // IPv6; IPv4 mapeado (::ffff:a.b.c.d)
+    uint64_t bytesSent = 0;     // Headers + corpo da resposta
+    uint32_t pathId = kAccessLogOtherPath;
+    uint32_t headerUs = 0;      // Recepção dos headers
+    uint32_t handlerUs = 0;     // Parse, corpo e handler
+    uint32_t sendUs = 0;        // Envio da resposta
+    uint16_t status = 0;
+    uint8_t method = 0;         // HttpMethod
+    uint8_t flags = 0;          // kAccessFlag*
+    uint32_t reserved[3] = {};  // Campos futuros sem mudar o tamanho do registro
+};
+
+constexpr uint8_t kAccessFlagKeepAlive = 1;
+constexpr uint8_t kAccessFlagHttp2 = 2;
+
+static_assert(sizeof(AccessLogHeader) == 16, "layout do cabeçalho");
+static_assert(sizeof(AccessRecord) == 64, "layout do registro");
+
+struct AccessLogConfig {
+    std::string path;                           // Vazio desativa o log de acesso
+    uint64_t maxFileBytes = 64 * 1024 * 1024;   // Rotação: path -> path.1 -> ... -> path.<maxFiles>
+    int maxFiles = 5;
+    size_t maxPaths = 65536;                    // Além disso os caminhos novos viram kAccessLogOtherPath
+    size_t maxPendingRecords = 1 << 16;         // Escrita atrasada: registros além disso são descartados
+};
+
+// Log de acesso binário. record() só copia o registro para o lote em memória; uma thread
+// grava os lotes com um write por vez e faz a rotação por tamanho.
+class AccessLog {
+public:
+    explicit AccessLog(const AccessLogConfig& config);
+    ~AccessLog();
+
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+
+    bool enabled() const;
+    // `address` textual (IPv4 ou IPv6); o caminho é convertido no id do dicionário
+    void record(AccessRecord& record, const std::string& path, const std::string& address);
+
+    uint64_t droppedRecords() const;
+
+    // Compartilhado com access-log-query, que não liga com esta classe
+    static std::string pathsFile(const std::string& logPath) { return logPath + ".paths"; }
+
+private:
+    void loadPaths();
+    uint32_t internPath(const std::string& path);
+    bool openCurrent();
+    void rotate();
+    void writerLoop();
+
+    AccessLogConfig config_;
+    bool enabled_ = false;
+    int fd_ = -1;                               // Só a thread de escrita usa depois da abertura
+    uint64_t fileBytes_ = 0;
+    int pathsFd_ = -1;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<AccessRecord> pending_;
+    std::unordered_map<std::string, uint32_t> pathIds_;
+    std::string newPaths_;                      // Linhas do dicionário ainda não gravadas
+    bool stopping_ = false;
+    std::atomic<uint64_t> dropped_{0};
+    std::thread writer_;
+};
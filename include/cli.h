@@ -12,9 +12,14 @@ public:
     std::string getStringOption(const std::string& option, const std::string& defaultValue = "") const;
     int getIntOption(const std::string& option, int defaultValue = 0) const;
     
+    // Arquivo de configuração com linhas "opção = valor" (nomes das opções longas sem "--",
+    // flags sem valor ou com true/false). A linha de comando tem precedência sobre o arquivo.
+    bool loadConfigFile(const std::string& path, std::string& error);
+    
 private:
     std::vector<std::string> args_;
     std::unordered_map<std::string, std::string> options_;
+    std::unordered_map<std::string, std::string> fileOptions_;
     
     void parseArguments();
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <unordered_map>
+#include <cstdint>
+#include "connection.h"
+
+struct ClientLimitsConfig {
+    size_t maxHeaderBytes = 16 * 1024;      // Linha de requisição + headers
+    size_t maxHeaderCount = 100;
+    uint32_t minReceiveRate = 512;          // Bytes/s enquanto aguarda headers ou corpo; 0 desativa
+    uint32_t minSendRate = 512;             // Bytes/s confirmados pelo cliente com resposta pendente; 0 desativa
+    int rateWindowSeconds = 5;              // Janela de medição das taxas
+    size_t maxConnectionsPerIp = 256;       // 0 desativa
+};
+
+struct ClientGuardStats {
+    uint64_t slowReceiveCut = 0;
+    uint64_t slowSendCut = 0;
+    uint64_t perIpRejected = 0;
+    uint64_t headerLimitRejected = 0;
+    size_t trackedAddresses = 0;
+};
+
+// Proteção contra clientes lentos (slowloris) na camada de conexão. Limita conexões por IP na
+// aceitação e vigia as conexões em atendimento: uma thread lê TCP_INFO de cada uma por segundo
+// e corta as que, dentro de uma janela, recebem ou confirmam menos bytes que o piso. O caminho
+// das requisições não paga nada além do registro da conexão.
+class ClientGuard {
+public:
+    explicit ClientGuard(const ClientLimitsConfig& config = {});
+    ~ClientGuard();
+
+    ClientGuard(const ClientGuard&) = delete;
+    ClientGuard& operator=(const ClientGuard&) = delete;
+
+    // Reserva uma vaga para o IP da conexão (devolvida quando ela é destruída); false acima do limite
+    bool admit(Connection& connection);
+
+    // Conexões nas threads trabalhadoras
+    void track(Connection& connection);
+    void untrack(Connection& connection);
+    size_t tracked() const;
+
+    // Prazo do encerramento gracioso esgotado: shutdown nos dois sentidos de todas
+    size_t cutAll();
+
+    const ClientLimitsConfig& config() const;
+    void countHeaderRejection();
+    ClientGuardStats stats() const;
+
+private:
+    enum class Direction : uint8_t { None, Receive, Send };
+
+    struct RateWindow {
+        Direction direction = Direction::None;
+        uint64_t baseBytes = 0;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    void watchLoop();
+    void sweep();
+
+    ClientLimitsConfig config_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Connection*, RateWindow> active_;
+
+    std::shared_ptr<std::mutex> addressMutex_;      // Compartilhados com as vagas das conexões
+    std::shared_ptr<std::unordered_map<std::string, size_t>> addresses_;
+
+    std::atomic<uint64_t> slowReceiveCut_;
+    std::atomic<uint64_t> slowSendCut_;
+    std::atomic<uint64_t> perIpRejected_;
+    std::atomic<uint64_t> headerLimitRejected_;
+
+    std::mutex watchMutex_;
+    std::condition_variable watchCondition_;
+    bool stopping_ = false;
+    std::thread watchThread_;
+};
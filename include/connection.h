@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include "timer_wheel.h"
+
+typedef int SOCKET;
+
+class Http2Session;
+
+// Estado de uma conexão cliente que sobrevive entre requisições keep-alive.
+// A conexão é dona do socket e o fecha ao ser destruída.
+struct Connection {
+    explicit Connection(SOCKET socket);
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // Entrega o socket a outro dono (ex.: hub WebSocket); a conexão deixa de fechá-lo
+    SOCKET release();
+
+    // recv marcando a conexão como aguardando o cliente (base do piso de taxa de recepção)
+    long receive(void* buffer, size_t length);
+
+    SOCKET socket;
+    std::string peerAddress;                // IP do cliente, para limites e logs
+    std::shared_ptr<void> addressSlot;      // Vaga do IP no ClientGuard, devolvida na destruição
+    int requestCount = 0;
+    uint8_t lane = 0;        // Faixa de prioridade da próxima requisição (RequestLanes)
+    bool tlsPending = false; // Aceita num endereço TLS e ainda sem handshake
+    bool tls = false;        // Handshake concluído: o kernel cifra o tráfego
+    std::string readBuffer;  // Bytes já recebidos e ainda não consumidos (pipelining)
+    TimerWheel::TimerId idleTimer = TimerWheel::kInvalidTimer;
+    std::chrono::milliseconds idleTimeout{0};   // Espera no event loop; 0 usa a do keep-alive
+    // Sessão HTTP/2 sem streams abertos, retomada quando o cliente voltar a enviar
+    std::unique_ptr<Http2Session> http2;
+    std::atomic<bool> receiving{false};
+};
@@ -1,35 +1,61 @@
 #pragma once
 
-#include <queue>
+#include <deque>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
 #include <memory>
 #include <atomic>
+#include "connection.h"
 
-#ifdef _WIN32
-    #include <winsock2.h>
-    typedef SOCKET SOCKET;
-#else
-    typedef int SOCKET;
-#endif
+class RequestLanes;
 
+// Fila de conexões para as threads trabalhadoras. Sem faixas é FIFO; com faixas (RequestLanes)
+// cada uma tem sua fila e pop() escolhe entre elas por deficit round robin, pulando as que
+// estão no limite de atendimento simultâneo.
 class ConnectionQueue {
 public:
-    explicit ConnectionQueue(size_t maxSize);
+    explicit ConnectionQueue(size_t maxSize, std::shared_ptr<RequestLanes> lanes = nullptr);
     
-    bool push(SOCKET socket, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
-    bool pop(SOCKET& socket, std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+    // push só assume a posse da conexão quando retorna true
+    bool push(std::unique_ptr<Connection>& connection, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    bool pop(std::unique_ptr<Connection>& connection, std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+    // Retira tudo sem passar pelo agendamento (nem reservar vaga na faixa), para reenfileirar
+    std::vector<std::unique_ptr<Connection>> takeAll();
     
     size_t size() const;
     size_t maxSize() const;
     bool empty() const;
     void shutdown();
+    // Volta a aceitar conexões depois de shutdown()
+    void reopen();
+    // Descarta (fecha) as conexões ainda na fila; retorna quantas
+    size_t clear();
+    // Uma faixa liberou vaga de atendimento: acorda quem espera em pop()
+    void notify();
 
 private:
+    struct Entry {
+        std::unique_ptr<Connection> connection;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+    
+    struct Lane {
+        std::deque<Entry> entries;
+        int64_t deficit = 0;        // Crédito DRR em microssegundos de atendimento
+    };
+    
+    // Chamados com mutex_ travado
+    bool ready() const;
+    bool takeNext(std::unique_ptr<Connection>& connection);
+    
     mutable std::mutex mutex_;
     std::condition_variable condition_;
-    std::queue<SOCKET> queue_;
+    std::shared_ptr<RequestLanes> laneConfig_;
+    std::vector<Lane> lanes_;       // Uma só sem faixas configuradas
+    size_t size_;
+    size_t current_;                // Faixa em atendimento no DRR
     size_t maxSize_;
     std::atomic<bool> shutdown_;
 };
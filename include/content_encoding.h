@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <condition_variable>
+#include <unordered_map>
+
+enum class ContentEncoding {
+    Identity,
+    Gzip,
+    Brotli
+};
+
+struct CompressionConfig {
+    bool enabled = true;
+    size_t minFileSize = 256;               // Arquivos menores não compensam o header extra
+    size_t maxFileSize = 8 * 1024 * 1024;   // Acima disso o arquivo é enviado sem compressão
+    size_t cacheBytes = 64 * 1024 * 1024;
+    int gzipLevel = 9;
+    int brotliQuality = 9;
+};
+
+const char* contentEncodingName(ContentEncoding encoding);
+const char* contentEncodingExtension(ContentEncoding encoding);
+
+bool isEncodingSupported(ContentEncoding encoding);
+bool isCompressibleMimeType(const std::string& mimeType);
+
+// Escolhe a melhor codificação aceita pelo cliente (maior q; br vence empates)
+ContentEncoding negotiateEncoding(const std::string& acceptEncoding, bool allowBrotli, bool allowGzip);
+
+bool compressContent(const char* input, size_t inputSize, ContentEncoding encoding,
+                     const CompressionConfig& config, std::string& output);
+
+// Cache LRU de variantes comprimidas, limitado em bytes e indexado por caminho+ETag+codificação.
+// Falhas simultâneas na mesma variante geram uma única compressão; as demais threads aguardam.
+class CompressionCache {
+public:
+    struct Flight;
+
+    explicit CompressionCache(size_t maxBytes);
+
+    std::shared_ptr<const std::string> get(const std::string& path, const std::string& etag, ContentEncoding encoding);
+    void put(const std::string& path, const std::string& etag, ContentEncoding encoding,
+             std::shared_ptr<const std::string> content);
+
+    // O primeiro a chamar vira líder (`leader` = true) e deve chamar complete(), mesmo se falhar
+    std::shared_ptr<Flight> join(const std::string& path, const std::string& etag, ContentEncoding encoding,
+                                 bool& leader);
+    void complete(const std::string& path, const std::string& etag, ContentEncoding encoding,
+                  const std::shared_ptr<Flight>& flight, std::shared_ptr<const std::string> content);
+    // nullptr quando a compressão do líder falhou
+    std::shared_ptr<const std::string> wait(const std::shared_ptr<Flight>& flight);
+
+    // Novo limite em bytes; o excedente é descartado na hora
+    void setCapacity(size_t maxBytes);
+
+    size_t sizeBytes() const;
+    size_t entries() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> content;
+    };
+
+    static std::string makeKey(const std::string& path, const std::string& etag, ContentEncoding encoding);
+    void evict();
+
+    mutable std::mutex mutex_;
+    std::atomic<size_t> maxBytes_;
+    size_t currentBytes_ = 0;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+struct DocumentEntry {
+    std::string filePath;   // Caminho no sistema de arquivos, já resolvido a partir da raiz
+    const char* mimeType;
+    bool compressible;
+
+    // Metadados do momento da varredura (zerados para entradas resolvidas sob demanda)
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    uint64_t inode = 0;
+    std::string etag{};
+
+    bool matches(uint64_t inode, uint64_t size, int64_t mtimeNs) const;
+};
+
+// Índice da raiz de documentos construído na inicialização: caminho de URL normalizado -> arquivo.
+// Leituras não bloqueiam; rebuild() e loadSnapshot() trocam o índice inteiro de forma atômica.
+class DocumentIndex {
+public:
+    explicit DocumentIndex(const std::string& documentRoot);
+
+    // Varre a raiz em paralelo (lstat de cada arquivo; links para diretório não são descidos)
+    // e publica o novo índice
+    void rebuild(size_t threads = 1);
+
+    // Snapshot binário compacto (caminhos, tamanhos, mtimes, inodes/ETags) para reinícios rápidos
+    bool saveSnapshot(const std::string& snapshotPath) const;
+    bool loadSnapshot(const std::string& snapshotPath);
+
+    // `path` deve estar normalizado (normalizeRequestPath). Caminhos fora do índice
+    // (ex.: arquivos criados depois da varredura) resolvem direto no sistema de arquivos.
+    std::shared_ptr<const DocumentEntry> resolve(const std::string& path) const;
+
+    // Entradas atuais, para pré-carregamento
+    std::vector<std::shared_ptr<const DocumentEntry>> entries() const;
+
+    size_t size() const;
+
+private:
+    using Tree = std::unordered_map<std::string, DocumentEntry>;
+
+    DocumentEntry makeEntry(std::string filePath) const;
+    DocumentEntry makeEntry(std::string filePath, uint64_t size, int64_t mtimeNs, uint64_t inode) const;
+
+    std::string documentRoot_;
+    std::shared_ptr<const Tree> tree_;
+};
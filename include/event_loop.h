@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include "connection.h"
+#include "timer_wheel.h"
+
+// Loop de eventos (epoll) que mantém conexões keep-alive ociosas sem ocupar
+// uma thread trabalhadora e dirige o timing wheel de timeouts.
+class EventLoop {
+public:
+    using ReadyCallback = std::function<void(std::unique_ptr<Connection>)>;
+
+    EventLoop(std::chrono::milliseconds idleTimeout, ReadyCallback onReady);
+    ~EventLoop();
+
+    void start();
+    void stop();
+
+    // Estaciona uma conexão até chegar a próxima requisição ou expirar o timeout ocioso
+    void park(std::unique_ptr<Connection> connection);
+    // Encerramento gracioso: fecha as conexões ociosas e passa a fechar as que chegarem;
+    // retorna quantas estavam ociosas no momento
+    size_t closeIdle();
+
+    // Vale para as conexões estacionadas a partir de agora
+    void setIdleTimeout(std::chrono::milliseconds idleTimeout);
+
+    TimerWheel& timers();
+    size_t parkedConnections() const;
+
+private:
+    void run();
+    void drainIncoming();
+    void watch(std::unique_ptr<Connection> connection);
+    std::unique_ptr<Connection> unwatch(Connection* connection);
+    void wakeup();
+
+    std::atomic<std::chrono::milliseconds> idleTimeout_;
+    ReadyCallback onReady_;
+    TimerWheel timers_;
+
+    int epollFd_;
+    int wakeFd_;
+    std::atomic<bool> running_;
+    std::atomic<bool> closingIdle_;
+    std::thread thread_;
+
+    std::mutex incomingMutex_;
+    std::vector<std::unique_ptr<Connection>> incoming_;
+
+    // Acessado apenas pela thread do loop
+    std::unordered_map<Connection*, std::unique_ptr<Connection>> parked_;
+    std::atomic<size_t> parkedCount_;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+using HeaderList = std::vector<std::pair<std::string, std::string>>;
+
+// Decodificador HPACK (RFC 7541): tabela estática, tabela dinâmica e strings Huffman.
+// Um por conexão: a tabela dinâmica acompanha os blocos na ordem em que chegam.
+class HpackDecoder {
+public:
+    explicit HpackDecoder(size_t maxTableSize = 4096);
+
+    // false em bloco malformado; a tabela fica inconsistente e a conexão deve ser encerrada.
+    // Cada campo conta nome + valor + 32 bytes (RFC 7541, 4.1): passado `maxListBytes`, os campos
+    // seguintes só atualizam a tabela, `tooLarge` fica true e a lista sai incompleta
+    bool decode(const uint8_t* data, size_t length, size_t maxListBytes, HeaderList& headers, bool& tooLarge);
+
+private:
+    bool lookup(uint64_t index, std::string& name, std::string* value) const;
+    bool validIndex(uint64_t index) const;
+    void insert(const std::string& name, const std::string& value);
+    void evict(size_t limit);
+
+    std::deque<std::pair<std::string, std::string>> dynamic_;   // Mais recente na frente
+    size_t tableBytes_ = 0;
+    size_t tableLimit_;
+    size_t maxTableSize_;
+};
+
+// Codificador sem tabela dinâmica: campos da tabela estática saem indexados e os demais como
+// literais sem indexação (Huffman quando encurta). Sem estado, os blocos podem sair em qualquer ordem.
+class HpackEncoder {
+public:
+    // Atualização do tamanho da tabela para zero, no início do primeiro bloco da conexão
+    static void encodeTableSizeZero(std::string& out);
+    static void encode(const std::string& name, const std::string& value, std::string& out);
+};
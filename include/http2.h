@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <deque>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "connection.h"
+#include "timer_wheel.h"
+#include "hpack.h"
+#include "stream_buffers.h"
+
+struct HttpRequest;
+struct HttpResponse;
+
+struct Http2Config {
+    bool enabled = true;
+    uint32_t maxConcurrentStreams = 100;
+    uint32_t initialWindowSize = 1024 * 1024;           // Janela de recepção anunciada por stream
+    uint32_t connectionWindowSize = 16 * 1024 * 1024;   // Janela de recepção da conexão
+    size_t maxHeaderListBytes = 64 * 1024;
+    int timeoutSeconds = 30;                            // Sem tráfego nem dados a enviar: GOAWAY e fim
+    uint32_t maxResets = 200;                           // Streams resetados por janela de 10 s; acima
+                                                        // disso GOAWAY com ENHANCE_YOUR_CALM
+};
+
+// Sessão HTTP/2 em texto claro (h2c) sobre uma conexão. Os streams são atendidos conforme os
+// headers chegam; as respostas saem intercaladas em frames DATA por round-robin ponderado,
+// respeitando as janelas de fluxo. Sem streams abertos a sessão solta a thread trabalhadora:
+// fica guardada na conexão, que espera no event loop como uma keep-alive ociosa.
+class Http2Session {
+public:
+    using RequestHandler = std::function<void(HttpRequest&, HttpResponse&)>;
+    // Maior corpo que o stream pode acumular, decidido quando os headers chegam
+    using BodyLimit = std::function<uint64_t(const HttpRequest&)>;
+
+    // Com `draining` ligado a sessão envia GOAWAY, recusa novos streams e termina com os atuais.
+    // Trechos de arquivo lidos para os frames DATA e corpos recebidos contam em `buffers`.
+    Http2Session(Connection& connection, TimerWheel& timers, const Http2Config& config, StreamBuffers& buffers,
+                 BodyLimit bodyLimit, RequestHandler handler, const std::atomic<bool>* draining = nullptr);
+    ~Http2Session();
+
+    Http2Session(const Http2Session&) = delete;
+    Http2Session& operator=(const Http2Session&) = delete;
+
+    // Linha "PRI * HTTP/2.0" recebida pelo parser HTTP/1.1: início do prefácio do cliente
+    static bool isPreface(const std::string& requestHead);
+
+    // Upgrade h2c: aplica o header HTTP2-Settings; false se for inválido (nada foi enviado)
+    bool acceptUpgrade(const std::string& settingsHeader);
+    // Registra a requisição do upgrade como stream 1; só depois de o 101 ter saído
+    void adoptUpgradeRequest(HttpRequest& request);
+
+    // `upgraded`: o cliente ainda envia o prefácio inteiro; senão só falta "SM\r\n\r\n".
+    // Retorna true quando a sessão ficou ociosa e a conexão deve voltar ao event loop
+    bool serve(bool upgraded);
+    // Sessão estacionada que recebeu bytes do cliente; mesmo retorno de serve()
+    bool resume();
+
+private:
+    struct Stream;
+
+    bool run();
+    bool processInput();
+    bool handleFrame(uint8_t type, uint8_t flags, uint32_t streamId, const uint8_t* payload, size_t length);
+    bool handleHeaders(uint8_t flags, uint32_t streamId, const uint8_t* payload, size_t length);
+    bool handleData(uint8_t flags, uint32_t streamId, const uint8_t* payload, size_t length);
+    bool handleSettings(uint8_t flags, uint32_t streamId, const uint8_t* payload, size_t length);
+    bool handleWindowUpdate(uint32_t streamId, const uint8_t* payload, size_t length);
+    bool finishHeaderBlock();
+    bool applySettings(const uint8_t* payload, size_t length);
+
+    Stream* openStream(uint32_t id, uint16_t weight);
+    void completeRequest(Stream& stream);
+    void prepareResponse(Stream& stream);
+    // Resposta de erro sem chamar o handler; o que ainda vier do corpo é descartado
+    void respondEarly(Stream& stream, int statusCode, const char* statusText);
+    void resetStream(uint32_t id, uint32_t errorCode);
+    // Stream encerrado sem resposta (RST_STREAM de qualquer lado); false acima do limite da janela
+    bool countReset();
+    bool connectionError(uint32_t errorCode);
+    void appendGoAway(uint32_t errorCode);
+
+    bool hasSendableData() const;
+    bool writeRound();
+
+    Connection& connection_;
+    TimerWheel& timers_;
+    Http2Config config_;
+    StreamBuffers& buffers_;
+    BodyLimit bodyLimit_;
+    RequestHandler handler_;
+    const std::atomic<bool>* draining_;
+    HpackDecoder decoder_;
+
+    std::map<uint32_t, std::unique_ptr<Stream>> streams_;
+    std::string input_;
+    std::string control_;                   // Frames de controle aguardando a próxima escrita
+    size_t prefaceRemaining_ = 0;
+    const char* prefaceTail_ = nullptr;
+
+    int64_t sendWindow_ = 65535;            // Janela de envio da conexão
+    int64_t receiveWindow_;
+    int64_t peerInitialWindow_ = 65535;
+    uint32_t peerMaxFrameSize_ = 16384;
+    uint32_t lastStreamId_ = 0;
+    uint32_t resets_ = 0;
+    std::chrono::steady_clock::time_point resetWindowStart_;
+
+    uint32_t continuationStream_ = 0;       // Bloco de headers aguardando CONTINUATION
+    std::string headerBlock_;
+    bool headerEndStream_ = false;
+    uint16_t headerWeight_ = 16;
+
+    bool settingsReceived_ = false;
+    bool tableSizeSent_ = false;
+    bool goawayReceived_ = false;
+    bool goawaySent_ = false;
+    bool closing_ = false;
+    bool parked_ = false;                   // No event loop: a destruição por ociosidade avisa com GOAWAY
+};
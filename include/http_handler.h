@@ -1,55 +1,237 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <ctime>
 #include <unordered_map>
 #include <memory>
+#include <atomic>
 #include <chrono>
-
-#ifdef _WIN32
-    #include <winsock2.h>
-    typedef SOCKET SOCKET;
-#else
-    typedef int SOCKET;
-#endif
+#include <thread>
+#include <functional>
+#include "connection.h"
+#include "timer_wheel.h"
+#include "content_encoding.h"
+#include "mapped_file.h"
+#include "document_index.h"
+#include "proxy_handler.h"
+#include "response_cache.h"
+#include "router.h"
+#include "request_body.h"
+#include "http2.h"
+#include "websocket.h"
+#include "client_guard.h"
+#include "access_log.h"
+#include "rate_limiter.h"
+#include "socket_options.h"
+#include "worker_dispatcher.h"
+#include "stream_buffers.h"
+#include "tls_context.h"
 
 struct HttpRequest {
     std::string method;
-    std::string path;
+    HttpMethod methodId = HttpMethod::Other;
+    std::string path;       // Normalizado, sem query string
+    std::string query;
     std::string version;
     std::unordered_map<std::string, std::string> headers;
-    std::string body;
+    std::string body;       // Preenchido antes do handler, exceto em rotas com streaming
+    BodyReader* bodyReader = nullptr;
     bool keepAlive = false;
 };
 
+struct FileSegment {
+    std::string prefix;     // Bytes enviados antes do trecho (ex.: cabeçalho de parte multipart)
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+// Corpo enviado direto do arquivo: por writev a partir do mapeamento quando houver,
+// senão via sendfile. Fecha o descritor ao ser destruído.
+struct FileBody {
+    explicit FileBody(int fd);
+    ~FileBody();
+    
+    FileBody(const FileBody&) = delete;
+    FileBody& operator=(const FileBody&) = delete;
+    
+    uint64_t contentLength() const;
+    
+    int fd;
+    // Só vai ao kernel (writev): leituras em espaço de usuário usam `fd`, já que um arquivo
+    // truncado depois do mmap geraria SIGBUS
+    std::shared_ptr<const MappedFile> mapping;
+    std::vector<FileSegment> segments;
+    std::string trailer;
+};
+
 struct HttpResponse {
     int statusCode = 200;
     std::string statusText = "OK";
     std::unordered_map<std::string, std::string> headers;
     std::string body;
+    std::shared_ptr<const std::string> sharedBody;  // Corpo compartilhado sem cópia (ex.: variante em cache)
+    std::unique_ptr<FileBody> file;                 // Enviado depois de `body`, quando presente
+    // Corpo de tamanho desconhecido: chamado até retornar false, cada bloco sai como um chunk
+    std::function<bool(std::string& chunk)> stream;
+    // Chamado depois do envio (ex.: 101 do WebSocket): assume a conexão, que não volta ao keep-alive
+    std::function<void(Connection&)> takeover;
 };
 
 struct KeepAliveConfig {
-    int timeoutSeconds = 5;
+    int timeoutSeconds = 5;         // Tempo ocioso máximo entre requisições
     int maxRequests = 100;
+    int headerTimeoutSeconds = 10;  // Prazo para receber os headers completos
+    int requestTimeoutSeconds = 60; // Prazo para ler a requisição e montar a resposta; o envio tem
+                                    // prazo por janela (StreamingConfig)
+};
+
+struct PreloadConfig {
+    bool enabled = true;
+    size_t threads = 4;                         // Threads da varredura e do pré-carregamento
+    uint64_t maxFileSize = 1024 * 1024;         // Só arquivos até este tamanho são pré-carregados
+    size_t maxTotalBytes = 64 * 1024 * 1024;
+    std::string snapshotPath;                   // Vazio desativa o snapshot do índice
+};
+
+struct HandlerConfig {
+    KeepAliveConfig keepAlive;
+    CompressionConfig compression;
+    MappedFileConfig mappedFiles;
+    PreloadConfig preload;
+    ProxyConfig proxy;
+    ResponseCacheConfig responseCache;
+    RequestBodyConfig requestBody;
+    Http2Config http2;
+    WebSocketConfig webSocket;
+    ClientLimitsConfig clientLimits;
+    AccessLogConfig accessLog;
+    RateLimitConfig rateLimit;
+    SocketOptions socket;           // Aplicadas pelo servidor no socket de escuta e nas conexões aceitas
+    StreamingConfig streaming;      // Fixa na inicialização
+    TlsConfig tls;                  // Idem; usada pelos endereços "tls:"
+    DispatchPolicy dispatch = DispatchPolicy::Shared;  // Do servidor; fixa na inicialização
+    LanesConfig lanes;                                  // Idem
+};
+
+struct HandlerStats {
+    size_t indexedDocuments = 0;
+    size_t compressionCacheBytes = 0;
+    size_t compressionCacheEntries = 0;
+    size_t mappedBytes = 0;
+    size_t mappedFiles = 0;
+    size_t responseCacheBytes = 0;
+    size_t responseCacheEntries = 0;
+    size_t webSocketClients = 0;
+    uint64_t webSocketDropped = 0;
+    ClientGuardStats clients;
+    uint64_t accessLogDropped = 0;
+    RateLimiterStats rateLimit;
+    DispatchStats dispatch;
+    StreamBufferStats streaming;
+    TlsStats tls;
 };
 
 class HttpHandler {
 public:
-    explicit HttpHandler(const std::string& documentRoot, const KeepAliveConfig& config = {});
+    HttpHandler(const std::string& documentRoot, TimerWheel& timers, const HandlerConfig& config = {});
+    ~HttpHandler();
+    
+    // Retornam true quando a conexão deve aguardar a próxima requisição (keep-alive)
+    bool handleConnection(Connection& connection);
+    bool handleConnectionWithKeepAlive(Connection& connection);
+    
+    KeepAliveConfig keepAliveConfig() const;
+    HandlerStats stats() const;
+    
+    // Encerramento gracioso: as próximas respostas saem com Connection: close, sessões HTTP/2
+    // recebem GOAWAY e clientes WebSocket o close 1001
+    void beginDrain();
+    // Prazo esgotado: shutdown nos dois sentidos do que ainda está em atendimento; retorna quantas
+    size_t cutConnections();
+    // Conexões ainda em atendimento (threads trabalhadoras e WebSocket)
+    size_t activeConnections() const;
     
-    void handleConnection(SOCKET clientSocket);
-    void handleConnectionWithKeepAlive(SOCKET clientSocket);
+    // Reload a quente: timeouts, limites de corpo e tamanhos dos caches valem para as próximas
+    // conexões; raiz, rotas de proxy, HTTP/2, log de acesso e limites de taxa continuam os da inicialização
+    void reload(const HandlerConfig& config);
+    
+    // Registro de rotas em tempo de execução (plugins); chamar antes de iniciar o servidor.
+    // As rotas embutidas ficam na tabela de tempo de compilação em http_handler.cpp.
+    // Com `streamBody`, o corpo não é bufferizado: o handler o lê por request.bodyReader.
+    void addRoute(HttpMethod method, const std::string& pattern, RouteTrie::Handler handler,
+                  bool streamBody = false);
+    
+    // Limites por cliente; a aceitação consulta admit() antes de enfileirar a conexão
+    ClientGuard& clientGuard();
+    
+    // Conexões WebSocket: rotas GET aceitam o upgrade com webSockets().accept(...)
+    WebSocketHub& webSockets();
+    
+    // Distribuição entre as threads trabalhadoras (do servidor), incluída em stats()
+    void setDispatchStatsSource(std::function<DispatchStats()> source);
+    
+    // Certificado carregado: os endereços "tls:" podem ser abertos
+    bool tlsEnabled() const;
     
 private:
     bool parseRequest(const std::string& requestData, HttpRequest& request);
+    void dispatch(HttpRequest& request, HttpResponse& response);
     void handleGetRequest(const HttpRequest& request, HttpResponse& response);
-    void sendResponse(SOCKET clientSocket, const HttpResponse& response, bool keepAlive = false);
-    bool receiveRequestWithTimeout(SOCKET clientSocket, std::string& requestData);
+    bool isNotModified(const HttpRequest& request, const std::string& etag, time_t modified);
+    bool ifRangeMatches(const HttpRequest& request, const std::string& etag, time_t modified);
+    ContentEncoding selectEncoding(const HttpRequest& request, const std::string& filePath,
+                                   uint64_t fileSize, time_t modified, bool& precompressed);
+    // Retorna true quando a resposta já foi enviada diretamente pelo proxy
+    bool handleProxyRequest(Connection& connection, const HttpRequest& request,
+                            bool& keepAlive, HttpResponse& response, SocketDeadline& requestDeadline);
+    void fillFromCache(const CachedResponse& cached, const char* cacheStatus, HttpResponse& response);
+    std::unique_ptr<Http2Session> makeHttp2Session(Connection& connection);
+    // Upgrade h2c de uma requisição sem corpo; nullptr quando não pedido ou inválido
+    std::unique_ptr<Http2Session> acceptH2cUpgrade(Connection& connection, HttpRequest& request);
+    void handleHttp2Request(HttpRequest& request, HttpResponse& response);
+    // Proxy sem cliente HTTP/1.1 para repassar: resposta inteira bufferizada (streams HTTP/2)
+    void fetchProxied(const HttpRequest& request, HttpResponse& response);
+    bool loadEncodedVariant(const std::string& filePath, ContentEncoding encoding, bool precompressed,
+                            const std::string& etag, int fd, uint64_t size, HttpResponse& response);
+    // Retorna os bytes entregues ao socket (headers + corpo)
+    uint64_t sendResponse(SOCKET clientSocket, const HttpResponse& response, bool keepAlive = false);
+    void logAccess(const Connection& connection, const HttpRequest& request, const HttpResponse& response,
+                   std::chrono::system_clock::time_point start, uint64_t bytesSent,
+                   uint32_t headerUs, uint32_t handlerUs, uint32_t sendUs, uint8_t flags);
+    bool receiveRequestWithTimeout(Connection& connection, std::string& requestData);
+    // Headers acima dos limites do ClientGuard: 431 e a conexão fecha
+    void rejectHeaders(Connection& connection);
+    
+    // Arquivo inteiro em `content` (uma alocação, sem cópia intermediária); false em erro de leitura
+    bool readFile(int fd, uint64_t size, std::string& content);
     
-    std::string getMimeType(const std::string& filename);
-    std::string readFile(const std::string& filepath);
-    bool fileExists(const std::string& filepath);
+    void warmUp();
+    void preloadFiles();
     
     std::string documentRoot_;
-    KeepAliveConfig keepAliveConfig_;
+    TimerWheel& timers_;
+    std::shared_ptr<const KeepAliveConfig> keepAliveConfig_;       // Trocados por reload() (atomic_load/store)
+    std::shared_ptr<const RequestBodyConfig> requestBodyConfig_;
+    Http2Config http2Config_;
+    CompressionConfig compressionConfig_;
+    CompressionCache compressionCache_;
+    MappedFileCache mappedFiles_;
+    DocumentIndex documentIndex_;
+    PreloadConfig preloadConfig_;
+    std::thread indexRefreshThread_;
+    RouteTrie routes_;
+    std::unique_ptr<ProxyHandler> proxyHandler_;   // Só existe com rotas de proxy configuradas
+    ResponseCacheConfig responseCacheConfig_;
+    std::unique_ptr<ResponseCache> responseCache_; // Destruído antes do proxy que usa na revalidação
+    WebSocketHub webSockets_;
+    ClientGuard clientGuard_;       // Também registra as conexões em atendimento (encerramento gracioso)
+    AccessLog accessLog_;           // Caminho fixo na inicialização; desativado sem arquivo
+    RateLimiter rateLimiter_;
+    std::function<DispatchStats()> dispatchStats_;
+    StreamBuffers streamBuffers_;   // Compartilhado com as sessões HTTP/2
+    std::unique_ptr<TlsContext> tls_;   // Só existe com certificado configurado
+    bool corkResponses_;
+    std::atomic<bool> draining_{false};
 };
@@ -5,17 +5,18 @@
 #include <memory>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <vector>
+#include "http_handler.h"
+#include "listen_address.h"
 
-#ifdef _WIN32
-    #include <winsock2.h>
-    typedef SOCKET SOCKET;
-#else
-    typedef int SOCKET;
-#endif
+typedef int SOCKET;
 
 class ThreadPool;
-class ConnectionQueue;
+class WorkerDispatcher;
+class RequestLanes;
 class HttpHandler;
+class EventLoop;
 
 struct ServerStats {
     std::atomic<uint64_t> totalConnections{0};
@@ -24,36 +25,80 @@ struct ServerStats {
     std::atomic<uint64_t> failedRequests{0};
     std::atomic<uint64_t> droppedConnections{0};
     std::atomic<uint64_t> averageResponseTime{0};
+    
+    // Encerramento gracioso
+    std::atomic<uint64_t> drainIdleClosed{0};       // Ociosas fechadas ou acordadas com SHUT_RD
+    std::atomic<uint64_t> drainCompleted{0};        // Em atendimento que terminaram dentro do prazo
+    std::atomic<uint64_t> drainCut{0};              // Ainda em atendimento no fim do prazo
+    std::atomic<uint64_t> drainQueuedDropped{0};    // Aceitas e ainda na fila no fim do prazo
 };
 
 class HttpServer {
 public:
     HttpServer(int port = 8080, size_t numThreads = 4, size_t maxConnections = 100, 
-               const std::string& documentRoot = "./www");
+               const std::string& documentRoot = "./www", const HandlerConfig& handlerConfig = {});
     ~HttpServer();
     
+    // Endereços de escuta (antes de openListeners); o padrão é só IPv4 na porta do construtor
+    void setListenAddresses(const std::vector<ListenAddress>& addresses);
+    // Usa sockets de escuta já prontos (herdados de outro processo) para os endereços que casarem;
+    // os que não casarem com nenhum endereço configurado são fechados
+    void adoptListeners(const std::vector<SOCKET>& sockets);
+    // Abre os endereços que ainda não têm socket de escuta; start() chama quando necessário
+    void openListeners();
+    std::vector<SOCKET> listenerSockets() const;
+    // Os sockets foram entregues a outro processo: stop() não remove os caminhos Unix
+    void releaseListeners();
+    
     bool start();
-    void stop();
+    // Para de aceitar e drena: cada conexão termina a requisição atual com Connection: close,
+    // as ociosas fecham na hora; o que sobrar no fim de `drainTimeout` é cortado
+    void stop(std::chrono::milliseconds drainTimeout = std::chrono::seconds(10));
     bool isRunning() const;
     
+    // Reload a quente: número de threads trabalhadoras e limites do handler
+    void reload(size_t numThreads, const HandlerConfig& handlerConfig);
+    
     const ServerStats& getStats() const;
+    HttpHandler& handler();     // Registro de rotas (addRoute) antes de start()
     void printStats() const;
 
 private:
     void startWorkers();
+    void setWorkerThreads(size_t numThreads);
+    void spawnWorkers();
+    bool retireWorker(size_t index);
     void acceptConnections();
-    void workerLoop();
+    void workerLoop(size_t index);
+    void wakeAcceptor();
+    void closeListeners();
+    
+    struct Listener {
+        ListenAddress address;
+        SOCKET socket;
+    };
+    void acceptFrom(const Listener& listener);
     
     int port_;
     size_t numThreads_;
     size_t maxConnections_;
     std::string documentRoot_;
     
-    SOCKET serverSocket_;
+    SocketOptions socketOptions_;
+    std::vector<Listener> listeners_;
+    bool listenersReleased_;
+    int wakeFd_;                    // Acorda o poll do laço de aceitação em stop()
+    std::mutex acceptMutex_;        // Mantido pelo laço de aceitação enquanto usa os sockets
     std::atomic<bool> running_;
     
+    std::atomic<size_t> workerTarget_;
+    std::mutex workersMutex_;
+    std::vector<bool> workerRunning_;   // Por índice de thread (protegido por workersMutex_)
+    
+    std::shared_ptr<RequestLanes> lanes_;       // Só com faixas configuradas
     std::unique_ptr<ThreadPool> threadPool_;
-    std::unique_ptr<ConnectionQueue> connectionQueue_;
+    std::unique_ptr<WorkerDispatcher> dispatcher_;
+    std::unique_ptr<EventLoop> eventLoop_;
     std::unique_ptr<HttpHandler> httpHandler_;
     
     std::thread acceptThread_;
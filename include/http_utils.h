@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ctime>
+
+struct ByteRange {
+    uint64_t offset;
+    uint64_t length;
+};
+
+enum class RangeResult {
+    None,           // Sem header Range utilizável: responder com o arquivo inteiro
+    Satisfiable,
+    Unsatisfiable   // 416
+};
+
+// Datas HTTP (IMF-fixdate, RFC 7231)
+std::string formatHttpDate(time_t time);
+bool parseHttpDate(const std::string& value, time_t& time);
+
+// ETag forte derivado de inode, tamanho e mtime (em nanossegundos)
+std::string makeETag(uint64_t inode, uint64_t size, int64_t mtimeNs, const char* suffix = "");
+
+// Comparação fraca (RFC 7232) contra uma lista de ETags ou "*"
+bool etagListMatches(const std::string& headerValue, const std::string& etag);
+
+// Interpreta "bytes=a-b,c-,-n"; ranges sintaticamente inválidos retornam None
+RangeResult parseRangeHeader(const std::string& value, uint64_t fileSize,
+                             std::vector<ByteRange>& ranges, size_t maxRanges = 16);
+
+// Lista separada por vírgulas (Connection, Upgrade, Transfer-Encoding); `token` em minúsculas
+bool containsToken(const std::string& value, const std::string& token);
+
+// Separa a query string, decodifica %XX e remove segmentos "." e "..".
+// Retorna false para alvos que não começam com '/', escapam da raiz ou contêm NUL.
+bool normalizeRequestPath(std::string& path, std::string& query);
+
+// Alvo de origem equivalente ao caminho normalizado: reescapa o que não pode aparecer cru
+// (inclusive '%', '?' e '#' vindos de %XX) e mantém a query, escapando só bytes de controle
+std::string encodeRequestTarget(const std::string& path, const std::string& query);
+
+// Decodificador incremental de "Transfer-Encoding: chunked"
+class ChunkedDecoder {
+public:
+    // Consome até `length` bytes, anexando os dados decodificados em `output` (se não nulo).
+    // Retorna quantos bytes foram consumidos; para no fim da mensagem ou em erro.
+    size_t feed(const char* data, size_t length, std::string* output);
+
+    bool done() const;
+    bool failed() const;
+
+private:
+    enum class State {
+        Size,
+        Extension,
+        SizeLF,
+        Data,
+        DataCR,
+        DataLF,
+        TrailerStart,
+        TrailerLine,
+        TrailerLineLF,
+        TrailerLF,
+        Done,
+        Error
+    };
+
+    State state_ = State::Size;
+    uint64_t chunkRemaining_ = 0;
+    int sizeDigits_ = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "connection.h"
+
+#include <sys/socket.h>
+
+// Endereço em que o servidor escuta. Vários podem coexistir na mesma instância (IPv4, IPv6 e
+// socket Unix para sidecars locais), todos alimentando a mesma fila de conexões.
+struct ListenAddress {
+    enum class Family { IPv4, IPv6, Unix };
+
+    Family family = Family::IPv4;
+    std::string host;       // Literal IP; vazio escuta em todas as interfaces
+    int port = 0;
+    std::string path;       // Socket Unix
+    bool v6Only = false;    // IPV6_V6ONLY; sem ele "[::]" também atende IPv4 (dual-stack)
+    bool tls = false;       // Conexões passam pelo handshake TLS antes do HTTP (não vale para Unix)
+
+    bool isUnix() const { return family == Family::Unix; }
+    std::string toString() const;
+    // Socket já em escuta (herdado na troca de binário) ligado a este mesmo endereço
+    bool matches(SOCKET socket) const;
+    // Endereço para bind(); 0 se o host não for um literal válido ou o caminho for longo demais
+    socklen_t toSockaddr(sockaddr_storage& storage) const;
+
+    // "0.0.0.0:8080", "127.0.0.1", "[::]:8080", "[::1]", ":8080" ou "unix:/run/server.sock";
+    // sem porta usa `defaultPort`. Prefixo "tls:" ("tls:[::]:8443") liga o TLS no endereço
+    static bool parse(const std::string& spec, int defaultPort, ListenAddress& address);
+    // Lista separada por vírgulas. "[::]" só fica dual-stack se nenhum endereço IPv4 da lista
+    // usar a mesma porta; do contrário os dois disputariam o bind
+    static bool parseList(const std::string& spec, int defaultPort, std::vector<ListenAddress>& addresses);
+};
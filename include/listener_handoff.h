@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include "connection.h"
+
+// Troca de binário sem derrubar conexões. O processo em execução atende em um socket Unix;
+// o processo novo conecta nele, recebe os sockets de escuta por SCM_RIGHTS e confirma quando já
+// vai aceitar. Só então o antigo para de aceitar e drena o que ainda atende. Se o novo morrer
+// ou não confirmar dentro do prazo, a troca é abortada e o antigo segue normalmente.
+class ListenerHandoff {
+public:
+    explicit ListenerHandoff(std::string path);
+    ~ListenerHandoff();
+
+    ListenerHandoff(const ListenerHandoff&) = delete;
+    ListenerHandoff& operator=(const ListenerHandoff&) = delete;
+
+    // Processo novo: sockets de escuta do processo em execução; vazio se não há nenhum
+    std::vector<SOCKET> takeOver();
+    // Processo novo: libera o antigo para parar de aceitar; false se o antigo já abortou a troca
+    bool confirm();
+
+    // Passa a atender pedidos de troca em uma thread própria; `onHandedOff` é chamado nela
+    // depois da confirmação do processo novo, que tem `confirmTimeout` para chegar
+    bool serve(std::vector<SOCKET> listeners, std::chrono::milliseconds confirmTimeout,
+               std::function<void()> onHandedOff);
+    void stop();
+
+private:
+    void run();
+    bool handOff(int peer);
+
+    std::string path_;
+    std::vector<SOCKET> listeners_;
+    std::chrono::milliseconds confirmTimeout_;
+    int controlFd_;     // Socket Unix em escuta (processo em execução)
+    int peerFd_;        // Conexão com o processo antigo (processo novo, até confirm())
+    int wakeFd_;
+    std::atomic<bool> running_;
+    bool handedOff_;
+    std::function<void()> onHandedOff_;
+    std::thread thread_;
+};
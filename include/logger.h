@@ -6,6 +6,19 @@
 #include <chrono>
 #include <sstream>
 #include <iomanip>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <condition_variable>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+
+struct LogFormat;
+class LogStagingBuffer;
 
 class Logger {
 public:
@@ -27,16 +40,306 @@ public:
     void error(const std::string& message);
     
     void log(Level level, const std::string& message);
+    
+    bool isEnabled(Level level) const;
+    
+    // Caminho adiado (macros LOG_FORMAT/LOG_LIMITED/...): os argumentos são copiados em binário
+    // para o buffer da thread e a thread de escrita monta o texto. `suppressed` são as mensagens
+    // descartadas pelo LogSite desde a última emitida por ele.
+    template <typename... Args>
+    void logDeferred(const LogFormat& format, uint64_t suppressed, const Args&... args);
+    // Espera a thread de escrita gravar o que já está nos buffers
+    void flush();
+    uint64_t droppedMessages() const;
 
 private:
     Logger() = default;
     ~Logger();
     
-    std::string getCurrentTimestamp();
+    std::string getCurrentTimestamp(std::chrono::system_clock::time_point now);
     std::string levelToString(Level level);
+    std::string formatLine(Level level, std::chrono::system_clock::time_point time, const std::string& message);
+    void write(Level level, std::chrono::system_clock::time_point time, const std::string& message);
+    
+    LogStagingBuffer* stagingBuffer();
+    void writerLoop();
+    void drain();
     
     std::mutex mutex_;
     std::ofstream logFile_;
-    Level currentLevel_ = Level::INFO;
+    std::atomic<Level> currentLevel_{Level::INFO};   // Lido sem o mutex pelas macros
     bool consoleOutput_ = true;
+    
+    std::mutex registryMutex_;
+    std::vector<std::shared_ptr<LogStagingBuffer>> buffers_;    // Um por thread que usou o caminho adiado
+    std::thread writer_;
+    std::mutex writerMutex_;
+    std::condition_variable writerCondition_;
+    std::condition_variable flushedCondition_;
+    bool stopping_ = false;
+    bool flushRequested_ = false;
+    uint64_t drainPasses_ = 0;
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t droppedReported_ = 0;
+};
+
+// Ponto de chamada do caminho adiado: um objeto estático por uso das macros, cujo endereço
+// vai em cada registro no lugar do texto do formato
+struct LogFormat {
+    Logger::Level level;
+    const char* format;     // Marcadores "{}", um por argumento
+};
+
+namespace logformat {
+
+enum class ArgType : uint8_t { Signed, Unsigned, Double, Bool, Char, String };
+
+constexpr size_t kMaxStringBytes = 4096;    // Strings maiores são truncadas no registro
+
+constexpr size_t placeholders(const char* format) {
+    size_t count = 0;
+    for (; *format; ++format) {
+        if (format[0] == '{' && format[1] == '}') {
+            ++count;
+            ++format;
+        }
+    }
+    return count;
+}
+
+// Só usado em sizeof: conta os argumentos sem avaliá-los
+template <typename... Args>
+char (&argCounter(const Args&...))[sizeof...(Args) + 1];
+
+template <typename T>
+constexpr ArgType typeOf() {
+    if constexpr (std::is_same_v<T, bool>) {
+        return ArgType::Bool;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return ArgType::Char;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return ArgType::Double;
+    } else if constexpr (std::is_signed_v<T>) {
+        return ArgType::Signed;
+    } else {
+        return ArgType::Unsigned;
+    }
+}
+
+inline size_t encodedSize(std::string_view text) {
+    return 1 + sizeof(uint32_t) + std::min(text.size(), kMaxStringBytes);
+}
+
+inline size_t encodedSize(const char* text) {
+    return encodedSize(std::string_view(text ? text : "(null)"));
+}
+
+inline size_t encodedSize(const std::string& text) {
+    return encodedSize(std::string_view(text));
+}
+
+template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+size_t encodedSize(T) {
+    constexpr ArgType type = typeOf<T>();
+    return 1 + (type == ArgType::Bool || type == ArgType::Char ? 1 : 8);
+}
+
+inline void encode(char*& out, std::string_view text) {
+    uint32_t length = static_cast<uint32_t>(std::min(text.size(), kMaxStringBytes));
+    *out++ = static_cast<char>(ArgType::String);
+    std::memcpy(out, &length, sizeof(length));
+    std::memcpy(out + sizeof(length), text.data(), length);
+    out += sizeof(length) + length;
+}
+
+inline void encode(char*& out, const char* text) {
+    encode(out, std::string_view(text ? text : "(null)"));
+}
+
+inline void encode(char*& out, const std::string& text) {
+    encode(out, std::string_view(text));
+}
+
+template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+void encode(char*& out, T value) {
+    constexpr ArgType type = typeOf<T>();
+    *out++ = static_cast<char>(type);
+    if constexpr (type == ArgType::Bool || type == ArgType::Char) {
+        *out++ = static_cast<char>(value);
+    } else if constexpr (type == ArgType::Double) {
+        double widened = static_cast<double>(value);
+        std::memcpy(out, &widened, sizeof(widened));
+        out += sizeof(widened);
+    } else if constexpr (type == ArgType::Signed) {
+        int64_t widened = static_cast<int64_t>(value);
+        std::memcpy(out, &widened, sizeof(widened));
+        out += sizeof(widened);
+    } else {
+        uint64_t widened = static_cast<uint64_t>(value);
+        std::memcpy(out, &widened, sizeof(widened));
+        out += sizeof(widened);
+    }
+}
+
+} // namespace logformat
+
+// Cabeçalho de cada registro no buffer; os argumentos codificados vêm logo depois
+struct LogRecordHeader {
+    uint32_t size;              // Registro inteiro, múltiplo de 8; 0 marca o fim útil do buffer
+    uint32_t suppressed;
+    const LogFormat* format;
+    int64_t timestampNs;        // system_clock
 };
+
+// Anel de bytes de um produtor (a thread dona) e um consumidor (a thread de escrita), sem lock.
+// Registros são contíguos: o que não cabe no fim deixa um marcador e recomeça no início.
+class LogStagingBuffer {
+public:
+    explicit LogStagingBuffer(size_t capacity);     // Potência de 2
+    
+    // Produtor: nullptr com o buffer cheio (a mensagem é descartada, nunca bloqueia)
+    char* reserve(size_t bytes) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t offset = head & (capacity_ - 1);
+        size_t toEnd = capacity_ - offset;
+        size_t needed = bytes <= toEnd ? bytes : toEnd + bytes;
+        if (needed > capacity_ - (head - tail)) {
+            return nullptr;
+        }
+        if (bytes > toEnd) {
+            uint32_t wrap = 0;
+            std::memcpy(&data_[offset], &wrap, sizeof(wrap));
+            head += toEnd;
+            offset = 0;
+        }
+        reservedHead_ = head;
+        return &data_[offset];
+    }
+    
+    void commit(size_t bytes) {
+        head_.store(reservedHead_ + bytes, std::memory_order_release);
+    }
+    
+    // Consumidor: chama `visit` com cada registro publicado e libera o espaço no fim
+    template <typename Visit>
+    void consume(Visit&& visit) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        while (tail != head) {
+            size_t offset = tail & (capacity_ - 1);
+            LogRecordHeader header;
+            std::memcpy(&header, &data_[offset], sizeof(header.size));
+            if (header.size == 0) {
+                tail += capacity_ - offset;
+                continue;
+            }
+            std::memcpy(&header, &data_[offset], sizeof(header));
+            visit(header, &data_[offset + sizeof(header)]);
+            tail += header.size;
+        }
+        tail_.store(tail, std::memory_order_release);
+    }
+    
+    // A thread dona terminou: a de escrita descarta o buffer depois de esvaziá-lo
+    void retire() { retired_.store(true, std::memory_order_release); }
+    bool retired() const { return retired_.load(std::memory_order_acquire); }
+    
+private:
+    size_t capacity_;
+    std::unique_ptr<char[]> data_;
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+    size_t reservedHead_ = 0;       // Só o produtor usa
+    std::atomic<bool> retired_{false};
+};
+
+template <typename... Args>
+void Logger::logDeferred(const LogFormat& format, uint64_t suppressed, const Args&... args) {
+    size_t bytes = sizeof(LogRecordHeader) + (size_t{0} + ... + logformat::encodedSize(args));
+    bytes = (bytes + 7) & ~size_t{7};
+    
+    LogStagingBuffer* buffer = stagingBuffer();
+    char* record = buffer->reserve(bytes);
+    if (!record) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    LogRecordHeader header{static_cast<uint32_t>(bytes),
+                           static_cast<uint32_t>(std::min<uint64_t>(suppressed, UINT32_MAX)), &format,
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::system_clock::now().time_since_epoch()).count()};
+    std::memcpy(record, &header, sizeof(header));
+    [[maybe_unused]] char* out = record + sizeof(header);   // Sem argumentos o fold fica vazio
+    (logformat::encode(out, args), ...);
+    buffer->commit(bytes);
+}
+
+// Limite de um ponto de chamada: balde de tokens (`perSecond` de reposição, rajada de até `burst`)
+// e amostragem opcional (1 em `sampleEvery`, sorteado). Cada uso das macros abaixo cria o seu
+// como variável estática, então o endereço identifica o ponto de chamada sem tabela nem lock.
+// As descartadas são contadas e o total sai junto com a próxima mensagem admitida.
+class LogSite {
+public:
+    LogSite(double perSecond, uint32_t burst, uint32_t sampleEvery = 1);
+    
+    bool admit();
+    uint64_t takeSuppressed();
+    
+private:
+    int64_t intervalNs_;        // 0: sem limite de taxa
+    int64_t toleranceNs_;
+    uint32_t sampleEvery_;
+    std::atomic<int64_t> nextAllowedNs_;    // GCRA: horário teórico da próxima mensagem
+    std::atomic<uint64_t> suppressed_;
+};
+
+// O formato é conferido na compilação (um "{}" por argumento); os argumentos só são avaliados
+// com o nível ativo e são copiados em binário, sem montar std::string na thread que registra
+#define LOG_FORMAT_CHECK(format, ...) \
+    static_assert(logformat::placeholders(format) == sizeof(logformat::argCounter(__VA_ARGS__)) - 1, \
+                  "formato de log: quantidade de {} diferente da de argumentos")
+
+#define LOG_FORMAT(level, format, ...) \
+    do { \
+        LOG_FORMAT_CHECK(format, ##__VA_ARGS__); \
+        static constexpr LogFormat logFormat_{level, format}; \
+        Logger& logFormatLogger_ = Logger::getInstance(); \
+        if (logFormatLogger_.isEnabled(level)) { \
+            logFormatLogger_.logDeferred(logFormat_, 0, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_FORMAT_SITE(level, site, format, ...) \
+    do { \
+        LOG_FORMAT_CHECK(format, ##__VA_ARGS__); \
+        static constexpr LogFormat logFormat_{level, format}; \
+        Logger& logFormatLogger_ = Logger::getInstance(); \
+        if (logFormatLogger_.isEnabled(level) && (site).admit()) { \
+            logFormatLogger_.logDeferred(logFormat_, (site).takeSuppressed(), ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// Até `perSecond` mensagens por segundo deste ponto de chamada, com rajadas de até `burst`
+#define LOG_LIMITED(level, perSecond, burst, format, ...) \
+    do { \
+        static LogSite logSite_(perSecond, burst); \
+        LOG_FORMAT_SITE(level, logSite_, format, ##__VA_ARGS__); \
+    } while (0)
+
+// Uma em cada `sampleEvery` mensagens (em média), ainda limitado a `perSecond`: em rajadas
+// mostra uma amostra do tráfego todo em vez de só as primeiras mensagens
+#define LOG_SAMPLED(level, sampleEvery, perSecond, format, ...) \
+    do { \
+        static LogSite logSite_(perSecond, 2 * (perSecond), sampleEvery); \
+        LOG_FORMAT_SITE(level, logSite_, format, ##__VA_ARGS__); \
+    } while (0)
+
+// Em builds de release (NDEBUG) as chamadas de DEBUG somem na compilação: formato e argumentos
+// só são verificados, nunca avaliados. LOG_KEEP_DEBUG mantém o nível disponível.
+#if defined(NDEBUG) && !defined(LOG_KEEP_DEBUG)
+#define LOG_DEBUG(format, ...) do { LOG_FORMAT_CHECK(format, ##__VA_ARGS__); } while (0)
+#else
+#define LOG_DEBUG(format, ...) LOG_FORMAT(Logger::Level::DEBUG, format, ##__VA_ARGS__)
+#endif
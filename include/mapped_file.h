@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+
+struct MappedFileConfig {
+    bool enabled = true;
+    uint64_t minFileSize = 0;
+    uint64_t maxFileSize = 8 * 1024 * 1024;     // Arquivos maiores seguem por sendfile
+    size_t cacheBytes = 256 * 1024 * 1024;      // Total mapeado mantido pelo cache
+    bool populate = false;                      // MAP_POPULATE: pré-carrega as páginas (hot set)
+};
+
+// Mapeamento somente leitura de um arquivo inteiro. Compartilhado entre as threads
+// via shared_ptr: o munmap acontece quando a última resposta que o usa termina.
+class MappedFile {
+public:
+    static std::shared_ptr<const MappedFile> map(int fd, uint64_t size, uint64_t inode,
+                                                 int64_t mtimeNs, bool populate);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const;
+    uint64_t size() const;
+    bool matches(uint64_t inode, uint64_t size, int64_t mtimeNs) const;
+
+private:
+    MappedFile(void* address, uint64_t size, uint64_t inode, int64_t mtimeNs);
+
+    void* address_;
+    uint64_t size_;
+    uint64_t inode_;
+    int64_t mtimeNs_;
+};
+
+// Cache LRU de mapeamentos indexado por caminho e validado por inode/tamanho/mtime
+class MappedFileCache {
+public:
+    explicit MappedFileCache(const MappedFileConfig& config);
+
+    // Retorna o mapeamento em cache ou mapeia `fd`; nullptr se o arquivo não é elegível.
+    // `populate` força o carregamento das páginas (pré-carregamento na inicialização).
+    std::shared_ptr<const MappedFile> acquire(const std::string& path, int fd, uint64_t size,
+                                              uint64_t inode, int64_t mtimeNs, bool populate = false);
+
+    void setCapacity(size_t cacheBytes);
+
+    size_t mappedBytes() const;
+    size_t entries() const;
+
+private:
+    struct Entry {
+        std::string path;
+        std::shared_ptr<const MappedFile> file;
+    };
+
+    void evict();
+
+    MappedFileConfig config_;
+    mutable std::mutex mutex_;
+    size_t currentBytes_ = 0;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string_view>
+
+// Tipo MIME pela extensão do caminho, via tabela com hash perfeito gerada em tempo de compilação.
+// Retorna "application/octet-stream" para extensões desconhecidas.
+const char* mimeTypeForPath(std::string_view path);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include "connection.h"
+#include "timer_wheel.h"
+#include "upstream.h"
+
+struct HttpRequest;
+class SocketDeadline;
+
+struct ProxyRoute {
+    std::string prefix;                     // Ex.: "/api" atende "/api" e "/api/..."
+    std::vector<std::string> backends;      // "host:porta"
+    BalancePolicy policy = BalancePolicy::RoundRobin;
+};
+
+struct ProxyConfig {
+    std::vector<ProxyRoute> routes;
+    int connectTimeoutMs = 1000;
+    int responseTimeoutSeconds = 30;        // Prazo até o cabeçalho da resposta e de cada leitura do corpo
+    size_t maxIdlePerBackend = 16;          // Conexões ociosas mantidas por thread e backend
+    int healthCheckIntervalMs = 2000;       // 0 desativa a checagem ativa
+    std::string healthCheckPath = "/";
+};
+
+struct ProxyResult {
+    bool responded = false;                 // false: nada foi enviado, o chamador responde o erro
+    int statusCode = 0;
+    std::string statusText;
+    bool keepAlive = false;
+};
+
+// Cópia da resposta do backend para o cache de respostas (corpo já sem o chunked)
+struct ProxyCapture {
+    size_t maxBodyBytes = 0;
+    int statusCode = 0;
+    std::string statusText;
+    std::vector<std::pair<std::string, std::string>> headers;  // Sem headers de salto único nem de enquadramento
+    std::string body;
+    bool complete = false;                  // Resposta inteira recebida dentro do limite
+    // Chamado uma vez, quando o backend termina ou a cópia é abandonada, antes da escrita ao
+    // cliente: quem espera pela mesma resposta não depende da velocidade deste cliente
+    std::function<void(ProxyCapture&)> onReady;
+};
+
+// Encaminha requisições por prefixo para grupos de backends HTTP/1.1, reaproveitando
+// conexões keep-alive e tirando de rotação os backends que falham na checagem de saúde
+class ProxyHandler {
+public:
+    // `relayStall`: prazo de cada escrita ao cliente durante o repasse da resposta
+    ProxyHandler(const ProxyConfig& config, TimerWheel& timers, std::chrono::milliseconds relayStall);
+    ~ProxyHandler();
+
+    ProxyHandler(const ProxyHandler&) = delete;
+    ProxyHandler& operator=(const ProxyHandler&) = delete;
+
+    bool matches(const std::string& path) const;
+    // Repassa a resposta ao cliente enquanto chega; `capture` recebe uma cópia quando presente.
+    // `requestDeadline` vale até o cabeçalho da resposta: o corpo só expira quando para de fluir
+    ProxyResult forward(Connection& client, const HttpRequest& request, bool keepAlive,
+                        SocketDeadline& requestDeadline, ProxyCapture* capture = nullptr);
+    // Busca sem cliente (revalidação em segundo plano); só para requisições sem corpo
+    ProxyResult fetch(const HttpRequest& request, ProxyCapture& capture);
+
+    // Formato: "/api=host:porta,host:porta;/outro=host:porta"
+    static bool parseRoutes(const std::string& spec, BalancePolicy policy, std::vector<ProxyRoute>& routes);
+
+private:
+    struct Route {
+        std::string prefix;
+        std::unique_ptr<UpstreamGroup> group;
+    };
+
+    const Route* findRoute(const std::string& path) const;
+    ProxyResult exchange(Connection* client, const HttpRequest& request, bool keepAlive,
+                         SocketDeadline* requestDeadline, ProxyCapture* capture);
+    bool checkBackend(const Backend& backend);
+    void healthCheckLoop();
+
+    ProxyConfig config_;
+    TimerWheel& timers_;
+    std::chrono::milliseconds relayStall_;
+    std::vector<Route> routes_;             // Ordenadas do prefixo mais longo ao mais curto
+
+    std::atomic<bool> running_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread healthThread_;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <cstdint>
+
+struct RateLimitRule {
+    std::string prefix;             // Prefixo do caminho (ex.: "/api")
+    double requestsPerSecond = 0;
+    uint32_t burst = 0;
+};
+
+struct RateLimitConfig {
+    double requestsPerSecond = 0;           // Por IP, em todas as rotas; 0 desativa
+    uint32_t burst = 0;                     // Rajada acima da taxa; 0 usa o dobro da taxa
+    std::vector<RateLimitRule> paths;       // Por IP e prefixo (o mais longo que casar)
+    int idleSeconds = 60;                   // Baldes cheios e parados há mais que isso são descartados
+    size_t maxBuckets = 1 << 20;            // Acima disso clientes novos passam sem limite
+};
+
+struct RateLimiterStats {
+    uint64_t limited = 0;
+    uint64_t untracked = 0;     // Admitidos sem balde (maxBuckets atingido)
+    size_t buckets = 0;
+};
+
+// Limite de requisições por IP do cliente e por IP + rota. Cada balde é um único atômico (GCRA,
+// equivalente a um balde de tokens); o mapa é dividido em shards com lock de leitura, então um
+// cliente já conhecido passa só com um shared_lock e um compare_exchange. Baldes ociosos são
+// descartados aos poucos, quando um shard recebe um cliente novo.
+class RateLimiter {
+public:
+    explicit RateLimiter(const RateLimitConfig& config = {});
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    bool enabled() const;
+    // false: acima do limite; `retryAfterSeconds` diz quando o cliente volta a ser atendido
+    bool admit(const std::string& address, const std::string& path, int& retryAfterSeconds);
+    RateLimiterStats stats() const;
+
+    // "/api=10:20;/login=1" -> prefixo=taxa[:rajada]
+    static bool parseRules(const std::string& spec, std::vector<RateLimitRule>& rules);
+
+private:
+    struct Key {
+        uint64_t high;
+        uint64_t low;
+        uint32_t rule;      // 0: limite por IP; i + 1: paths[i]
+
+        bool operator==(const Key& other) const {
+            return high == other.high && low == other.low && rule == other.rule;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Limit {
+        int64_t intervalNs = 0;
+        int64_t toleranceNs = 0;
+    };
+
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<Key, std::atomic<int64_t>, KeyHash> buckets;    // Horário teórico da próxima requisição
+        int64_t nextSweepNs = 0;
+    };
+
+    static Limit makeLimit(double requestsPerSecond, uint32_t burst);
+    bool take(const Key& key, const Limit& limit, int64_t now, int64_t& waitNs);
+    static bool consume(std::atomic<int64_t>& bucket, const Limit& limit, int64_t now, int64_t& waitNs);
+    void sweep(Shard& shard, int64_t now);
+
+    static constexpr size_t kShards = 64;
+
+    RateLimitConfig config_;
+    Limit addressLimit_;
+    std::vector<Limit> pathLimits_;
+    int64_t idleNs_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<size_t> bucketCount_;
+    std::atomic<uint64_t> limited_;
+    std::atomic<uint64_t> untracked_;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include "connection.h"
+#include "http_utils.h"
+
+struct RequestBodyConfig {
+    uint64_t maxBodyBytes = 64 * 1024 * 1024;   // Acima disso: 413 (inclusive para handlers em streaming)
+    size_t maxBufferedBytes = 1024 * 1024;      // Limite de HttpRequest::body para rotas não streaming
+    size_t maxDrainBytes = 64 * 1024;           // Corpo não lido até este tamanho é descartado; acima, fecha a conexão
+};
+
+// Leitura incremental do corpo da requisição (Content-Length ou chunked) a partir do buffer
+// da conexão e depois do socket. Bytes após o fim do corpo ficam no buffer (pipelining).
+// O "100 Continue" só é enviado na primeira leitura: um handler que recusa sem ler não o dispara.
+class BodyReader {
+public:
+    enum class Framing {
+        None,
+        Length,
+        Chunked,
+        Buffered    // Corpo já recebido por inteiro (streams HTTP/2)
+    };
+
+    BodyReader(Connection& connection, Framing framing, uint64_t contentLength,
+               uint64_t maxBytes, bool expectContinue);
+    explicit BodyReader(std::string body);
+
+    // Próximo bloco (até 16 KB) em `chunk`; false no fim do corpo ou em erro (ver errorStatus)
+    bool read(std::string& chunk);
+    // Corpo inteiro em `body`; falha com 413 acima de `maxBytes`
+    bool readAll(std::string& body, size_t maxBytes);
+    // Descarta o restante, até `maxBytes`; false se o corpo não pôde ser consumido
+    bool drain(size_t maxBytes);
+
+    bool complete() const;
+    bool started() const;
+    int errorStatus() const;        // 0, 400 (malformado ou conexão perdida) ou 413
+    uint64_t bytesRead() const;
+
+private:
+    bool receiveMore();
+    void fail(int status);
+
+    Connection* connection_;
+    Framing framing_;
+    std::string buffered_;
+    size_t bufferedOffset_ = 0;
+    uint64_t remaining_;
+    uint64_t maxBytes_;
+    uint64_t bytesRead_ = 0;
+    bool expectContinue_;
+    bool started_ = false;
+    bool complete_;
+    int errorStatus_ = 0;
+    ChunkedDecoder decoder_;
+};
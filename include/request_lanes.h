@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "connection.h"
+
+struct LaneConfig {
+    std::string name;
+    uint32_t weight = 1;        // Parcela do tempo das threads quando todas as faixas têm fila
+    size_t maxActive = 0;       // Conexões da faixa em atendimento ao mesmo tempo; 0 sem limite
+};
+
+struct LaneRule {
+    enum class Kind { Path, Header, Client };
+
+    Kind kind = Kind::Path;
+    std::string match;          // Prefixo do caminho, nome do header ou prefixo do IP ("unix": socket Unix)
+    std::string value;          // Header: prefixo do valor; vazio basta o header existir
+    uint8_t lane = 0;
+};
+
+struct LanesConfig {
+    std::vector<LaneConfig> lanes;      // Vazio desativa; a faixa "default" é acrescentada se faltar
+    std::vector<LaneRule> rules;        // A primeira que casar decide; sem nenhuma, "default"
+
+    bool enabled() const { return !lanes.empty(); }
+
+    // "health:8,api:4,downloads:1:3" -> nome:peso[:máximo em atendimento]
+    static bool parseLanes(const std::string& spec, std::vector<LaneConfig>& lanes);
+    // "path:/_server/health=health;header:X-Priority:high=api;client:10.0.=health"; chamar depois
+    // de parseLanes (as faixas citadas precisam existir)
+    static bool parseRules(const std::string& spec, LanesConfig& config);
+};
+
+struct LaneStats {
+    std::string name;
+    uint32_t weight = 0;
+    size_t maxActive = 0;
+    size_t active = 0;
+    uint64_t served = 0;
+    uint64_t costMicros = 0;    // Tempo médio de atendimento (média móvel), custo da faixa no DRR
+    uint64_t waitMicros = 0;    // Espera média na fila
+};
+
+// Faixas de prioridade das requisições. A classificação espia (MSG_PEEK) o início da requisição
+// antes de a conexão entrar na fila; as filas servem as faixas por deficit round robin, com o custo
+// de cada faixa medido pelo tempo de atendimento, de modo que cada uma recebe tempo de thread na
+// proporção do peso: um health check não espera atrás de uma fila de downloads grandes.
+class RequestLanes {
+public:
+    explicit RequestLanes(const LanesConfig& config);
+
+    RequestLanes(const RequestLanes&) = delete;
+    RequestLanes& operator=(const RequestLanes&) = delete;
+
+    size_t count() const;
+    // Define connection.lane; false se as regras dependem da requisição e ela ainda não chegou
+    // (a conexão fica em "default" até lá)
+    bool classify(Connection& connection) const;
+
+    uint32_t weight(uint8_t lane) const;
+    int64_t costMicros(uint8_t lane) const;
+    // Abaixo do limite de atendimento simultâneo da faixa
+    bool admits(uint8_t lane) const;
+    bool limited(uint8_t lane) const;
+
+    // Reserva uma vaga de atendimento na faixa (atômico entre as filas); false no limite
+    bool tryStart(uint8_t lane, std::chrono::steady_clock::duration waited);
+    void finished(uint8_t lane, std::chrono::steady_clock::duration busy);
+
+    std::vector<LaneStats> stats() const;
+
+    static constexpr int64_t kQuantumMicros = 1000;    // Crédito por volta para peso 1
+
+private:
+    struct Lane {
+        LaneConfig config;
+        std::atomic<size_t> active{0};
+        std::atomic<uint64_t> served{0};
+        std::atomic<uint64_t> waitMicros{0};
+        std::atomic<int64_t> costMicros{kQuantumMicros};
+    };
+
+    bool matches(const LaneRule& rule, const Connection& connection, const std::string& head) const;
+
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::vector<LaneRule> rules_;
+    uint8_t defaultLane_;
+    bool needsRequest_;         // Alguma regra olha caminho ou header
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+
+struct HttpRequest;
+
+struct ResponseCacheConfig {
+    bool enabled = true;
+    size_t cacheBytes = 64 * 1024 * 1024;   // Total dividido igualmente entre os shards
+    size_t maxEntryBytes = 1024 * 1024;     // Respostas maiores são repassadas sem cópia
+    size_t shards = 16;
+    int coalesceTimeoutSeconds = 30;        // Espera máxima pela busca feita por outra thread
+};
+
+struct CachedResponse {
+    using Clock = std::chrono::steady_clock;
+
+    int statusCode = 200;
+    std::string statusText;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::shared_ptr<const std::string> body;
+    std::vector<std::pair<std::string, std::string>> vary;  // Header da requisição (minúsculo) e valor armazenado
+    Clock::time_point storedAt;
+    Clock::time_point freshUntil;
+    Clock::time_point staleUntil;           // Fim da janela de stale-while-revalidate
+    int64_t initialAge = 0;                 // Age informado pelo backend, em segundos
+
+    bool matchesRequest(const HttpRequest& request) const;
+    int64_t ageSeconds(Clock::time_point now) const;
+    size_t sizeBytes() const;
+};
+
+enum class CacheLookup {
+    Miss,
+    Fresh,
+    Stale       // Servível enquanto uma revalidação acontece em segundo plano
+};
+
+// Cache HTTP compartilhado (RFC 9111, cache compartilhado) para respostas dinâmicas.
+// Índice dividido em shards com lock próprio e LRU por bytes; falhas simultâneas na mesma
+// chave geram uma única busca no backend, as demais threads aguardam o resultado.
+class ResponseCache {
+public:
+    using Fetcher = std::function<std::shared_ptr<const CachedResponse>(const HttpRequest&)>;
+    struct Flight;
+
+    ResponseCache(const ResponseCacheConfig& config, Fetcher fetcher);
+    ~ResponseCache();
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // GET sem credenciais e sem Cache-Control: no-store/no-cache na requisição
+    static bool isCacheableRequest(const HttpRequest& request);
+    static std::string makeKey(const HttpRequest& request);
+
+    // Aplica as regras de armazenamento e de validade; nullptr se a resposta não é armazenável
+    static std::shared_ptr<const CachedResponse> makeEntry(const HttpRequest& request, int statusCode,
+                                                           std::string statusText,
+                                                           std::vector<std::pair<std::string, std::string>> headers,
+                                                           std::string body);
+
+    CacheLookup lookup(const std::string& key, const HttpRequest& request,
+                       std::shared_ptr<const CachedResponse>& entry);
+    void store(const std::string& key, std::shared_ptr<const CachedResponse> entry);
+
+    // O primeiro a chamar vira líder (`leader` = true) e deve chamar complete()
+    std::shared_ptr<Flight> join(const std::string& key, bool& leader);
+    void complete(const std::string& key, const std::shared_ptr<Flight>& flight,
+                  std::shared_ptr<const CachedResponse> entry);
+    // nullptr quando a resposta do líder não foi armazenável ou o prazo esgotou
+    std::shared_ptr<const CachedResponse> wait(const std::shared_ptr<Flight>& flight);
+
+    // Agenda uma única revalidação em segundo plano por chave
+    void revalidate(const std::string& key, const HttpRequest& request);
+
+    // Novo limite total, redistribuído entre os shards; o excedente é descartado na hora
+    void setCapacity(size_t cacheBytes);
+
+    size_t sizeBytes() const;
+    size_t entries() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const CachedResponse> response;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        size_t bytes = 0;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+        std::unordered_set<std::string> revalidating;
+    };
+
+    struct Revalidation {
+        std::string key;
+        std::shared_ptr<HttpRequest> request;
+    };
+
+    Shard& shardFor(const std::string& key);
+    void evict(Shard& shard);
+    void revalidationLoop();
+
+    ResponseCacheConfig config_;
+    Fetcher fetcher_;
+    std::atomic<size_t> shardBytes_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    std::mutex queueMutex_;
+    std::condition_variable queueCondition_;
+    std::deque<Revalidation> queue_;
+    bool running_ = true;
+    std::thread revalidationThread_;
+};
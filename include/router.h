@@ -0,0 +1,233 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <functional>
+#include <map>
+
+struct HttpRequest;
+struct HttpResponse;
+
+enum class HttpMethod : uint8_t {
+    Get,
+    Head,
+    Post,
+    Put,
+    Delete,
+    Patch,
+    Options,
+    Other
+};
+
+constexpr size_t kHttpMethodCount = static_cast<size_t>(HttpMethod::Other);
+
+// Separa pelo tamanho antes de comparar: no máximo duas comparações por método
+constexpr HttpMethod parseMethod(std::string_view method) {
+    switch (method.size()) {
+        case 3:
+            if (method == "GET") return HttpMethod::Get;
+            if (method == "PUT") return HttpMethod::Put;
+            break;
+        case 4:
+            if (method == "HEAD") return HttpMethod::Head;
+            if (method == "POST") return HttpMethod::Post;
+            break;
+        case 5:
+            if (method == "PATCH") return HttpMethod::Patch;
+            break;
+        case 6:
+            if (method == "DELETE") return HttpMethod::Delete;
+            break;
+        case 7:
+            if (method == "OPTIONS") return HttpMethod::Options;
+            break;
+    }
+    return HttpMethod::Other;
+}
+
+constexpr const char* methodName(HttpMethod method) {
+    constexpr const char* kNames[] = {"GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", ""};
+    return kNames[static_cast<size_t>(method)];
+}
+
+// Valor para o header Allow a partir de uma máscara de métodos (bit = HttpMethod)
+std::string allowHeader(uint32_t methods);
+
+// Segmentos capturados por ":nome" e "*" nas rotas registradas em tempo de execução
+struct RouteParams {
+    std::vector<std::pair<std::string_view, std::string_view>> values;
+
+    std::string_view get(std::string_view name) const;
+};
+
+// Rota declarada em tempo de compilação: caminho exato, chamada direta por ponteiro de função
+template<typename Context>
+struct StaticRoute {
+    using Handler = void (*)(Context&, const HttpRequest&, HttpResponse&);
+
+    HttpMethod method;
+    std::string_view path;
+    Handler handler;
+};
+
+namespace router_detail {
+
+constexpr int16_t kEmptySlot = -1;
+
+constexpr uint32_t hashPath(std::string_view path, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : path) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+constexpr size_t tableSizeFor(size_t count) {
+    size_t size = 16;
+    while (size < count * 4) {
+        size *= 2;
+    }
+    return size;
+}
+
+template<typename Context, size_t Count>
+struct RouteTable {
+    static constexpr size_t kSize = tableSizeFor(Count);
+    using Handler = typename StaticRoute<Context>::Handler;
+
+    uint32_t seed = 0;
+    int16_t slots[kSize] = {};
+    std::string_view paths[Count] = {};
+    uint32_t methods[Count] = {};
+    Handler handlers[Count][kHttpMethodCount] = {};
+};
+
+// Caminhos distintos: um mesmo caminho pode ter várias rotas, uma por método
+template<typename Context, size_t Count>
+constexpr bool isFirstOccurrence(const StaticRoute<Context> (&routes)[Count], size_t index) {
+    for (size_t i = 0; i < index; ++i) {
+        if (routes[i].path == routes[index].path) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Procura uma semente sem colisões entre os caminhos e monta a tabela de despacho
+template<typename Context, size_t Count>
+constexpr RouteTable<Context, Count> buildRouteTable(const StaticRoute<Context> (&routes)[Count]) {
+    constexpr size_t kSize = RouteTable<Context, Count>::kSize;
+    RouteTable<Context, Count> table{};
+
+    for (uint32_t seed = 1; seed < 100000 && table.seed == 0; ++seed) {
+        bool used[kSize] = {};
+        bool collision = false;
+        for (size_t i = 0; i < Count && !collision; ++i) {
+            if (!isFirstOccurrence(routes, i)) {
+                continue;
+            }
+            size_t slot = hashPath(routes[i].path, seed) & (kSize - 1);
+            collision = used[slot];
+            used[slot] = true;
+        }
+        if (!collision) {
+            table.seed = seed;
+        }
+    }
+
+    for (auto& slot : table.slots) {
+        slot = kEmptySlot;
+    }
+
+    int16_t groups = 0;
+    for (size_t i = 0; i < Count; ++i) {
+        size_t slot = hashPath(routes[i].path, table.seed) & (kSize - 1);
+        if (table.slots[slot] == kEmptySlot) {
+            table.slots[slot] = groups;
+            table.paths[groups] = routes[i].path;
+            groups++;
+        }
+
+        int16_t group = table.slots[slot];
+        size_t method = static_cast<size_t>(routes[i].method);
+        table.handlers[group][method] = routes[i].handler;
+        table.methods[group] |= 1u << method;
+    }
+    return table;
+}
+
+}
+
+// Despacho para uma tabela constexpr de rotas: hash perfeito do caminho calculado em tempo
+// de compilação (mesma técnica da tabela MIME) e um vetor de handlers indexado pelo método.
+// Por requisição: um hash, uma comparação de caminho e uma chamada direta.
+template<typename Context, const auto& Routes>
+class StaticRouter {
+public:
+    using Handler = typename StaticRoute<Context>::Handler;
+
+    // nullptr sem rota para o método; `allowed` recebe os métodos aceitos pelo caminho
+    static Handler find(HttpMethod method, std::string_view path, uint32_t& allowed) {
+        allowed = 0;
+        int16_t group = kTable.slots[router_detail::hashPath(path, kTable.seed) & (kTableSize - 1)];
+        if (group == router_detail::kEmptySlot || kTable.paths[group] != path) {
+            return nullptr;
+        }
+
+        allowed = kTable.methods[group];
+        if (method == HttpMethod::Other) {
+            return nullptr;
+        }
+        return kTable.handlers[group][static_cast<size_t>(method)];
+    }
+
+private:
+    static constexpr size_t kRouteCount = std::size(Routes);
+    static constexpr auto kTable = router_detail::buildRouteTable<Context, kRouteCount>(Routes);
+    static constexpr size_t kTableSize = decltype(kTable)::kSize;
+    static_assert(kTable.seed != 0, "No perfect hash seed found for the route table");
+};
+
+// Árvore de rotas registradas em tempo de execução (plugins), por segmento de caminho.
+// Padrões: "/users/:id" captura um segmento, "/files/*" captura o restante.
+// O registro deve acontecer antes do início do servidor; a busca não usa locks.
+class RouteTrie {
+public:
+    using Handler = std::function<void(const HttpRequest&, HttpResponse&, const RouteParams&)>;
+
+    struct Entry {
+        Handler handler;
+        bool streamBody = false;    // true: o handler lê o corpo via HttpRequest::bodyReader
+    };
+
+    RouteTrie();
+    ~RouteTrie();
+
+    void add(HttpMethod method, std::string_view pattern, Handler handler, bool streamBody = false);
+
+    // nullptr sem rota para o método; `allowed` recebe os métodos aceitos pelo caminho
+    const Entry* find(HttpMethod method, std::string_view path, RouteParams& params, uint32_t& allowed) const;
+
+    bool empty() const;
+
+private:
+    struct Node {
+        std::map<std::string, std::unique_ptr<Node>, std::less<>> children;   // Busca sem alocar
+        std::unique_ptr<Node> param;
+        std::string paramName;              // Nome do parâmetro do filho `param`
+        std::unique_ptr<Node> wildcard;
+        Entry entries[kHttpMethodCount];
+        uint32_t methods = 0;
+    };
+
+    static const Node* match(const Node* node, std::string_view remaining, RouteParams& params);
+
+    std::unique_ptr<Node> root_;
+    size_t routes_ = 0;
+};
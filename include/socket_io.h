@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "connection.h"
+#include "timer_wheel.h"
+
+#include <sys/uio.h>
+
+// Agenda no timing wheel o encerramento do socket caso o prazo expire,
+// acordando a thread bloqueada em recv/send; cancela ao sair do escopo
+class SocketDeadline {
+public:
+    SocketDeadline(TimerWheel& timers, SOCKET socket, std::chrono::milliseconds timeout);
+    SocketDeadline(TimerWheel& timers, SOCKET socket, int seconds);
+    ~SocketDeadline();
+
+    // Desarma antes do fim do escopo (ex.: o envio passa a ter prazos por janela)
+    void cancel();
+
+    SocketDeadline(const SocketDeadline&) = delete;
+    SocketDeadline& operator=(const SocketDeadline&) = delete;
+
+private:
+    TimerWheel& timers_;
+    TimerWheel::TimerId id_;
+};
+
+// Escritas completas (repetem envios parciais); false em erro ou conexão fechada
+bool sendAll(SOCKET socket, const char* data, size_t length);
+bool sendVectored(SOCKET socket, std::vector<iovec>& buffers);
+bool sendFileRange(SOCKET socket, int fd, uint64_t offset, uint64_t length);
+
+// Mesmas escritas em janelas de até `window` bytes, cada uma com o próprio prazo `stall`: a
+// thread só segue para a próxima janela quando o socket aceitou a anterior, e uma transferência
+// longa só expira quando deixa de progredir
+bool sendVectoredWindowed(TimerWheel& timers, SOCKET socket, std::vector<iovec>& buffers,
+                          uint64_t window, std::chrono::milliseconds stall);
+bool sendFileWindowed(TimerWheel& timers, SOCKET socket, int fd, uint64_t offset, uint64_t length,
+                      uint64_t window, std::chrono::milliseconds stall);
+
+// Conecta com prazo (connect não bloqueante + poll); retorna o socket já bloqueante ou -1
+SOCKET connectWithTimeout(const std::string& host, int port, int timeoutMs);
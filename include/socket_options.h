@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include "connection.h"
+
+// Opções de socket aplicadas ao socket de escuta e às conexões aceitas. Os perfis nomeados
+// escolhem um conjunto coerente; as opções avulsas da linha de comando ajustam por cima.
+struct SocketOptions {
+    int backlog = 0;                // listen(); 0 usa SOMAXCONN
+    int deferAcceptSeconds = 0;     // TCP_DEFER_ACCEPT: accept só acorda quando chegam dados
+    int fastOpenQueue = 0;          // TCP_FASTOPEN: dados já no SYN (cliente com cookie)
+    int receiveBuffer = 0;          // SO_RCVBUF/SO_SNDBUF no socket de escuta (herdados pelas
+    int sendBuffer = 0;             // conexões); 0 mantém o ajuste automático do kernel
+    bool noDelay = false;           // TCP_NODELAY nas conexões aceitas
+    bool cork = false;              // TCP_CORK em respostas de várias escritas (headers + sendfile, chunked)
+    int busyPollMicros = 0;         // SO_BUSY_POLL nas conexões aceitas
+
+    // "default" (só o essencial), "latency" ou "throughput"; false para nome desconhecido
+    static bool fromProfile(const std::string& name, SocketOptions& options);
+};
+
+// Antes do listen(): buffers precisam estar no socket de escuta para valer na negociação
+void applyListenerOptions(SOCKET socket, const SocketOptions& options);
+// Opções que só existem em socket já em escuta (ou que podem mudar num socket herdado)
+void applyListeningOptions(SOCKET socket, const SocketOptions& options);
+void applyConnectionOptions(SOCKET socket, const SocketOptions& options);
+
+// TCP_CORK: segura segmentos parciais até o uncork, juntando headers e corpo
+void setCork(SOCKET socket, bool enabled);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+
+struct StreamingConfig {
+    uint64_t windowBytes = 1024 * 1024;             // Cada sendfile/writev de um corpo envia no máximo isto
+    int stallTimeoutSeconds = 30;                   // Prazo de cada janela: downloads longos só expiram parados
+    size_t connectionBufferBytes = 256 * 1024;      // Corpo copiado em memória por conexão de cada vez
+    size_t maxBufferedBytes = 64 * 1024 * 1024;     // Soma entre todas as conexões; 0 sem limite
+};
+
+struct StreamBufferStats {
+    size_t buffered = 0;
+    size_t peak = 0;
+    uint64_t waits = 0;         // Reservas que esperaram outra conexão liberar espaço
+    uint64_t denied = 0;        // Reservas recusadas (prazo esgotado ou maiores que o limite)
+};
+
+// Contabilidade global dos bytes de corpo copiados para memória do processo durante o envio
+// (blocos lidos com pread pelo HTTP/2, arquivo lido para compressão, blocos de geradores). O que
+// sai por sendfile ou de um mapeamento não passa por aqui. Com o limite atingido, quem reserva
+// espera: os envios das outras conexões são a contrapressão, e alguns downloads grandes
+// simultâneos não conseguem esgotar a memória.
+class StreamBuffers {
+public:
+    explicit StreamBuffers(const StreamingConfig& config = {});
+
+    StreamBuffers(const StreamBuffers&) = delete;
+    StreamBuffers& operator=(const StreamBuffers&) = delete;
+
+    const StreamingConfig& config() const;
+    std::chrono::milliseconds stallTimeout() const;
+
+    // Espera até `wait` por espaço para `bytes`; false se não couber nesse prazo
+    bool acquire(size_t bytes, std::chrono::milliseconds wait);
+    void release(size_t bytes);
+
+    StreamBufferStats stats() const;
+
+private:
+    StreamingConfig config_;
+    mutable std::mutex mutex_;
+    std::condition_variable released_;
+    size_t buffered_;
+    size_t peak_;
+    std::atomic<uint64_t> waits_;
+    std::atomic<uint64_t> denied_;
+};
+
+// Reserva liberada ao sair do escopo
+class StreamBufferReservation {
+public:
+    StreamBufferReservation(StreamBuffers& buffers, size_t bytes, std::chrono::milliseconds wait);
+    ~StreamBufferReservation();
+
+    StreamBufferReservation(const StreamBufferReservation&) = delete;
+    StreamBufferReservation& operator=(const StreamBufferReservation&) = delete;
+
+    explicit operator bool() const;
+
+private:
+    StreamBuffers& buffers_;
+    size_t bytes_;
+    bool granted_;
+};
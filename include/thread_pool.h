@@ -18,11 +18,15 @@ public:
     void enqueue(F&& f);
     
     void shutdown();
+    // Ajusta o número de threads em execução; as excedentes saem quando ficam ociosas
+    void resize(size_t numThreads);
     size_t size() const;
     size_t getActiveThreads() const;
     size_t getQueueSize() const;
 
 private:
+    void spawnWorker();
+    
     std::vector<std::thread> workers_;
     std::queue<std::function<void()>> tasks_;
     
@@ -30,6 +34,8 @@ private:
     std::condition_variable condition_;
     std::atomic<bool> stop_;
     std::atomic<size_t> activeThreads_;
+    size_t liveThreads_;
+    size_t retiring_;           // Threads que devem sair ao ficar ociosas (protegido por queueMutex_)
 };
 
 template<class F>
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <functional>
+
+// Timing wheel hierárquico (4 níveis x 64 slots) com inserção e cancelamento O(1).
+// Os callbacks expirados são executados por advance() com o lock interno adquirido:
+// eles não podem chamar schedule()/cancel(), e após cancel() retornar o callback
+// garantidamente não está em execução.
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr TimerId kInvalidTimer = 0;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10));
+
+    TimerId schedule(std::chrono::milliseconds delay, std::function<void()> callback);
+    bool cancel(TimerId id);
+
+    void advance(Clock::time_point now = Clock::now());
+
+    size_t size() const;
+    std::chrono::milliseconds tick() const;
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr uint32_t kSlotMask = kSlots - 1;
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Node {
+        uint64_t expiry = 0;
+        uint32_t generation = 0;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        uint32_t* head = nullptr;
+        bool active = false;
+        std::function<void()> callback;
+    };
+
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void step();
+
+    mutable std::mutex mutex_;
+    std::chrono::milliseconds tick_;
+    Clock::time_point start_;
+    uint64_t currentTick_ = 0;
+    size_t count_ = 0;
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeList_;
+    std::array<std::array<uint32_t, kSlots>, kLevels> slots_;
+};
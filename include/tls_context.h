@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include "connection.h"
+#include "timer_wheel.h"
+
+struct ssl_ctx_st;
+
+struct TlsConfig {
+    std::string certificateFile;        // PEM com a cadeia completa; vazio desativa o TLS
+    std::string keyFile;                // Vazio: a chave está no mesmo arquivo do certificado
+    std::string ticketKeyFile;          // 80 bytes aleatórios; vazio gera chaves só deste processo
+    int handshakeTimeoutSeconds = 10;
+    int sessionTimeoutSeconds = 7200;   // Validade das sessões retomáveis (tickets e cache)
+
+    bool enabled() const { return !certificateFile.empty(); }
+};
+
+struct TlsStats {
+    uint64_t handshakes = 0;
+    uint64_t resumed = 0;       // Handshakes abreviados (ticket ou cache de sessão)
+    uint64_t failed = 0;
+    uint64_t notOffloaded = 0;  // Handshake completo mas o kernel não assumiu as duas direções
+};
+
+// Terminação TLS com o OpenSSL só no handshake: concluído, as chaves vão para o kernel (kTLS) nas
+// duas direções e o socket volta a ser usado como TCP comum. recv, writev e sendfile seguem os
+// mesmos caminhos do HTTP em texto claro, e o sendfile continua sem cópia para o processo.
+// Um único contexto atende todas as threads: tickets e cache de sessão valem em qualquer uma, e
+// com `ticketKeyFile` também entre processos (troca de binário, instâncias com SO_REUSEPORT).
+class TlsContext {
+public:
+    // Lança std::runtime_error se o certificado ou a chave não carregarem, ou sem kTLS no kernel
+    TlsContext(const TlsConfig& config, bool offerHttp2);
+    ~TlsContext();
+
+    TlsContext(const TlsContext&) = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+    // Handshake no socket bloqueante da conexão, com prazo; false se falhar ou se o kernel não
+    // assumir a criptografia (a conexão deve ser fechada)
+    bool accept(Connection& connection, TimerWheel& timers);
+
+    TlsStats stats() const;
+
+    // O módulo "tls" do kernel aceita ser ligado a um socket TCP (TCP_ULP)
+    static bool kernelSupported();
+
+private:
+    TlsConfig config_;
+    bool offerHttp2_;           // "h2" no ALPN antes de "http/1.1"
+    ssl_ctx_st* context_;
+    std::atomic<uint64_t> handshakes_;
+    std::atomic<uint64_t> resumed_;
+    std::atomic<uint64_t> failed_;
+    std::atomic<uint64_t> notOffloaded_;
+};
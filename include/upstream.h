@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include "connection.h"
+
+enum class BalancePolicy {
+    RoundRobin,
+    LeastConnections
+};
+
+struct Backend {
+    Backend(const std::string& host, int port);
+
+    std::string host;
+    int port;
+    uint64_t id;                        // Único no processo; chave dos pools por thread
+    std::atomic<bool> healthy;
+    std::atomic<int> activeRequests;
+};
+
+// Conjunto de backends de uma rota, com escolha balanceada entre os saudáveis
+class UpstreamGroup {
+public:
+    UpstreamGroup(const std::vector<std::string>& backends, BalancePolicy policy);
+
+    // nullptr quando nenhum backend está saudável
+    Backend* select();
+
+    std::vector<std::unique_ptr<Backend>>& backends();
+
+private:
+    std::vector<std::unique_ptr<Backend>> backends_;
+    BalancePolicy policy_;
+    std::atomic<size_t> next_;
+};
+
+// Pool de conexões keep-alive com os backends, um por thread trabalhadora (sem locks)
+class UpstreamConnectionPool {
+public:
+    static UpstreamConnectionPool& local();
+
+    ~UpstreamConnectionPool();
+
+    // Reaproveita uma conexão ociosa ainda aberta ou conecta uma nova; -1 em falha
+    SOCKET acquire(const Backend& backend, int connectTimeoutMs, bool& reused);
+    void release(const Backend& backend, SOCKET socket, size_t maxIdle);
+
+private:
+    UpstreamConnectionPool() = default;
+
+    std::unordered_map<uint64_t, std::vector<SOCKET>> idle_;
+};
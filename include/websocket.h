@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include "connection.h"
+
+struct HttpRequest;
+struct HttpResponse;
+
+enum class SlowConsumerPolicy {
+    Disconnect,     // Fila cheia: o cliente é desconectado (código 1008)
+    DropMessages    // Fila cheia: as novas mensagens são descartadas para esse cliente
+};
+
+struct WebSocketConfig {
+    size_t maxClients = 10000;
+    size_t maxMessageBytes = 1024 * 1024;   // Mensagens recebidas (já remontadas)
+    size_t maxQueuedBytes = 4 * 1024 * 1024;    // Fila de saída por cliente
+    SlowConsumerPolicy slowConsumers = SlowConsumerPolicy::Disconnect;
+    int pingIntervalSeconds = 30;           // Ping após este tempo sem tráfego; fecha após o dobro
+};
+
+class WebSocketHub;
+using WebSocketClientId = uint64_t;
+
+// Callbacks de um endpoint, chamados pela thread do hub sem locks: podem publicar e enviar
+struct WebSocketHandlers {
+    std::function<void(WebSocketHub&, WebSocketClientId, std::string_view message, bool binary)> onMessage;
+    std::function<void(WebSocketHub&, WebSocketClientId)> onClose;
+};
+
+// Conexões WebSocket (RFC 6455) mantidas por uma thread epoll própria, com tópicos de broadcast.
+// Uma publicação monta o frame uma única vez em um buffer compartilhado (shared_ptr) que entra na
+// fila de cada assinante sem cópias; a thread do hub esvazia as filas com writev não bloqueante.
+class WebSocketHub {
+public:
+    explicit WebSocketHub(const WebSocketConfig& config = {});
+    ~WebSocketHub();
+
+    WebSocketHub(const WebSocketHub&) = delete;
+    WebSocketHub& operator=(const WebSocketHub&) = delete;
+
+    // Valida o handshake e prepara o 101 em `response`; a conexão passa ao hub depois do envio.
+    // false com o erro já em `response` (400, 426 ou 503) quando o upgrade não é possível.
+    bool accept(const HttpRequest& request, HttpResponse& response,
+                std::shared_ptr<const WebSocketHandlers> handlers, std::vector<std::string> topics = {});
+
+    void subscribe(WebSocketClientId client, const std::string& topic);
+    void unsubscribe(WebSocketClientId client, const std::string& topic);
+
+    // Retorna o número de assinantes que receberam a mensagem na fila
+    size_t publish(const std::string& topic, std::string_view message, bool binary = false);
+    bool send(WebSocketClientId client, std::string_view message, bool binary = false);
+    void close(WebSocketClientId client, uint16_t code = 1000);
+    // Encerramento do servidor: inicia o fechamento de todos os clientes (1001 = going away)
+    void closeAll(uint16_t code = 1001);
+
+    size_t clients() const;
+    uint64_t droppedMessages() const;
+
+private:
+    using Frame = std::shared_ptr<const std::string>;
+    struct Client;
+
+    void attach(SOCKET socket, std::string pending, std::shared_ptr<const WebSocketHandlers> handlers,
+                std::vector<std::string> topics);
+    void run();
+    void readClient(Client& client, std::vector<std::function<void()>>& callbacks);
+    bool parseFrames(Client& client, std::vector<std::function<void()>>& callbacks);
+    bool enqueue(Client& client, const Frame& frame);
+    void flush(Client& client);
+    void beginClose(Client& client, uint16_t code);
+    void removeClient(WebSocketClientId id, std::vector<std::function<void()>>& callbacks);
+    Client* findClient(WebSocketClientId id);
+    void checkIdle();
+    void wakeup();
+
+    WebSocketConfig config_;
+    int epollFd_;
+    int wakeFd_;
+    std::atomic<bool> running_;
+    std::once_flag started_;
+    std::thread thread_;
+    std::atomic<WebSocketClientId> nextId_;
+    std::atomic<uint64_t> droppedMessages_;
+
+    // Filas de saída, clientes e tópicos; a leitura de cada socket é exclusiva da thread do hub
+    mutable std::mutex mutex_;
+    std::unordered_map<WebSocketClientId, std::unique_ptr<Client>> clients_;
+    std::unordered_map<std::string, std::unordered_set<WebSocketClientId>> topics_;
+    std::vector<WebSocketClientId> dirty_;      // Clientes com dados novos na fila
+    std::vector<WebSocketClientId> attached_;   // Recém-chegados com bytes já lidos pelo HTTP
+    std::vector<WebSocketClientId> closed_;     // A remover pela thread do hub
+    std::atomic<size_t> clientCount_;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include "connection_queue.h"
+#include "request_lanes.h"
+
+enum class DispatchPolicy {
+    Shared,         // Uma fila disputada por todas as threads
+    RoundRobin,     // Fila por thread, em rodízio
+    LeastLoaded,    // Fila por thread, a de menos conexões (na fila + em atendimento)
+    Affinity        // Fila por thread escolhida pelo IP do cliente: keep-alive volta à mesma thread
+};
+
+struct WorkerLoad {
+    uint64_t handled = 0;
+    uint64_t busyMicros = 0;
+    size_t queued = 0;
+};
+
+struct DispatchStats {
+    DispatchPolicy policy = DispatchPolicy::Shared;
+    std::vector<WorkerLoad> workers;
+    size_t queued = 0;
+    double imbalance = 1.0;     // Maior tempo ocupado / média entre as threads; 1.0 é equilíbrio perfeito
+    uint64_t rerouted = 0;      // Conexões que foram para outra fila (a escolhida cheia ou desativada)
+    std::vector<LaneStats> lanes;
+};
+
+// Distribui as conexões aceitas (e as keep-alive que voltam do event loop) entre as threads
+// trabalhadoras. Cada thread tem um índice fixo em [0, workers). Com fila por thread não há
+// disputa por um lock só, mas uma conexão longa atrasa as que estão atrás dela na mesma fila:
+// muitas requisições curtas vão bem em round-robin, downloads longos em least-loaded.
+class WorkerDispatcher {
+public:
+    // Com `lanes`, cada fila escolhe entre as faixas de prioridade por deficit round robin
+    WorkerDispatcher(DispatchPolicy policy, size_t queueCapacity, size_t workers,
+                     std::shared_ptr<RequestLanes> lanes = nullptr);
+
+    WorkerDispatcher(const WorkerDispatcher&) = delete;
+    WorkerDispatcher& operator=(const WorkerDispatcher&) = delete;
+
+    // push só assume a posse da conexão quando retorna true
+    bool push(std::unique_ptr<Connection>& connection, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    bool pop(size_t worker, std::unique_ptr<Connection>& connection, std::chrono::milliseconds timeout);
+
+    // Threads ativas; as de índice acima deixam de receber conexões
+    void setWorkers(size_t workers);
+    // Thread `worker` saindo: desativa sua fila e passa o que restou nela às outras; retorna as
+    // conexões que não couberam em lugar nenhum (fechadas)
+    size_t retire(size_t worker);
+    // Thread `worker` (re)começando
+    void activate(size_t worker);
+
+    // Contabilidade do tempo de atendimento, base da métrica de desequilíbrio
+    void begin(size_t worker);
+    void finish(size_t worker, uint8_t lane, std::chrono::steady_clock::duration busy);
+
+    size_t size() const;
+    bool empty() const;
+    // Nada que a thread `worker` ainda precise atender
+    bool empty(size_t worker) const;
+    // Descarta (fecha) as conexões ainda nas filas; retorna quantas
+    size_t clear();
+    void shutdown();
+
+    DispatchStats stats() const;
+
+    // "shared", "round-robin", "least-loaded" ou "affinity"; false para nome desconhecido
+    static bool parsePolicy(const std::string& name, DispatchPolicy& policy);
+    static const char* policyName(DispatchPolicy policy);
+
+    static constexpr size_t kMaxWorkers = 1024;
+
+private:
+    struct Slot {
+        Slot(size_t capacity, std::shared_ptr<RequestLanes> lanes) : queue(capacity, std::move(lanes)) {}
+
+        ConnectionQueue queue;              // Sem uso na política Shared (exceto a do índice 0)
+        std::atomic<size_t> queued{0};      // Espelho do tamanho da fila, lido sem o lock dela
+        std::atomic<size_t> busy{0};        // Conexão em atendimento (0 ou 1)
+        std::atomic<uint64_t> handled{0};
+        std::atomic<uint64_t> busyMicros{0};
+    };
+
+    size_t choose(const Connection& connection, size_t workers);
+    Slot& slot(size_t index) const;
+
+    DispatchPolicy policy_;
+    size_t queueCapacity_;
+    std::shared_ptr<RequestLanes> lanes_;
+    // Tamanho fixo; entradas criadas em setWorkers e nunca removidas, publicadas por allocated_
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::atomic<size_t> allocated_;
+    std::atomic<size_t> workers_;
+    std::mutex growMutex_;
+    std::atomic<size_t> next_;
+    std::atomic<uint64_t> rerouted_;
+};
@@ -0,0 +1,238 @@
+#include "access_log.h"
+#include "logger.h"
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr auto kFlushInterval = std::chrono::milliseconds(100);
+constexpr size_t kFlushRecords = 4096;          // Lote cheio acorda a escrita antes do intervalo
+
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void encodeAddress(const std::string& text, uint8_t* address) {
+    in_addr v4;
+    if (inet_pton(AF_INET, text.c_str(), &v4) == 1) {
+        address[10] = 0xff;
+        address[11] = 0xff;
+        std::memcpy(address + 12, &v4, sizeof(v4));
+        return;
+    }
+    in6_addr v6;
+    if (inet_pton(AF_INET6, text.c_str(), &v6) == 1) {
+        std::memcpy(address, &v6, sizeof(v6));
+    }
+}
+
+} // namespace
+
+AccessLog::AccessLog(const AccessLogConfig& config)
+    : config_(config) {
+    if (config_.path.empty()) {
+        return;
+    }
+
+    loadPaths();
+    pathsFd_ = open(pathsFile(config_.path).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (pathsFd_ < 0 || !openCurrent()) {
+        throw std::runtime_error("Failed to open access log " + config_.path + ": " + std::strerror(errno));
+    }
+
+    enabled_ = true;
+    pending_.reserve(kFlushRecords);
+    writer_ = std::thread(&AccessLog::writerLoop, this);
+    Logger::getInstance().info("Writing binary access log to " + config_.path + " (" +
+                               std::to_string(pathIds_.size()) + " known paths)");
+}
+
+AccessLog::~AccessLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+    if (pathsFd_ >= 0) {
+        close(pathsFd_);
+    }
+}
+
+bool AccessLog::enabled() const {
+    return enabled_;
+}
+
+void AccessLog::record(AccessRecord& record, const std::string& path, const std::string& address) {
+    if (!enabled_) {
+        return;
+    }
+    encodeAddress(address, record.address);
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() >= config_.maxPendingRecords) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        record.pathId = internPath(path);
+        pending_.push_back(record);
+        wake = pending_.size() == kFlushRecords;
+    }
+    if (wake) {
+        condition_.notify_one();
+    }
+}
+
+uint64_t AccessLog::droppedRecords() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+void AccessLog::loadPaths() {
+    // Os ids já gravados continuam válidos para os arquivos rotacionados de execuções anteriores
+    std::ifstream file(pathsFile(config_.path));
+    std::string line;
+    uint32_t id = 0;
+    while (std::getline(file, line)) {
+        pathIds_.emplace(line, id++);
+    }
+}
+
+uint32_t AccessLog::internPath(const std::string& path) {
+    auto it = pathIds_.find(path);
+    if (it != pathIds_.end()) {
+        return it->second;
+    }
+    if (pathIds_.size() >= config_.maxPaths || path.find('\n') != std::string::npos) {
+        return kAccessLogOtherPath;
+    }
+    uint32_t id = static_cast<uint32_t>(pathIds_.size());
+    pathIds_.emplace(path, id);
+    newPaths_ += path;
+    newPaths_ += '\n';
+    return id;
+}
+
+bool AccessLog::openCurrent() {
+    fd_ = open(config_.path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd_, &info) < 0) {
+        return false;
+    }
+
+    // Arquivo existente: continua nele se o formato bate, descartando um registro incompleto
+    uint64_t size = static_cast<uint64_t>(info.st_size);
+    if (size >= sizeof(AccessLogHeader)) {
+        AccessLogHeader header;
+        if (pread(fd_, &header, sizeof(header), 0) == sizeof(header) &&
+            std::memcmp(header.magic, kAccessLogMagic, sizeof(header.magic)) == 0 &&
+            header.version == kAccessLogVersion && header.recordSize == sizeof(AccessRecord)) {
+            uint64_t whole = size - (size - sizeof(AccessLogHeader)) % sizeof(AccessRecord);
+            if (whole != size && ftruncate(fd_, static_cast<off_t>(whole)) < 0) {
+                return false;
+            }
+            fileBytes_ = whole;
+            return true;
+        }
+    }
+
+    if (ftruncate(fd_, 0) < 0) {
+        return false;
+    }
+    AccessLogHeader header{};
+    std::memcpy(header.magic, kAccessLogMagic, sizeof(header.magic));
+    header.version = kAccessLogVersion;
+    header.recordSize = sizeof(AccessRecord);
+    fileBytes_ = sizeof(header);
+    return writeAll(fd_, reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void AccessLog::rotate() {
+    close(fd_);
+    fd_ = -1;
+
+    for (int index = config_.maxFiles; index > 1; --index) {
+        std::string from = config_.path + "." + std::to_string(index - 1);
+        std::string to = config_.path + "." + std::to_string(index);
+        rename(from.c_str(), to.c_str());
+    }
+    if (config_.maxFiles > 0) {
+        rename(config_.path.c_str(), (config_.path + ".1").c_str());
+    } else {
+        unlink(config_.path.c_str());
+    }
+
+    if (!openCurrent()) {
+        Logger::getInstance().error("Failed to reopen access log " + config_.path + ": " + std::strerror(errno));
+    }
+}
+
+void AccessLog::writerLoop() {
+    std::vector<AccessRecord> batch;
+    batch.reserve(kFlushRecords);
+    std::string paths;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        condition_.wait_for(lock, kFlushInterval, [this] {
+            return stopping_ || pending_.size() >= kFlushRecords;
+        });
+        bool stopping = stopping_;
+        batch.swap(pending_);
+        paths.swap(newPaths_);
+        lock.unlock();
+
+        // Dicionário antes dos registros: um id no log sempre tem sua linha gravada
+        if (!paths.empty() && pathsFd_ >= 0) {
+            writeAll(pathsFd_, paths.data(), paths.size());
+            paths.clear();
+        }
+
+        if (!batch.empty()) {
+            uint64_t bytes = batch.size() * sizeof(AccessRecord);
+            if (fileBytes_ > sizeof(AccessLogHeader) && fileBytes_ + bytes > config_.maxFileBytes) {
+                rotate();
+            }
+            if (fd_ >= 0 && writeAll(fd_, reinterpret_cast<const char*>(batch.data()), bytes)) {
+                fileBytes_ += bytes;
+            } else {
+                dropped_.fetch_add(batch.size(), std::memory_order_relaxed);
+            }
+            batch.clear();
+        }
+
+        if (stopping) {
+            return;
+        }
+        lock.lock();
+    }
+}
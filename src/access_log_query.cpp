@@ -0,0 +1,306 @@
+#include "access_log.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Consulta offline do log de acesso binário: mapeia os arquivos, divide os registros entre
+// threads e junta os agregados (caminhos mais acessados e latência por status).
+
+namespace {
+
+// Histograma logarítmico: 16 sub-faixas por potência de 2 (erro relativo de até ~6%)
+constexpr int kSubBuckets = 16;
+constexpr int kBuckets = 29 * kSubBuckets;
+
+int bucketOf(uint32_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<int>(value);
+    }
+    int shift = 31 - __builtin_clz(value) - 4;
+    return (shift + 1) * kSubBuckets + static_cast<int>((value >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t bucketUpperBound(int bucket) {
+    if (bucket < kSubBuckets) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int shift = bucket / kSubBuckets - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket % kSubBuckets);
+    return (((kSubBuckets | sub) + 1) << shift) - 1;
+}
+
+struct PathTotals {
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+};
+
+struct StatusTotals {
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+    uint64_t handlerUs = 0;
+    uint64_t sendUs = 0;
+    uint32_t maxUs = 0;
+    std::vector<uint64_t> histogram = std::vector<uint64_t>(kBuckets, 0);
+
+    uint64_t percentile(double fraction) const {
+        uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(requests));
+        uint64_t seen = 0;
+        for (int bucket = 0; bucket < kBuckets; ++bucket) {
+            seen += histogram[bucket];
+            if (seen > target) {
+                return std::min<uint64_t>(bucketUpperBound(bucket), maxUs);
+            }
+        }
+        return maxUs;
+    }
+};
+
+struct Totals {
+    uint64_t records = 0;
+    uint64_t firstUs = UINT64_MAX;
+    uint64_t lastUs = 0;
+    std::unordered_map<uint32_t, PathTotals> paths;
+    std::map<uint16_t, StatusTotals> statuses;
+
+    void add(const AccessRecord& record) {
+        ++records;
+        firstUs = std::min(firstUs, record.timestampUs);
+        lastUs = std::max(lastUs, record.timestampUs);
+
+        PathTotals& path = paths[record.pathId];
+        ++path.requests;
+        path.bytes += record.bytesSent;
+
+        // Latência do servidor: da requisição completa até o fim do envio
+        uint32_t serviceUs = record.handlerUs + record.sendUs;
+        StatusTotals& status = statuses[record.status];
+        ++status.requests;
+        status.bytes += record.bytesSent;
+        status.handlerUs += record.handlerUs;
+        status.sendUs += record.sendUs;
+        status.maxUs = std::max(status.maxUs, serviceUs);
+        ++status.histogram[bucketOf(serviceUs)];
+    }
+
+    void merge(const Totals& other) {
+        records += other.records;
+        firstUs = std::min(firstUs, other.firstUs);
+        lastUs = std::max(lastUs, other.lastUs);
+        for (const auto& entry : other.paths) {
+            PathTotals& path = paths[entry.first];
+            path.requests += entry.second.requests;
+            path.bytes += entry.second.bytes;
+        }
+        for (const auto& entry : other.statuses) {
+            StatusTotals& status = statuses[entry.first];
+            status.requests += entry.second.requests;
+            status.bytes += entry.second.bytes;
+            status.handlerUs += entry.second.handlerUs;
+            status.sendUs += entry.second.sendUs;
+            status.maxUs = std::max(status.maxUs, entry.second.maxUs);
+            for (int bucket = 0; bucket < kBuckets; ++bucket) {
+                status.histogram[bucket] += entry.second.histogram[bucket];
+            }
+        }
+    }
+};
+
+struct MappedLog {
+    std::string path;
+    void* data = MAP_FAILED;
+    size_t size = 0;
+    const AccessRecord* records = nullptr;
+    size_t count = 0;
+};
+
+bool mapLog(MappedLog& log) {
+    int fd = open(log.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << log.path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < sizeof(AccessLogHeader)) {
+        std::cerr << "Not an access log: " << log.path << "\n";
+        close(fd);
+        return false;
+    }
+
+    log.size = static_cast<size_t>(info.st_size);
+    log.data = mmap(nullptr, log.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (log.data == MAP_FAILED) {
+        std::cerr << "Cannot map " << log.path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    madvise(log.data, log.size, MADV_SEQUENTIAL);
+
+    const auto* header = static_cast<const AccessLogHeader*>(log.data);
+    if (std::memcmp(header->magic, kAccessLogMagic, sizeof(header->magic)) != 0 ||
+        header->version != kAccessLogVersion || header->recordSize != sizeof(AccessRecord)) {
+        std::cerr << "Unsupported access log format: " << log.path << "\n";
+        return false;
+    }
+
+    // Um registro incompleto no fim (arquivo ainda em escrita) é ignorado
+    log.records = reinterpret_cast<const AccessRecord*>(static_cast<const char*>(log.data) + sizeof(AccessLogHeader));
+    log.count = (log.size - sizeof(AccessLogHeader)) / sizeof(AccessRecord);
+    return true;
+}
+
+// access.log.3 -> access.log.paths
+std::string defaultPathsFile(const std::string& logPath) {
+    size_t dot = logPath.find_last_of('.');
+    if (dot != std::string::npos && dot + 1 < logPath.size() &&
+        std::all_of(logPath.begin() + static_cast<long>(dot) + 1, logPath.end(), ::isdigit)) {
+        return AccessLog::pathsFile(logPath.substr(0, dot));
+    }
+    return AccessLog::pathsFile(logPath);
+}
+
+std::vector<std::string> loadPaths(const std::string& file) {
+    std::vector<std::string> paths;
+    std::ifstream input(file);
+    std::string line;
+    while (std::getline(input, line)) {
+        paths.push_back(line);
+    }
+    return paths;
+}
+
+std::string pathName(const std::vector<std::string>& paths, uint32_t id) {
+    if (id == kAccessLogOtherPath) {
+        return "(other)";
+    }
+    return id < paths.size() ? paths[id] : "(unknown #" + std::to_string(id) + ")";
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--top N] [--threads N] [--paths <file>] <log> [log...]\n";
+    std::cout << "Example: " << program << " --top 20 logs/access.bin logs/access.bin.1\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t top = 10;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string pathsFile;
+    std::vector<MappedLog> logs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--top" || arg == "--threads" || arg == "--paths") && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (arg == "--top") {
+                top = std::stoul(value);
+            } else if (arg == "--threads") {
+                threads = std::max<size_t>(1, std::stoul(value));
+            } else {
+                pathsFile = value;
+            }
+        } else if (arg == "--help" || arg.rfind("--", 0) == 0) {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        } else {
+            MappedLog log;
+            log.path = arg;
+            logs.push_back(log);
+        }
+    }
+
+    if (logs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    for (auto& log : logs) {
+        if (!mapLog(log)) {
+            return 1;
+        }
+    }
+    if (pathsFile.empty()) {
+        pathsFile = defaultPathsFile(logs.front().path);
+    }
+    std::vector<std::string> paths = loadPaths(pathsFile);
+
+    // Cada thread agrega a mesma fatia de cada arquivo; a junção é feita no fim
+    std::vector<Totals> partial(threads);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (const auto& log : logs) {
+                size_t begin = log.count * t / threads;
+                size_t end = log.count * (t + 1) / threads;
+                for (size_t i = begin; i < end; ++i) {
+                    partial[t].add(log.records[i]);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    Totals totals;
+    for (const auto& part : partial) {
+        totals.merge(part);
+    }
+    for (auto& log : logs) {
+        munmap(log.data, log.size);
+    }
+
+    std::cout << "=== Access Log Summary ===\n";
+    std::cout << "Files: " << logs.size() << "\n";
+    std::cout << "Records: " << totals.records << "\n";
+    if (totals.records == 0) {
+        return 0;
+    }
+    std::cout << "Span: " << std::fixed << std::setprecision(1)
+              << (totals.lastUs - totals.firstUs) / 1e6 << "s\n\n";
+
+    std::vector<std::pair<uint32_t, PathTotals>> ranked(totals.paths.begin(), totals.paths.end());
+    auto printTop = [&](const char* title, bool byBytes) {
+        size_t count = std::min(top, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + static_cast<long>(count), ranked.end(),
+            [byBytes](const auto& a, const auto& b) {
+                return byBytes ? a.second.bytes > b.second.bytes : a.second.requests > b.second.requests;
+            });
+        std::cout << "=== " << title << " ===\n";
+        for (size_t i = 0; i < count; ++i) {
+            std::cout << std::setw(10) << ranked[i].second.requests << "  "
+                      << std::setw(14) << ranked[i].second.bytes << "  "
+                      << pathName(paths, ranked[i].first) << "\n";
+        }
+        std::cout << "\n";
+    };
+    printTop("Top Paths by Requests (requests, bytes, path)", false);
+    printTop("Top Paths by Bytes (requests, bytes, path)", true);
+
+    std::cout << "=== Latency by Status (handler + send, us) ===\n";
+    std::cout << "status    requests       p50       p90       p99       max  avg-handler  avg-send\n";
+    for (const auto& entry : totals.statuses) {
+        const StatusTotals& status = entry.second;
+        std::cout << std::setw(6) << entry.first
+                  << std::setw(12) << status.requests
+                  << std::setw(10) << status.percentile(0.50)
+                  << std::setw(10) << status.percentile(0.90)
+                  << std::setw(10) << status.percentile(0.99)
+                  << std::setw(10) << status.maxUs
+                  << std::setw(13) << status.handlerUs / status.requests
+                  << std::setw(10) << status.sendUs / status.requests << "\n";
+    }
+
+    return 0;
+}
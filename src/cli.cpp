@@ -1,5 +1,19 @@
 #include "cli.h"
 #include <iostream>
+#include <fstream>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+} // namespace
 
 CLI::CLI(int argc, char* argv[]) {
     for (int i = 0; i < argc; ++i) {
@@ -14,19 +28,24 @@ bool CLI::hasFlag(const std::string& flag) const {
             return true;
         }
     }
-    return false;
+    auto it = fileOptions_.find(flag);
+    return it != fileOptions_.end() && it->second != "false" && it->second != "no" && it->second != "0";
 }
 
 std::string CLI::getStringOption(const std::string& option, const std::string& defaultValue) const {
     auto it = options_.find(option);
-    return (it != options_.end()) ? it->second : defaultValue;
+    if (it != options_.end()) {
+        return it->second;
+    }
+    it = fileOptions_.find(option);
+    return (it != fileOptions_.end()) ? it->second : defaultValue;
 }
 
 int CLI::getIntOption(const std::string& option, int defaultValue) const {
-    auto it = options_.find(option);
-    if (it != options_.end()) {
+    std::string value = getStringOption(option);
+    if (!value.empty()) {
         try {
-            return std::stoi(it->second);
+            return std::stoi(value);
         } catch (const std::exception&) {
             return defaultValue;
         }
@@ -34,6 +53,40 @@ int CLI::getIntOption(const std::string& option, int defaultValue) const {
     return defaultValue;
 }
 
+bool CLI::loadConfigFile(const std::string& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "não foi possível abrir " + path;
+        return false;
+    }
+    
+    std::unordered_map<std::string, std::string> options;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        
+        size_t equals = line.find('=');
+        std::string key = trim(line.substr(0, equals));
+        std::string value = equals == std::string::npos ? "true" : trim(line.substr(equals + 1));
+        if (key.empty()) {
+            if (!trim(line).empty()) {
+                error = path + ":" + std::to_string(lineNumber) + ": opção sem nome";
+                return false;
+            }
+            continue;
+        }
+        options["--" + key] = value;
+    }
+    
+    fileOptions_ = std::move(options);
+    return true;
+}
+
 void CLI::parseArguments() {
     for (size_t i = 1; i < args_.size(); ++i) {
         const std::string& arg = args_[i];
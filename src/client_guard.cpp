@@ -0,0 +1,169 @@
+#include "client_guard.h"
+#include "logger.h"
+#include <algorithm>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>
+
+ClientGuard::ClientGuard(const ClientLimitsConfig& config)
+    : config_(config),
+      addressMutex_(std::make_shared<std::mutex>()),
+      addresses_(std::make_shared<std::unordered_map<std::string, size_t>>()),
+      slowReceiveCut_(0),
+      slowSendCut_(0),
+      perIpRejected_(0),
+      headerLimitRejected_(0) {
+    if (config_.minReceiveRate > 0 || config_.minSendRate > 0) {
+        watchThread_ = std::thread(&ClientGuard::watchLoop, this);
+    }
+}
+
+ClientGuard::~ClientGuard() {
+    {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        stopping_ = true;
+    }
+    watchCondition_.notify_all();
+    if (watchThread_.joinable()) {
+        watchThread_.join();
+    }
+}
+
+bool ClientGuard::admit(Connection& connection) {
+    if (config_.maxConnectionsPerIp == 0 || connection.peerAddress.empty()) {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(*addressMutex_);
+        size_t& count = (*addresses_)[connection.peerAddress];
+        if (count >= config_.maxConnectionsPerIp) {
+            perIpRejected_.fetch_add(1);
+            return false;
+        }
+        ++count;
+    }
+
+    // A vaga guarda o mapa por shared_ptr: conexões podem sobreviver ao guard no encerramento
+    auto mutex = addressMutex_;
+    auto addresses = addresses_;
+    std::string address = connection.peerAddress;
+    connection.addressSlot = std::shared_ptr<void>(nullptr, [mutex, addresses, address](void*) {
+        std::lock_guard<std::mutex> lock(*mutex);
+        auto it = addresses->find(address);
+        if (it != addresses->end() && --it->second == 0) {
+            addresses->erase(it);
+        }
+    });
+    return true;
+}
+
+void ClientGuard::track(Connection& connection) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_[&connection] = RateWindow{};
+}
+
+void ClientGuard::untrack(Connection& connection) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_.erase(&connection);
+}
+
+size_t ClientGuard::tracked() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_.size();
+}
+
+size_t ClientGuard::cutAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : active_) {
+        shutdown(entry.first->socket, SHUT_RDWR);
+    }
+    return active_.size();
+}
+
+const ClientLimitsConfig& ClientGuard::config() const {
+    return config_;
+}
+
+void ClientGuard::countHeaderRejection() {
+    headerLimitRejected_.fetch_add(1);
+}
+
+ClientGuardStats ClientGuard::stats() const {
+    ClientGuardStats stats;
+    stats.slowReceiveCut = slowReceiveCut_.load();
+    stats.slowSendCut = slowSendCut_.load();
+    stats.perIpRejected = perIpRejected_.load();
+    stats.headerLimitRejected = headerLimitRejected_.load();
+    std::lock_guard<std::mutex> lock(*addressMutex_);
+    stats.trackedAddresses = addresses_->size();
+    return stats;
+}
+
+void ClientGuard::watchLoop() {
+    std::unique_lock<std::mutex> lock(watchMutex_);
+    while (!watchCondition_.wait_for(lock, std::chrono::seconds(1), [this] { return stopping_; })) {
+        lock.unlock();
+        sweep();
+        lock.lock();
+    }
+}
+
+void ClientGuard::sweep() {
+    auto now = std::chrono::steady_clock::now();
+    auto window = std::chrono::seconds(std::max(config_.rateWindowSeconds, 1));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : active_) {
+        Connection& connection = *entry.first;
+        RateWindow& rate = entry.second;
+
+        tcp_info info{};
+        socklen_t length = sizeof(info);
+        if (getsockopt(connection.socket, IPPROTO_TCP, TCP_INFO, &info, &length) < 0) {
+            continue;
+        }
+
+        // Resposta na fila do kernel: mede o que o cliente confirma. Senão, só conta enquanto a
+        // thread está bloqueada esperando bytes do cliente (não enquanto o handler processa)
+        Direction direction = Direction::None;
+        uint64_t bytes = 0;
+        uint32_t floor = 0;
+        if (info.tcpi_notsent_bytes > 0 || info.tcpi_unacked > 0) {
+            direction = Direction::Send;
+            bytes = info.tcpi_bytes_acked;
+            floor = config_.minSendRate;
+        } else if (connection.receiving.load(std::memory_order_relaxed)) {
+            direction = Direction::Receive;
+            bytes = info.tcpi_bytes_received;
+            floor = config_.minReceiveRate;
+        }
+
+        if (direction == Direction::None || floor == 0) {
+            rate.direction = Direction::None;
+            continue;
+        }
+        if (rate.direction != direction) {
+            rate = RateWindow{direction, bytes, now};
+            continue;
+        }
+
+        auto elapsed = now - rate.since;
+        if (elapsed < window) {
+            continue;
+        }
+
+        uint64_t seconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(elapsed).count());
+        if (bytes - rate.baseBytes < floor * seconds) {
+            shutdown(connection.socket, SHUT_RDWR);
+            (direction == Direction::Send ? slowSendCut_ : slowReceiveCut_).fetch_add(1);
+            LOG_LIMITED(Logger::Level::WARNING, 1, 10, "Closing slow client {}: {} bytes {} in {}s",
+                        connection.peerAddress, bytes - rate.baseBytes,
+                        direction == Direction::Send ? "acknowledged" : "received", seconds);
+            rate.direction = Direction::None;
+            continue;
+        }
+        rate = RateWindow{direction, bytes, now};
+    }
+}
@@ -0,0 +1,30 @@
+#include "connection.h"
+#include "http2.h"
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+Connection::Connection(SOCKET socket)
+    : socket(socket) {
+}
+
+Connection::~Connection() {
+    // A sessão ainda escreve no socket ao ser destruída (GOAWAY): antes do close
+    http2.reset();
+    if (socket >= 0) {
+        close(socket);
+    }
+}
+
+long Connection::receive(void* buffer, size_t length) {
+    receiving.store(true, std::memory_order_relaxed);
+    long received = recv(socket, buffer, length, 0);
+    receiving.store(false, std::memory_order_relaxed);
+    return received;
+}
+
+SOCKET Connection::release() {
+    SOCKET released = socket;
+    socket = -1;
+    return released;
+}
@@ -1,14 +1,22 @@
 #include "connection_queue.h"
+#include "request_lanes.h"
+#include <algorithm>
+#include <climits>
 
-ConnectionQueue::ConnectionQueue(size_t maxSize)
-    : maxSize_(maxSize), shutdown_(false) {
+ConnectionQueue::ConnectionQueue(size_t maxSize, std::shared_ptr<RequestLanes> lanes)
+    : laneConfig_(std::move(lanes)),
+      lanes_(laneConfig_ ? laneConfig_->count() : 1),
+      size_(0),
+      current_(0),
+      maxSize_(maxSize),
+      shutdown_(false) {
 }
 
-bool ConnectionQueue::push(SOCKET socket, std::chrono::milliseconds timeout) {
+bool ConnectionQueue::push(std::unique_ptr<Connection>& connection, std::chrono::milliseconds timeout) {
     std::unique_lock<std::mutex> lock(mutex_);
     
     if (!condition_.wait_for(lock, timeout, [this] {
-        return shutdown_ || queue_.size() < maxSize_;
+        return shutdown_ || size_ < maxSize_;
     })) {
         return false;
     }
@@ -17,39 +25,131 @@ bool ConnectionQueue::push(SOCKET socket, std::chrono::milliseconds timeout) {
         return false;
     }
     
-    queue_.push(socket);
+    size_t lane = laneConfig_ ? std::min<size_t>(connection->lane, lanes_.size() - 1) : 0;
+    lanes_[lane].entries.push_back({std::move(connection), std::chrono::steady_clock::now()});
+    ++size_;
     condition_.notify_one();
     return true;
 }
 
-bool ConnectionQueue::pop(SOCKET& socket, std::chrono::milliseconds timeout) {
+bool ConnectionQueue::pop(std::unique_ptr<Connection>& connection, std::chrono::milliseconds timeout) {
     std::unique_lock<std::mutex> lock(mutex_);
     
     if (timeout == std::chrono::milliseconds::max()) {
         condition_.wait(lock, [this] {
-            return shutdown_ || !queue_.empty();
+            return shutdown_ || ready();
         });
     } else {
         if (!condition_.wait_for(lock, timeout, [this] {
-            return shutdown_ || !queue_.empty();
+            return shutdown_ || ready();
         })) {
             return false;
         }
     }
     
-    if (shutdown_ && queue_.empty()) {
+    if (shutdown_ && size_ == 0) {
         return false;
     }
     
-    socket = queue_.front();
-    queue_.pop();
+    if (!takeNext(connection)) {
+        return false;
+    }
     condition_.notify_one();
     return true;
 }
 
+// Há conexão que pode sair agora (com faixas, de uma faixa abaixo do limite de atendimento)
+bool ConnectionQueue::ready() const {
+    if (size_ == 0) {
+        return false;
+    }
+    if (!laneConfig_) {
+        return true;
+    }
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+        if (!lanes_[i].entries.empty() && laneConfig_->admits(static_cast<uint8_t>(i))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ConnectionQueue::takeNext(std::unique_ptr<Connection>& connection) {
+    if (!laneConfig_) {
+        if (size_ == 0) {
+            return false;
+        }
+        connection = std::move(lanes_[0].entries.front().connection);
+        lanes_[0].entries.pop_front();
+        --size_;
+        return true;
+    }
+    
+    // DRR: a faixa atual segue sendo servida enquanto o crédito cobrir o custo de uma conexão
+    // (o tempo médio de atendimento dela); quando nenhuma cobre, todas as faixas com fila
+    // recebem de uma vez as voltas de crédito que faltam à primeira que passaria a cobrir
+    size_t count = lanes_.size();
+    auto now = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < 2; ++pass) {
+        int64_t rounds = INT64_MAX;
+        for (size_t k = 0; k < count; ++k) {
+            size_t index = (current_ + k) % count;
+            auto lane = static_cast<uint8_t>(index);
+            Lane& candidate = lanes_[index];
+            if (candidate.entries.empty()) {
+                candidate.deficit = 0;
+                continue;
+            }
+            if (!laneConfig_->admits(lane)) {
+                continue;
+            }
+            
+            int64_t cost = laneConfig_->costMicros(lane);
+            if (candidate.deficit >= cost) {
+                if (!laneConfig_->tryStart(lane, now - candidate.entries.front().queuedAt)) {
+                    continue;   // Outra fila ocupou a última vaga da faixa
+                }
+                candidate.deficit -= cost;
+                current_ = index;
+                connection = std::move(candidate.entries.front().connection);
+                candidate.entries.pop_front();
+                --size_;
+                return true;
+            }
+            int64_t quantum = RequestLanes::kQuantumMicros * laneConfig_->weight(lane);
+            rounds = std::min(rounds, (cost - candidate.deficit + quantum - 1) / quantum);
+        }
+        if (rounds == INT64_MAX) {
+            return false;
+        }
+        for (size_t index = 0; index < count; ++index) {
+            auto lane = static_cast<uint8_t>(index);
+            if (!lanes_[index].entries.empty() && laneConfig_->admits(lane)) {
+                lanes_[index].deficit += rounds * RequestLanes::kQuantumMicros * laneConfig_->weight(lane);
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<std::unique_ptr<Connection>> ConnectionQueue::takeAll() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<std::unique_ptr<Connection>> connections;
+    for (auto& lane : lanes_) {
+        for (auto& entry : lane.entries) {
+            connections.push_back(std::move(entry.connection));
+        }
+        lane.entries.clear();
+        lane.deficit = 0;
+    }
+    size_ = 0;
+    condition_.notify_all();
+    return connections;
+}
+
 size_t ConnectionQueue::size() const {
     std::unique_lock<std::mutex> lock(mutex_);
-    return queue_.size();
+    return size_;
 }
 
 size_t ConnectionQueue::maxSize() const {
@@ -58,11 +158,25 @@ size_t ConnectionQueue::maxSize() const {
 
 bool ConnectionQueue::empty() const {
     std::unique_lock<std::mutex> lock(mutex_);
-    return queue_.empty();
+    return size_ == 0;
+}
+
+size_t ConnectionQueue::clear() {
+    return takeAll().size();
 }
 
 void ConnectionQueue::shutdown() {
     std::unique_lock<std::mutex> lock(mutex_);
     shutdown_ = true;
     condition_.notify_all();
-}
\ No newline at end of file
+}
+
+void ConnectionQueue::reopen() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    shutdown_ = false;
+}
+
+void ConnectionQueue::notify() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.notify_all();
+}
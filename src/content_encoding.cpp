@@ -0,0 +1,268 @@
+#include "content_encoding.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#ifdef HAVE_ZLIB
+    #include <zlib.h>
+#endif
+#ifdef HAVE_BROTLI
+    #include <brotli/encode.h>
+#endif
+
+const char* contentEncodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Gzip: return "gzip";
+        case ContentEncoding::Brotli: return "br";
+        default: return "identity";
+    }
+}
+
+const char* contentEncodingExtension(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Gzip: return ".gz";
+        case ContentEncoding::Brotli: return ".br";
+        default: return "";
+    }
+}
+
+bool isEncodingSupported(ContentEncoding encoding) {
+    switch (encoding) {
+#ifdef HAVE_ZLIB
+        case ContentEncoding::Gzip: return true;
+#endif
+#ifdef HAVE_BROTLI
+        case ContentEncoding::Brotli: return true;
+#endif
+        case ContentEncoding::Identity: return true;
+        default: return false;
+    }
+}
+
+bool isCompressibleMimeType(const std::string& mimeType) {
+    if (mimeType.compare(0, 5, "text/") == 0) {
+        return true;
+    }
+
+    static const char* const compressible[] = {
+        "application/javascript",
+        "application/json",
+        "application/xml",
+        "application/wasm",
+        "image/svg+xml",
+    };
+
+    for (const char* type : compressible) {
+        if (mimeType.compare(0, std::char_traits<char>::length(type), type) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ContentEncoding negotiateEncoding(const std::string& acceptEncoding, bool allowBrotli, bool allowGzip) {
+    double brotliQ = -1.0;
+    double gzipQ = -1.0;
+    double wildcardQ = -1.0;
+
+    size_t start = 0;
+    while (start < acceptEncoding.size()) {
+        size_t end = acceptEncoding.find(',', start);
+        if (end == std::string::npos) {
+            end = acceptEncoding.size();
+        }
+
+        std::string token = acceptEncoding.substr(start, end - start);
+        start = end + 1;
+
+        double q = 1.0;
+        size_t semicolon = token.find(';');
+        if (semicolon != std::string::npos) {
+            size_t qPos = token.find("q=", semicolon);
+            if (qPos != std::string::npos) {
+                q = std::strtod(token.c_str() + qPos + 2, nullptr);
+            }
+            token.resize(semicolon);
+        }
+
+        token.erase(std::remove_if(token.begin(), token.end(), ::isspace), token.end());
+        std::transform(token.begin(), token.end(), token.begin(), ::tolower);
+
+        if (token == "br") brotliQ = q;
+        else if (token == "gzip" || token == "x-gzip") gzipQ = q;
+        else if (token == "*") wildcardQ = q;
+    }
+
+    if (brotliQ < 0) brotliQ = wildcardQ;
+    if (gzipQ < 0) gzipQ = wildcardQ;
+    if (!allowBrotli) brotliQ = 0;
+    if (!allowGzip) gzipQ = 0;
+
+    if (brotliQ > 0 && brotliQ >= gzipQ) {
+        return ContentEncoding::Brotli;
+    }
+    if (gzipQ > 0) {
+        return ContentEncoding::Gzip;
+    }
+    return ContentEncoding::Identity;
+}
+
+bool compressContent(const char* input, size_t inputSize, ContentEncoding encoding,
+                     const CompressionConfig& config, std::string& output) {
+    switch (encoding) {
+#ifdef HAVE_ZLIB
+        case ContentEncoding::Gzip: {
+            z_stream stream{};
+            // windowBits 15 + 16 gera o envelope gzip em vez de zlib
+            if (deflateInit2(&stream, config.gzipLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                return false;
+            }
+
+            output.resize(deflateBound(&stream, inputSize));
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+            stream.avail_in = static_cast<uInt>(inputSize);
+            stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+            stream.avail_out = static_cast<uInt>(output.size());
+
+            int result = deflate(&stream, Z_FINISH);
+            output.resize(stream.total_out);
+            deflateEnd(&stream);
+            return result == Z_STREAM_END;
+        }
+#endif
+#ifdef HAVE_BROTLI
+        case ContentEncoding::Brotli: {
+            size_t encodedSize = BrotliEncoderMaxCompressedSize(inputSize);
+            output.resize(encodedSize);
+            if (!BrotliEncoderCompress(config.brotliQuality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                                       inputSize, reinterpret_cast<const uint8_t*>(input),
+                                       &encodedSize, reinterpret_cast<uint8_t*>(&output[0]))) {
+                return false;
+            }
+            output.resize(encodedSize);
+            return true;
+        }
+#endif
+        default:
+            (void)input;
+            (void)inputSize;
+            (void)config;
+            return false;
+    }
+}
+
+struct CompressionCache::Flight {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool done = false;
+    std::shared_ptr<const std::string> content;
+};
+
+CompressionCache::CompressionCache(size_t maxBytes)
+    : maxBytes_(maxBytes) {
+}
+
+std::shared_ptr<const std::string> CompressionCache::get(const std::string& path, const std::string& etag,
+                                                         ContentEncoding encoding) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(makeKey(path, etag, encoding));
+    if (it == index_.end()) {
+        return nullptr;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->content;
+}
+
+void CompressionCache::put(const std::string& path, const std::string& etag, ContentEncoding encoding,
+                           std::shared_ptr<const std::string> content) {
+    if (!content || content->size() > maxBytes_) {
+        return;
+    }
+
+    std::string key = makeKey(path, etag, encoding);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        currentBytes_ -= it->second->content->size();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    currentBytes_ += content->size();
+    lru_.push_front(Entry{key, std::move(content)});
+    index_[std::move(key)] = lru_.begin();
+    evict();
+}
+
+std::shared_ptr<CompressionCache::Flight> CompressionCache::join(const std::string& path, const std::string& etag,
+                                                                ContentEncoding encoding, bool& leader) {
+    std::string key = makeKey(path, etag, encoding);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = flights_.find(key);
+    if (it != flights_.end()) {
+        leader = false;
+        return it->second;
+    }
+
+    auto flight = std::make_shared<Flight>();
+    flights_.emplace(std::move(key), flight);
+    leader = true;
+    return flight;
+}
+
+void CompressionCache::complete(const std::string& path, const std::string& etag, ContentEncoding encoding,
+                                const std::shared_ptr<Flight>& flight, std::shared_ptr<const std::string> content) {
+    put(path, etag, encoding, content);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flights_.erase(makeKey(path, etag, encoding));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(flight->mutex);
+        flight->done = true;
+        flight->content = std::move(content);
+    }
+    flight->condition.notify_all();
+}
+
+std::shared_ptr<const std::string> CompressionCache::wait(const std::shared_ptr<Flight>& flight) {
+    // Sem prazo: a compressão é limitada por maxFileSize e o líder sempre chama complete()
+    std::unique_lock<std::mutex> lock(flight->mutex);
+    flight->condition.wait(lock, [&flight] { return flight->done; });
+    return flight->content;
+}
+
+void CompressionCache::setCapacity(size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxBytes_.store(maxBytes);
+    evict();
+}
+
+size_t CompressionCache::sizeBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return currentBytes_;
+}
+
+size_t CompressionCache::entries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+}
+
+std::string CompressionCache::makeKey(const std::string& path, const std::string& etag, ContentEncoding encoding) {
+    return path + '\0' + etag + '\0' + contentEncodingName(encoding);
+}
+
+void CompressionCache::evict() {
+    while (currentBytes_ > maxBytes_ && !lru_.empty()) {
+        Entry& victim = lru_.back();
+        currentBytes_ -= victim.content->size();
+        index_.erase(victim.key);
+        lru_.pop_back();
+    }
+}
@@ -0,0 +1,281 @@
+#include "document_index.h"
+#include "mime_types.h"
+#include "content_encoding.h"
+#include "http_utils.h"
+#include "logger.h"
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstring>
+#include <chrono>
+
+#include <sys/stat.h>
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'C', 'S', 'I', 'D', 'X', '0', '0', '1'};
+
+struct ScannedFile {
+    std::string urlPath;
+    std::string filePath;
+    struct stat fileStat;
+};
+
+int64_t mtimeNanoseconds(const struct stat& fileStat) {
+    return static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000LL + fileStat.st_mtim.tv_nsec;
+}
+
+template<typename T>
+void writeValue(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+bool readValue(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+void writeString(std::ofstream& out, const std::string& value) {
+    writeValue<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+bool readString(std::ifstream& in, std::string& value) {
+    uint32_t length;
+    if (!readValue(in, length) || length > 64 * 1024) {
+        return false;
+    }
+    value.resize(length);
+    return static_cast<bool>(in.read(&value[0], length));
+}
+
+}
+
+bool DocumentEntry::matches(uint64_t inode, uint64_t size, int64_t mtimeNs) const {
+    return !etag.empty() && this->inode == inode && this->size == size && this->mtimeNs == mtimeNs;
+}
+
+DocumentIndex::DocumentIndex(const std::string& documentRoot)
+    : documentRoot_(documentRoot), tree_(std::make_shared<const Tree>()) {
+}
+
+void DocumentIndex::rebuild(size_t threads) {
+    namespace fs = std::filesystem;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Pilha compartilhada de diretórios: cada thread lista um diretório por vez
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::string> pendingDirs{""};
+    size_t activeDirs = 0;
+    std::vector<ScannedFile> scanned;
+
+    auto worker = [&] {
+        std::vector<ScannedFile> local;
+
+        for (;;) {
+            std::string relativeDir;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&] { return !pendingDirs.empty() || activeDirs == 0; });
+                if (pendingDirs.empty()) {
+                    break;
+                }
+                relativeDir = std::move(pendingDirs.back());
+                pendingDirs.pop_back();
+                activeDirs++;
+            }
+
+            std::vector<std::string> subdirs;
+            std::error_code ec;
+            for (fs::directory_iterator it(documentRoot_ + relativeDir, fs::directory_options::skip_permission_denied, ec), end;
+                 !ec && it != end; it.increment(ec)) {
+                std::string urlPath = relativeDir + "/" + it->path().filename().string();
+                std::string filePath = documentRoot_ + urlPath;
+
+                // lstat: um link para diretório não é descido (laços e ciclos multiplicariam a
+                // varredura); o que houver atrás dele resolve sob demanda. Links para arquivo valem
+                struct stat fileStat;
+                if (lstat(filePath.c_str(), &fileStat) != 0) {
+                    continue;
+                }
+                if (S_ISLNK(fileStat.st_mode) &&
+                    (stat(filePath.c_str(), &fileStat) != 0 || S_ISDIR(fileStat.st_mode))) {
+                    continue;
+                }
+
+                if (S_ISDIR(fileStat.st_mode)) {
+                    subdirs.push_back(urlPath);
+                    struct stat indexStat;
+                    std::string indexPath = filePath + "/index.html";
+                    if (stat(indexPath.c_str(), &indexStat) == 0 && S_ISREG(indexStat.st_mode)) {
+                        local.push_back({urlPath + "/", indexPath, indexStat});
+                    }
+                } else if (S_ISREG(fileStat.st_mode)) {
+                    local.push_back({urlPath, filePath, fileStat});
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto& dir : subdirs) {
+                    pendingDirs.push_back(std::move(dir));
+                }
+                activeDirs--;
+            }
+            condition.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& file : local) {
+            scanned.push_back(std::move(file));
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    auto tree = std::make_shared<Tree>();
+    tree->reserve(scanned.size() + 1);
+    for (auto& file : scanned) {
+        tree->emplace(std::move(file.urlPath),
+                      makeEntry(std::move(file.filePath), file.fileStat.st_size,
+                                mtimeNanoseconds(file.fileStat), file.fileStat.st_ino));
+    }
+
+    struct stat rootIndexStat;
+    std::string rootIndex = documentRoot_ + "/index.html";
+    if (stat(rootIndex.c_str(), &rootIndexStat) == 0 && S_ISREG(rootIndexStat.st_mode)) {
+        tree->emplace("/", makeEntry(rootIndex, rootIndexStat.st_size,
+                                     mtimeNanoseconds(rootIndexStat), rootIndexStat.st_ino));
+    }
+
+    size_t count = tree->size();
+    std::atomic_store(&tree_, std::shared_ptr<const Tree>(std::move(tree)));
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    Logger::getInstance().info("Document index built with " + std::to_string(count) + " entries in " +
+                              std::to_string(duration.count()) + "ms (" + std::to_string(threads) + " threads)");
+}
+
+bool DocumentIndex::saveSnapshot(const std::string& snapshotPath) const {
+    auto tree = std::atomic_load(&tree_);
+    std::string tempPath = snapshotPath + ".tmp";
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+        writeString(out, documentRoot_);
+        writeValue<uint32_t>(out, static_cast<uint32_t>(tree->size()));
+
+        for (const auto& item : *tree) {
+            // Caminhos gravados relativos à raiz para manter o snapshot compacto
+            writeString(out, item.first);
+            writeString(out, item.second.filePath.substr(documentRoot_.size()));
+            writeValue<uint64_t>(out, item.second.size);
+            writeValue<int64_t>(out, item.second.mtimeNs);
+            writeValue<uint64_t>(out, item.second.inode);
+        }
+
+        if (!out.good()) {
+            return false;
+        }
+    }
+
+    // Troca atômica: um processo lendo o snapshot nunca vê um arquivo pela metade
+    return std::rename(tempPath.c_str(), snapshotPath.c_str()) == 0;
+}
+
+bool DocumentIndex::loadSnapshot(const std::string& snapshotPath) {
+    std::ifstream in(snapshotPath, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(kSnapshotMagic)];
+    std::string root;
+    uint32_t count;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, kSnapshotMagic, sizeof(magic)) != 0 ||
+        !readString(in, root) || root != documentRoot_ || !readValue(in, count)) {
+        Logger::getInstance().warning("Ignoring index snapshot " + snapshotPath + ": incompatible header");
+        return false;
+    }
+
+    auto tree = std::make_shared<Tree>();
+    tree->reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string urlPath, relativeFile;
+        uint64_t size, inode;
+        int64_t mtimeNs;
+        if (!readString(in, urlPath) || !readString(in, relativeFile) ||
+            !readValue(in, size) || !readValue(in, mtimeNs) || !readValue(in, inode)) {
+            Logger::getInstance().warning("Ignoring index snapshot " + snapshotPath + ": truncated");
+            return false;
+        }
+        tree->emplace(std::move(urlPath), makeEntry(documentRoot_ + relativeFile, size, mtimeNs, inode));
+    }
+
+    std::atomic_store(&tree_, std::shared_ptr<const Tree>(std::move(tree)));
+    Logger::getInstance().info("Document index restored from snapshot with " + std::to_string(count) + " entries");
+    return true;
+}
+
+std::shared_ptr<const DocumentEntry> DocumentIndex::resolve(const std::string& path) const {
+    auto tree = std::atomic_load(&tree_);
+
+    auto it = tree->find(path);
+    if (it != tree->end()) {
+        // Aliasing: a entrada mantém o índice vivo sem alocar
+        return std::shared_ptr<const DocumentEntry>(tree, &it->second);
+    }
+
+    std::string filePath = documentRoot_ + path;
+    if (!path.empty() && path.back() == '/') {
+        filePath += "index.html";
+    }
+    return std::make_shared<const DocumentEntry>(makeEntry(std::move(filePath)));
+}
+
+std::vector<std::shared_ptr<const DocumentEntry>> DocumentIndex::entries() const {
+    auto tree = std::atomic_load(&tree_);
+
+    std::vector<std::shared_ptr<const DocumentEntry>> result;
+    result.reserve(tree->size());
+    for (const auto& item : *tree) {
+        result.emplace_back(tree, &item.second);
+    }
+    return result;
+}
+
+size_t DocumentIndex::size() const {
+    return std::atomic_load(&tree_)->size();
+}
+
+DocumentEntry DocumentIndex::makeEntry(std::string filePath) const {
+    const char* mimeType = mimeTypeForPath(filePath);
+    return DocumentEntry{std::move(filePath), mimeType, isCompressibleMimeType(mimeType)};
+}
+
+DocumentEntry DocumentIndex::makeEntry(std::string filePath, uint64_t size, int64_t mtimeNs, uint64_t inode) const {
+    DocumentEntry entry = makeEntry(std::move(filePath));
+    entry.size = size;
+    entry.mtimeNs = mtimeNs;
+    entry.inode = inode;
+    entry.etag = makeETag(inode, size, mtimeNs);
+    return entry;
+}
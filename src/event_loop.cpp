@@ -0,0 +1,186 @@
+#include "event_loop.h"
+#include "logger.h"
+#include <stdexcept>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+EventLoop::EventLoop(std::chrono::milliseconds idleTimeout, ReadyCallback onReady)
+    : idleTimeout_(idleTimeout),
+      onReady_(std::move(onReady)),
+      epollFd_(-1),
+      wakeFd_(-1),
+      running_(false),
+      closingIdle_(false),
+      parkedCount_(0) {
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        throw std::runtime_error("Failed to create epoll instance");
+    }
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        close(epollFd_);
+        throw std::runtime_error("Failed to create eventfd");
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+}
+
+EventLoop::~EventLoop() {
+    stop();
+    close(wakeFd_);
+    close(epollFd_);
+}
+
+void EventLoop::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+void EventLoop::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    wakeup();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // Fecha as conexões que ainda estavam ociosas
+    for (auto& entry : parked_) {
+        timers_.cancel(entry.second->idleTimer);
+    }
+    parked_.clear();
+    parkedCount_.store(0);
+
+    std::lock_guard<std::mutex> lock(incomingMutex_);
+    incoming_.clear();
+}
+
+void EventLoop::park(std::unique_ptr<Connection> connection) {
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex_);
+        incoming_.push_back(std::move(connection));
+    }
+    wakeup();
+}
+
+size_t EventLoop::closeIdle() {
+    size_t parked = parkedCount_.load();
+    closingIdle_.store(true);
+    wakeup();
+    return parked;
+}
+
+void EventLoop::setIdleTimeout(std::chrono::milliseconds idleTimeout) {
+    idleTimeout_.store(idleTimeout);
+}
+
+TimerWheel& EventLoop::timers() {
+    return timers_;
+}
+
+size_t EventLoop::parkedConnections() const {
+    return parkedCount_.load();
+}
+
+void EventLoop::run() {
+    std::vector<epoll_event> events(256);
+    int timeoutMs = static_cast<int>(timers_.tick().count());
+
+    while (running_.load()) {
+        int ready = epoll_wait(epollFd_, events.data(), static_cast<int>(events.size()), timeoutMs);
+
+        for (int i = 0; i < ready; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                uint64_t value;
+                while (read(wakeFd_, &value, sizeof(value)) > 0) {
+                }
+                continue;
+            }
+
+            auto connection = unwatch(static_cast<Connection*>(events[i].data.ptr));
+            if (connection && (events[i].events & EPOLLIN)) {
+                onReady_(std::move(connection));
+            }
+        }
+
+        // Novas conexões são registradas só depois dos eventos do lote atual,
+        // e os timers só avançam depois disso: um timer nunca libera uma conexão
+        // que ainda tenha evento pendente no lote
+        drainIncoming();
+        if (closingIdle_.load() && !parked_.empty()) {
+            for (auto& entry : parked_) {
+                epoll_ctl(epollFd_, EPOLL_CTL_DEL, entry.first->socket, nullptr);
+                timers_.cancel(entry.second->idleTimer);
+            }
+            parked_.clear();
+            parkedCount_.store(0);
+        }
+        timers_.advance();
+    }
+}
+
+void EventLoop::drainIncoming() {
+    std::vector<std::unique_ptr<Connection>> incoming;
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex_);
+        incoming.swap(incoming_);
+    }
+
+    for (auto& connection : incoming) {
+        watch(std::move(connection));
+    }
+}
+
+void EventLoop::watch(std::unique_ptr<Connection> connection) {
+    Connection* raw = connection.get();
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.ptr = raw;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, raw->socket, &event) < 0) {
+        LOG_LIMITED(Logger::Level::WARNING, 1, 10, "Failed to watch idle connection, closing it");
+        return;
+    }
+
+    auto idleTimeout = raw->idleTimeout.count() > 0 ? raw->idleTimeout : idleTimeout_.load();
+    raw->idleTimer = timers_.schedule(idleTimeout, [this, raw] {
+        raw->idleTimer = TimerWheel::kInvalidTimer;
+        unwatch(raw);
+    });
+
+    parked_.emplace(raw, std::move(connection));
+    parkedCount_.fetch_add(1);
+}
+
+std::unique_ptr<Connection> EventLoop::unwatch(Connection* connection) {
+    auto it = parked_.find(connection);
+    if (it == parked_.end()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<Connection> owned = std::move(it->second);
+    parked_.erase(it);
+    parkedCount_.fetch_sub(1);
+
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, owned->socket, nullptr);
+    timers_.cancel(owned->idleTimer);
+    owned->idleTimer = TimerWheel::kInvalidTimer;
+    return owned;
+}
+
+void EventLoop::wakeup() {
+    uint64_t value = 1;
+    ssize_t written = write(wakeFd_, &value, sizeof(value));
+    (void)written;
+}
@@ -0,0 +1,396 @@
+#include "hpack.h"
+#include <cstring>
+
+namespace {
+
+struct StaticEntry {
+    const char* name;
+    const char* value;
+};
+
+// RFC 7541, apêndice A (índices 1 a 61)
+constexpr StaticEntry kStaticTable[] = {
+    {":authority", ""}, {":method", "GET"}, {":method", "POST"}, {":path", "/"},
+    {":path", "/index.html"}, {":scheme", "http"}, {":scheme", "https"}, {":status", "200"},
+    {":status", "204"}, {":status", "206"}, {":status", "304"}, {":status", "400"},
+    {":status", "404"}, {":status", "500"}, {"accept-charset", ""}, {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""}, {"accept-ranges", ""}, {"accept", ""}, {"access-control-allow-origin", ""},
+    {"age", ""}, {"allow", ""}, {"authorization", ""}, {"cache-control", ""},
+    {"content-disposition", ""}, {"content-encoding", ""}, {"content-language", ""}, {"content-length", ""},
+    {"content-location", ""}, {"content-range", ""}, {"content-type", ""}, {"cookie", ""},
+    {"date", ""}, {"etag", ""}, {"expect", ""}, {"expires", ""},
+    {"from", ""}, {"host", ""}, {"if-match", ""}, {"if-modified-since", ""},
+    {"if-none-match", ""}, {"if-range", ""}, {"if-unmodified-since", ""}, {"last-modified", ""},
+    {"link", ""}, {"location", ""}, {"max-forwards", ""}, {"proxy-authenticate", ""},
+    {"proxy-authorization", ""}, {"range", ""}, {"referer", ""}, {"refresh", ""},
+    {"retry-after", ""}, {"server", ""}, {"set-cookie", ""}, {"strict-transport-security", ""},
+    {"transfer-encoding", ""}, {"user-agent", ""}, {"vary", ""}, {"via", ""},
+    {"www-authenticate", ""},
+};
+
+constexpr size_t kStaticCount = sizeof(kStaticTable) / sizeof(kStaticTable[0]);
+constexpr size_t kEntryOverhead = 32;
+constexpr size_t kMaxStringBytes = 64 * 1024;
+
+// Código Huffman da RFC 7541, apêndice B (sem o EOS, que nunca aparece em strings válidas)
+constexpr uint32_t kHuffmanCodes[256] = {
+    0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+    0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+    0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+    0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+    0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+    0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+    0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+    0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+    0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+    0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+    0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+    0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+    0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+    0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+    0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+    0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+    0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+    0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+    0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+    0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+    0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+    0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+    0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+    0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+    0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+    0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+    0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+    0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+    0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+    0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+    0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+    0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+};
+
+constexpr uint8_t kHuffmanLengths[256] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+};
+
+constexpr int kMaxCodeLength = 30;
+
+// O código é canônico: por comprimento basta o primeiro código e a posição do primeiro
+// símbolo na lista ordenada por (comprimento, código). Decodificação bit a bit sem árvore.
+struct HuffmanDecodeTable {
+    uint32_t firstCode[kMaxCodeLength + 1] = {};
+    uint16_t count[kMaxCodeLength + 1] = {};
+    uint16_t offset[kMaxCodeLength + 1] = {};
+    uint8_t symbols[256] = {};
+};
+
+constexpr HuffmanDecodeTable buildDecodeTable() {
+    HuffmanDecodeTable table{};
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        table.count[kHuffmanLengths[symbol]]++;
+    }
+
+    uint32_t code = 0;
+    uint16_t offset = 0;
+    for (int length = 1; length <= kMaxCodeLength; ++length) {
+        table.firstCode[length] = code;
+        table.offset[length] = offset;
+        code = (code + table.count[length]) << 1;
+        offset = static_cast<uint16_t>(offset + table.count[length]);
+    }
+
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        int length = kHuffmanLengths[symbol];
+        table.symbols[table.offset[length] + (kHuffmanCodes[symbol] - table.firstCode[length])] =
+            static_cast<uint8_t>(symbol);
+    }
+    return table;
+}
+
+constexpr HuffmanDecodeTable kHuffmanDecode = buildDecodeTable();
+
+bool huffmanDecode(const uint8_t* data, size_t length, std::string& out) {
+    uint32_t code = 0;
+    int bits = 0;
+    for (size_t i = 0; i < length; ++i) {
+        for (int shift = 7; shift >= 0; --shift) {
+            code = (code << 1) | ((data[i] >> shift) & 1u);
+            bits++;
+            uint32_t index = code - kHuffmanDecode.firstCode[bits];
+            if (index < kHuffmanDecode.count[bits]) {
+                out.push_back(static_cast<char>(kHuffmanDecode.symbols[kHuffmanDecode.offset[bits] + index]));
+                code = 0;
+                bits = 0;
+            } else if (bits >= kMaxCodeLength) {
+                return false;   // EOS ou sequência inválida
+            }
+        }
+    }
+    // Preenchimento: no máximo 7 bits, todos 1 (prefixo do EOS)
+    return bits <= 7 && code == (1u << bits) - 1;
+}
+
+size_t huffmanLength(const std::string& value) {
+    size_t bits = 0;
+    for (unsigned char c : value) {
+        bits += kHuffmanLengths[c];
+    }
+    return (bits + 7) / 8;
+}
+
+void huffmanEncode(const std::string& value, std::string& out) {
+    uint64_t pending = 0;
+    int bits = 0;
+    for (unsigned char c : value) {
+        pending = (pending << kHuffmanLengths[c]) | kHuffmanCodes[c];
+        bits += kHuffmanLengths[c];
+        while (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<char>(pending >> bits));
+        }
+    }
+    if (bits > 0) {
+        out.push_back(static_cast<char>((pending << (8 - bits)) | (0xffu >> bits)));
+    }
+}
+
+void encodeInteger(uint64_t value, int prefixBits, uint8_t flags, std::string& out) {
+    uint64_t limit = (1u << prefixBits) - 1;
+    if (value < limit) {
+        out.push_back(static_cast<char>(flags | value));
+        return;
+    }
+    out.push_back(static_cast<char>(flags | limit));
+    value -= limit;
+    while (value >= 128) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool decodeInteger(const uint8_t*& pos, const uint8_t* end, int prefixBits, uint64_t& value) {
+    if (pos >= end) {
+        return false;
+    }
+    uint64_t limit = (1u << prefixBits) - 1;
+    value = *pos++ & limit;
+    if (value < limit) {
+        return true;
+    }
+    for (int shift = 0; shift <= 28; shift += 7) {
+        if (pos >= end) {
+            return false;
+        }
+        uint8_t byte = *pos++;
+        value += static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;   // Inteiro longo demais para qualquer uso legítimo
+}
+
+bool decodeString(const uint8_t*& pos, const uint8_t* end, std::string& out) {
+    if (pos >= end) {
+        return false;
+    }
+    bool huffman = (*pos & 0x80) != 0;
+    uint64_t length;
+    if (!decodeInteger(pos, end, 7, length) || length > static_cast<uint64_t>(end - pos) ||
+        length > kMaxStringBytes) {
+        return false;
+    }
+
+    out.clear();
+    bool ok = true;
+    if (huffman) {
+        ok = huffmanDecode(pos, static_cast<size_t>(length), out);
+    } else {
+        out.assign(reinterpret_cast<const char*>(pos), static_cast<size_t>(length));
+    }
+    pos += length;
+    return ok;
+}
+
+void encodeString(const std::string& value, std::string& out) {
+    size_t huffman = huffmanLength(value);
+    if (huffman < value.size()) {
+        encodeInteger(huffman, 7, 0x80, out);
+        huffmanEncode(value, out);
+    } else {
+        encodeInteger(value.size(), 7, 0x00, out);
+        out += value;
+    }
+}
+
+}
+
+HpackDecoder::HpackDecoder(size_t maxTableSize)
+    : tableLimit_(maxTableSize), maxTableSize_(maxTableSize) {
+}
+
+bool HpackDecoder::decode(const uint8_t* data, size_t length, size_t maxListBytes, HeaderList& headers,
+                          bool& tooLarge) {
+    const uint8_t* pos = data;
+    const uint8_t* end = data + length;
+    bool fieldSeen = false;
+    size_t listBytes = 0;
+    tooLarge = false;
+
+    // Um byte de campo indexado pode render uma entrada inteira da tabela: o limite vale para a
+    // lista decodificada, não para o bloco recebido
+    auto append = [&](std::string&& name, std::string&& value) {
+        listBytes += name.size() + value.size() + kEntryOverhead;
+        if (listBytes > maxListBytes) {
+            tooLarge = true;
+            return;
+        }
+        headers.emplace_back(std::move(name), std::move(value));
+    };
+
+    while (pos < end) {
+        uint8_t first = *pos;
+        uint64_t index;
+        std::string name;
+        std::string value;
+
+        if (first & 0x80) {
+            // Campo indexado
+            if (!decodeInteger(pos, end, 7, index)) {
+                return false;
+            }
+            fieldSeen = true;
+            if (tooLarge) {
+                if (!validIndex(index)) {
+                    return false;
+                }
+                continue;
+            }
+            if (!lookup(index, name, &value)) {
+                return false;
+            }
+            append(std::move(name), std::move(value));
+            continue;
+        }
+
+        if ((first & 0xe0) == 0x20) {
+            // Atualização do tamanho da tabela: só antes do primeiro campo do bloco
+            if (fieldSeen || !decodeInteger(pos, end, 5, index) || index > maxTableSize_) {
+                return false;
+            }
+            tableLimit_ = static_cast<size_t>(index);
+            evict(tableLimit_);
+            continue;
+        }
+
+        // Literais: com indexação incremental (prefixo de 6 bits), sem indexação ou nunca indexado (4 bits)
+        bool indexed = (first & 0x40) != 0;
+        if (!decodeInteger(pos, end, indexed ? 6 : 4, index)) {
+            return false;
+        }
+        if (index == 0 ? !decodeString(pos, end, name) : !lookup(index, name, nullptr)) {
+            return false;
+        }
+        if (!decodeString(pos, end, value)) {
+            return false;
+        }
+
+        if (indexed) {
+            insert(name, value);
+        }
+        fieldSeen = true;
+        if (!tooLarge) {
+            append(std::move(name), std::move(value));
+        }
+    }
+    return true;
+}
+
+bool HpackDecoder::lookup(uint64_t index, std::string& name, std::string* value) const {
+    if (index == 0) {
+        return false;
+    }
+    if (index <= kStaticCount) {
+        const StaticEntry& entry = kStaticTable[index - 1];
+        name = entry.name;
+        if (value) {
+            *value = entry.value;
+        }
+        return true;
+    }
+
+    index -= kStaticCount + 1;
+    if (index >= dynamic_.size()) {
+        return false;
+    }
+    name = dynamic_[index].first;
+    if (value) {
+        *value = dynamic_[index].second;
+    }
+    return true;
+}
+
+bool HpackDecoder::validIndex(uint64_t index) const {
+    return index != 0 && index <= kStaticCount + dynamic_.size();
+}
+
+void HpackDecoder::insert(const std::string& name, const std::string& value) {
+    size_t size = name.size() + value.size() + kEntryOverhead;
+    if (size > tableLimit_) {
+        // Entrada maior que a tabela: esvazia sem inserir
+        evict(0);
+        return;
+    }
+    evict(tableLimit_ - size);
+    dynamic_.emplace_front(name, value);
+    tableBytes_ += size;
+}
+
+void HpackDecoder::evict(size_t limit) {
+    while (tableBytes_ > limit && !dynamic_.empty()) {
+        tableBytes_ -= dynamic_.back().first.size() + dynamic_.back().second.size() + kEntryOverhead;
+        dynamic_.pop_back();
+    }
+}
+
+void HpackEncoder::encodeTableSizeZero(std::string& out) {
+    out.push_back(0x20);
+}
+
+void HpackEncoder::encode(const std::string& name, const std::string& value, std::string& out) {
+    size_t nameIndex = 0;
+    for (size_t i = 0; i < kStaticCount; ++i) {
+        if (name != kStaticTable[i].name) {
+            continue;
+        }
+        if (value == kStaticTable[i].value) {
+            encodeInteger(i + 1, 7, 0x80, out);
+            return;
+        }
+        if (nameIndex == 0) {
+            nameIndex = i + 1;
+        }
+    }
+
+    // Literal sem indexação: nome da tabela estática quando existir
+    encodeInteger(nameIndex, 4, 0x00, out);
+    if (nameIndex == 0) {
+        encodeString(name, out);
+    }
+    encodeString(value, out);
+}
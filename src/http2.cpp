@@ -0,0 +1,1121 @@
+#include "http2.h"
+#include "http_handler.h"
+#include "socket_io.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace {
+
+enum FrameType : uint8_t {
+    kData = 0x0,
+    kHeaders = 0x1,
+    kPriority = 0x2,
+    kRstStream = 0x3,
+    kSettings = 0x4,
+    kPushPromise = 0x5,
+    kPing = 0x6,
+    kGoAway = 0x7,
+    kWindowUpdate = 0x8,
+    kContinuation = 0x9
+};
+
+enum FrameFlag : uint8_t {
+    kEndStream = 0x1,
+    kAck = 0x1,
+    kEndHeaders = 0x4,
+    kPadded = 0x8,
+    kPriorityFlag = 0x20
+};
+
+enum ErrorCode : uint32_t {
+    kNoError = 0x0,
+    kProtocolError = 0x1,
+    kInternalError = 0x2,
+    kFlowControlError = 0x3,
+    kStreamClosed = 0x5,
+    kFrameSizeError = 0x6,
+    kRefusedStream = 0x7,
+    kCompressionError = 0x9,
+    kEnhanceYourCalm = 0xb
+};
+
+enum SettingId : uint16_t {
+    kHeaderTableSize = 0x1,
+    kEnablePush = 0x2,
+    kMaxConcurrentStreams = 0x3,
+    kInitialWindowSize = 0x4,
+    kMaxFrameSize = 0x5,
+    kMaxHeaderListSize = 0x6
+};
+
+constexpr char kClientPreface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+constexpr size_t kPrefaceLineBytes = 18;    // "PRI * HTTP/2.0\r\n\r\n"
+constexpr size_t kFrameHeaderBytes = 9;
+constexpr size_t kMaxFrameBytes = 16384;    // Padrão do protocolo, não alterado nos SETTINGS
+constexpr int64_t kMaxWindow = 0x7fffffff;
+constexpr int64_t kDefaultWindow = 65535;
+constexpr int64_t kQuantumPerWeight = 1024;     // Peso 16 (padrão): 16 KB por stream e rodada
+constexpr std::chrono::seconds kResetWindow(10);
+
+uint32_t readUint32(const uint8_t* data) {
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+void writeUint32(std::string& out, uint32_t value) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+void appendFrameHeader(std::string& out, size_t length, uint8_t type, uint8_t flags, uint32_t streamId) {
+    out.push_back(static_cast<char>(length >> 16));
+    out.push_back(static_cast<char>(length >> 8));
+    out.push_back(static_cast<char>(length));
+    out.push_back(static_cast<char>(type));
+    out.push_back(static_cast<char>(flags));
+    writeUint32(out, streamId & 0x7fffffff);
+}
+
+void appendFrame(std::string& out, uint8_t type, uint8_t flags, uint32_t streamId, const std::string& payload) {
+    appendFrameHeader(out, payload.size(), type, flags, streamId);
+    out += payload;
+}
+
+void appendSetting(std::string& out, uint16_t id, uint32_t value) {
+    out.push_back(static_cast<char>(id >> 8));
+    out.push_back(static_cast<char>(id));
+    writeUint32(out, value);
+}
+
+void appendWindowUpdate(std::string& out, uint32_t streamId, uint32_t increment) {
+    std::string payload;
+    writeUint32(payload, increment);
+    appendFrame(out, kWindowUpdate, 0, streamId, payload);
+}
+
+// Remove o preenchimento (flag PADDED); false se o tamanho declarado não couber no frame
+bool stripPadding(uint8_t flags, const uint8_t*& payload, size_t& length) {
+    if ((flags & kPadded) == 0) {
+        return true;
+    }
+    if (length < 1 || payload[0] >= length) {
+        return false;
+    }
+    size_t padding = payload[0];
+    payload++;
+    length -= 1 + padding;
+    return true;
+}
+
+bool decodeBase64Url(const std::string& input, std::string& output) {
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : input) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '-' || c == '+') value = 62;
+        else if (c == '_' || c == '/') value = 63;
+        else if (c == '=') break;
+        else return false;
+
+        buffer = (buffer << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            output.push_back(static_cast<char>(buffer >> bits));
+        }
+    }
+    return true;
+}
+
+bool isConnectionSpecific(const std::string& name) {
+    return name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+           name == "transfer-encoding" || name == "upgrade";
+}
+
+// RFC 9113, 8.2.1: NUL, CR e LF nunca valem num campo; o proxy os escreveria num cabeçalho HTTP/1.1
+bool invalidFieldBytes(const std::string& text) {
+    return text.find_first_of(std::string("\0\r\n", 3)) != std::string::npos;
+}
+
+// Converte a lista de campos HPACK em HttpRequest; false para requisição malformada (RFC 9113, 8.1.1)
+bool buildRequest(HeaderList& fields, HttpRequest& request, bool& badPath) {
+    std::string scheme;
+    std::string authority;
+    bool regularSeen = false;
+
+    for (auto& field : fields) {
+        const std::string& name = field.first;
+        if (invalidFieldBytes(field.second)) {
+            return false;
+        }
+        if (!name.empty() && name[0] == ':') {
+            if (regularSeen) {
+                return false;
+            }
+            std::string* target = name == ":method" ? &request.method
+                                : name == ":path" ? &request.path
+                                : name == ":scheme" ? &scheme
+                                : name == ":authority" ? &authority : nullptr;
+            if (!target || !target->empty()) {
+                return false;
+            }
+            *target = std::move(field.second);
+            continue;
+        }
+
+        regularSeen = true;
+        if (name.empty() ||
+            std::any_of(name.begin(), name.end(), [](unsigned char c) {
+                return (c >= 'A' && c <= 'Z') || c <= ' ' || c == ':' || c >= 0x7f;
+            }) ||
+            isConnectionSpecific(name) || (name == "te" && field.second != "trailers")) {
+            return false;
+        }
+
+        auto it = request.headers.find(name);
+        if (it == request.headers.end()) {
+            request.headers.emplace(name, std::move(field.second));
+        } else {
+            it->second += (name == "cookie" ? "; " : ", ") + field.second;
+        }
+    }
+
+    if (request.method.empty() || request.path.empty() || scheme.empty() ||
+        request.method.find_first_of(" \t") != std::string::npos) {
+        return false;
+    }
+
+    if (!authority.empty() && request.headers.find("host") == request.headers.end()) {
+        request.headers["host"] = authority;
+    }
+    request.methodId = parseMethod(request.method);
+    request.version = "HTTP/2.0";
+    request.keepAlive = true;
+    badPath = !normalizeRequestPath(request.path, request.query);
+    return true;
+}
+
+struct BodyPart {
+    const char* data = nullptr;             // Memória (corpo ou bloco gerado)
+    int fd = -1;                            // Ou trecho de arquivo lido com pread
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    std::shared_ptr<std::string> owned;     // Bloco do gerador, mantido até o envio
+};
+
+}
+
+struct Http2Session::Stream {
+    uint32_t id = 0;
+    bool remoteClosed = false;              // Requisição completa (END_STREAM recebido)
+    uint16_t weight = 16;
+    int64_t sendWindow = kDefaultWindow;
+    int64_t receiveWindow = 0;
+    int64_t deficit = 0;
+
+    HttpRequest request;
+    int64_t declaredLength = -1;
+    uint64_t bodyLimit = 0;
+    StreamBuffers* buffers = nullptr;       // Onde o corpo acumulado está contado
+    size_t bufferedBytes = 0;
+
+    std::unique_ptr<HttpResponse> response;
+    std::string headerBlock;
+    bool headersSent = false;
+    bool finished = false;                  // END_STREAM enviado
+    std::deque<BodyPart> parts;
+    bool generating = false;                // response->stream ainda produz blocos
+
+    ~Stream() {
+        releaseBody();
+    }
+
+    void releaseBody() {
+        if (buffers && bufferedBytes > 0) {
+            buffers->release(bufferedBytes);
+        }
+        bufferedBytes = 0;
+    }
+
+    bool hasBody() const {
+        return !parts.empty() || generating;
+    }
+};
+
+Http2Session::Http2Session(Connection& connection, TimerWheel& timers, const Http2Config& config,
+                           StreamBuffers& buffers, BodyLimit bodyLimit, RequestHandler handler,
+                           const std::atomic<bool>* draining)
+    : connection_(connection), timers_(timers), config_(config), buffers_(buffers), bodyLimit_(std::move(bodyLimit)),
+      handler_(std::move(handler)), draining_(draining), receiveWindow_(config.connectionWindowSize) {
+}
+
+Http2Session::~Http2Session() {
+    // Descartada no event loop (ociosidade ou encerramento do servidor): avisa o cliente
+    if (parked_) {
+        appendGoAway(kNoError);
+        ssize_t sent = send(connection_.socket, control_.data(), control_.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        (void)sent;
+    }
+}
+
+bool Http2Session::isPreface(const std::string& requestHead) {
+    return requestHead.compare(0, std::string::npos, kClientPreface, kPrefaceLineBytes) == 0;
+}
+
+bool Http2Session::acceptUpgrade(const std::string& settingsHeader) {
+    std::string settings;
+    return decodeBase64Url(settingsHeader, settings) && settings.size() % 6 == 0 &&
+           applySettings(reinterpret_cast<const uint8_t*>(settings.data()), settings.size());
+}
+
+void Http2Session::adoptUpgradeRequest(HttpRequest& request) {
+    // A requisição do upgrade já está completa: vira o stream 1, meio fechado pelo cliente
+    Stream* stream = openStream(1, 16);
+    stream->request = std::move(request);
+    stream->request.version = "HTTP/2.0";
+    stream->remoteClosed = true;
+}
+
+bool Http2Session::serve(bool upgraded) {
+    prefaceTail_ = upgraded ? kClientPreface : kClientPreface + kPrefaceLineBytes;
+    prefaceRemaining_ = std::strlen(prefaceTail_);
+    resetWindowStart_ = std::chrono::steady_clock::now();
+
+    // Bytes que o parser HTTP/1.1 já tinha lido pertencem à sessão
+    input_.swap(connection_.readBuffer);
+    connection_.readBuffer.clear();
+
+    std::string settings;
+    appendSetting(settings, kMaxConcurrentStreams, config_.maxConcurrentStreams);
+    appendSetting(settings, kInitialWindowSize, config_.initialWindowSize);
+    appendSetting(settings, kMaxHeaderListSize, static_cast<uint32_t>(config_.maxHeaderListBytes));
+    appendFrame(control_, kSettings, 0, 0, settings);
+    if (config_.connectionWindowSize > kDefaultWindow) {
+        appendWindowUpdate(control_, 0, static_cast<uint32_t>(config_.connectionWindowSize - kDefaultWindow));
+    }
+
+    if (upgraded) {
+        auto it = streams_.find(1);
+        if (it != streams_.end()) {
+            lastStreamId_ = 1;
+            completeRequest(*it->second);
+        }
+    }
+
+    // Frames lidos junto com o prefácio já estão no buffer: o poll não avisaria deles
+    if (!input_.empty() && !processInput()) {
+        writeRound();
+        return false;
+    }
+    return run();
+}
+
+bool Http2Session::resume() {
+    parked_ = false;
+    return run();
+}
+
+bool Http2Session::run() {
+    char buffer[16 * 1024];
+    while (true) {
+        // Encerramento do servidor: o cliente não abre novos streams e os atuais terminam
+        if (draining_ && !goawaySent_ && draining_->load()) {
+            appendGoAway(kNoError);
+        }
+        if (!writeRound() || closing_) {
+            return false;
+        }
+        if ((goawayReceived_ || goawaySent_) && streams_.empty()) {
+            return false;
+        }
+
+        // Sem streams nem dados a enviar, só o que já chegou é lido: senão a conexão volta ao
+        // event loop em vez de prender a thread. Com streams abertos a espera é pelo cliente
+        // (corpo ou WINDOW_UPDATE), e o piso de taxa de recepção a mede
+        bool sendable = hasSendableData();
+        bool idle = !sendable && streams_.empty();
+        pollfd descriptor{connection_.socket, POLLIN, 0};
+        connection_.receiving.store(!sendable && !idle, std::memory_order_relaxed);
+        int ready = poll(&descriptor, 1, sendable || idle ? 0 : config_.timeoutSeconds * 1000);
+        connection_.receiving.store(false, std::memory_order_relaxed);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready < 0) {
+            return false;
+        }
+        if (ready == 0) {
+            if (sendable) {
+                continue;
+            }
+            if (idle) {
+                parked_ = true;
+                connection_.idleTimeout = std::chrono::seconds(config_.timeoutSeconds);
+                return true;
+            }
+            // Streams abertos sem tráfego no prazo: encerra avisando o último stream processado
+            connectionError(kNoError);
+            writeRound();
+            return false;
+        }
+
+        ssize_t received = recv(connection_.socket, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return false;
+        }
+        input_.append(buffer, static_cast<size_t>(received));
+
+        if (!processInput()) {
+            writeRound();
+            return false;
+        }
+    }
+}
+
+bool Http2Session::processInput() {
+    size_t consumed = 0;
+
+    if (prefaceRemaining_ > 0) {
+        size_t take = std::min(prefaceRemaining_, input_.size());
+        if (input_.compare(0, take, prefaceTail_, take) != 0) {
+            closing_ = true;
+            return false;
+        }
+        prefaceTail_ += take;
+        prefaceRemaining_ -= take;
+        consumed = take;
+    }
+
+    while (prefaceRemaining_ == 0 && input_.size() - consumed >= kFrameHeaderBytes) {
+        const uint8_t* header = reinterpret_cast<const uint8_t*>(input_.data()) + consumed;
+        size_t length = (static_cast<size_t>(header[0]) << 16) | (static_cast<size_t>(header[1]) << 8) | header[2];
+        uint8_t type = header[3];
+        uint8_t flags = header[4];
+        uint32_t streamId = readUint32(header + 5) & 0x7fffffff;
+
+        if (length > kMaxFrameBytes) {
+            return connectionError(kFrameSizeError);
+        }
+        if (input_.size() - consumed < kFrameHeaderBytes + length) {
+            break;
+        }
+
+        consumed += kFrameHeaderBytes + length;
+        if (!handleFrame(type, flags, streamId, header + kFrameHeaderBytes, length) || closing_) {
+            return false;
+        }
+    }
+
+    input_.erase(0, consumed);
+    return true;
+}
+
+bool Http2Session::handleFrame(uint8_t type, uint8_t flags, uint32_t streamId,
+                               const uint8_t* payload, size_t length) {
+    // O primeiro frame do cliente é SETTINGS; um bloco de headers aberto só aceita CONTINUATION
+    if (!settingsReceived_ && type != kSettings) {
+        return connectionError(kProtocolError);
+    }
+    if (continuationStream_ != 0 && (type != kContinuation || streamId != continuationStream_)) {
+        return connectionError(kProtocolError);
+    }
+
+    switch (type) {
+        case kData:
+            return handleData(flags, streamId, payload, length);
+
+        case kHeaders:
+            return handleHeaders(flags, streamId, payload, length);
+
+        case kContinuation:
+            if (continuationStream_ == 0) {
+                return connectionError(kProtocolError);
+            }
+            headerBlock_.append(reinterpret_cast<const char*>(payload), length);
+            if (headerBlock_.size() > config_.maxHeaderListBytes * 2) {
+                return connectionError(kEnhanceYourCalm);
+            }
+            return (flags & kEndHeaders) ? finishHeaderBlock() : true;
+
+        case kPriority: {
+            if (streamId == 0) {
+                return connectionError(kProtocolError);
+            }
+            if (length != 5) {
+                resetStream(streamId, kFrameSizeError);
+                return true;
+            }
+            // Árvore de dependências achatada: só o peso entra no escalonamento
+            auto it = streams_.find(streamId);
+            if ((readUint32(payload) & 0x7fffffff) == streamId) {
+                resetStream(streamId, kProtocolError);
+            } else if (it != streams_.end()) {
+                it->second->weight = static_cast<uint16_t>(payload[4] + 1);
+            }
+            return true;
+        }
+
+        case kRstStream:
+            if (length != 4) {
+                return connectionError(kFrameSizeError);
+            }
+            if (streamId == 0 || streamId > lastStreamId_) {
+                return connectionError(kProtocolError);
+            }
+            // O handler já rodou para esse stream: HEADERS seguido de RST em laço só custa ao servidor
+            streams_.erase(streamId);
+            return countReset();
+
+        case kSettings:
+            return handleSettings(flags, streamId, payload, length);
+
+        case kPushPromise:
+            return connectionError(kProtocolError);
+
+        case kPing: {
+            if (length != 8) {
+                return connectionError(kFrameSizeError);
+            }
+            if (streamId != 0) {
+                return connectionError(kProtocolError);
+            }
+            if ((flags & kAck) == 0) {
+                appendFrame(control_, kPing, kAck, 0, std::string(reinterpret_cast<const char*>(payload), length));
+            }
+            return true;
+        }
+
+        case kGoAway:
+            if (streamId != 0 || length < 8) {
+                return connectionError(kProtocolError);
+            }
+            goawayReceived_ = true;
+            return true;
+
+        case kWindowUpdate:
+            return handleWindowUpdate(streamId, payload, length);
+
+        default:
+            return true;    // Tipos desconhecidos são ignorados
+    }
+}
+
+bool Http2Session::handleHeaders(uint8_t flags, uint32_t streamId, const uint8_t* payload, size_t length) {
+    if (streamId == 0 || streamId % 2 == 0) {
+        return connectionError(kProtocolError);
+    }
+    if (!stripPadding(flags, payload, length)) {
+        return connectionError(kProtocolError);
+    }
+
+    uint16_t weight = 16;
+    if (flags & kPriorityFlag) {
+        if (length < 5) {
+            return connectionError(kFrameSizeError);
+        }
+        if ((readUint32(payload) & 0x7fffffff) == streamId) {
+            return connectionError(kProtocolError);
+        }
+        weight = static_cast<uint16_t>(payload[4] + 1);
+        payload += 5;
+        length -= 5;
+    }
+
+    auto it = streams_.find(streamId);
+    if (it != streams_.end()) {
+        // Trailers da requisição: precisam fechar o lado do cliente
+        if (it->second->remoteClosed) {
+            return connectionError(kStreamClosed);
+        }
+        if ((flags & kEndStream) == 0) {
+            return connectionError(kProtocolError);
+        }
+    } else if (streamId <= lastStreamId_) {
+        return connectionError(kStreamClosed);
+    }
+
+    continuationStream_ = streamId;
+    headerBlock_.assign(reinterpret_cast<const char*>(payload), length);
+    headerEndStream_ = (flags & kEndStream) != 0;
+    headerWeight_ = weight;
+    return (flags & kEndHeaders) ? finishHeaderBlock() : true;
+}
+
+bool Http2Session::finishHeaderBlock() {
+    uint32_t streamId = continuationStream_;
+    continuationStream_ = 0;
+
+    // Decodifica sempre, mesmo para streams recusados: a tabela dinâmica é da conexão
+    HeaderList fields;
+    bool tooLarge = false;
+    if (!decoder_.decode(reinterpret_cast<const uint8_t*>(headerBlock_.data()), headerBlock_.size(),
+                         config_.maxHeaderListBytes, fields, tooLarge)) {
+        return connectionError(kCompressionError);
+    }
+    headerBlock_.clear();
+
+    auto it = streams_.find(streamId);
+    if (it != streams_.end()) {
+        if (it->second->response) {
+            it->second->remoteClosed = true;
+        } else {
+            completeRequest(*it->second);
+        }
+        return true;
+    }
+
+    lastStreamId_ = streamId;
+    if (goawayReceived_ || goawaySent_ || streams_.size() >= config_.maxConcurrentStreams) {
+        resetStream(streamId, kRefusedStream);
+        return true;
+    }
+
+    Stream* stream = openStream(streamId, headerWeight_);
+    stream->remoteClosed = headerEndStream_;
+    if (tooLarge) {
+        // Lista incompleta: pseudo-headers podem ter ficado de fora, então nem se monta a requisição
+        respondEarly(*stream, 431, "Request Header Fields Too Large");
+        return true;
+    }
+    bool badPath = false;
+    if (!buildRequest(fields, stream->request, badPath)) {
+        resetStream(streamId, kProtocolError);
+        return true;
+    }
+
+    auto lengthIt = stream->request.headers.find("content-length");
+    if (lengthIt != stream->request.headers.end()) {
+        char* end = nullptr;
+        stream->declaredLength = static_cast<int64_t>(std::strtoll(lengthIt->second.c_str(), &end, 10));
+        if (lengthIt->second.empty() || *end != '\0' || stream->declaredLength < 0) {
+            resetStream(streamId, kProtocolError);
+            return true;
+        }
+    }
+
+    // Erros que ainda rendem uma resposta: o corpo que vier depois é descartado
+    if (badPath) {
+        respondEarly(*stream, 400, "Bad Request");
+        return true;
+    }
+    stream->bodyLimit = bodyLimit_(stream->request);
+    if (stream->declaredLength > 0 && static_cast<uint64_t>(stream->declaredLength) > stream->bodyLimit) {
+        respondEarly(*stream, 413, "Payload Too Large");
+        return true;
+    }
+
+    if (headerEndStream_) {
+        completeRequest(*stream);
+    }
+    return true;
+}
+
+bool Http2Session::handleData(uint8_t flags, uint32_t streamId, const uint8_t* payload, size_t length) {
+    if (streamId == 0) {
+        return connectionError(kProtocolError);
+    }
+
+    // Controle de fluxo conta o frame inteiro, inclusive o preenchimento
+    receiveWindow_ -= static_cast<int64_t>(length);
+    if (receiveWindow_ < 0) {
+        return connectionError(kFlowControlError);
+    }
+    if (receiveWindow_ < config_.connectionWindowSize / 2) {
+        appendWindowUpdate(control_, 0, static_cast<uint32_t>(config_.connectionWindowSize - receiveWindow_));
+        receiveWindow_ = config_.connectionWindowSize;
+    }
+
+    size_t frameLength = length;
+    if (!stripPadding(flags, payload, length)) {
+        return connectionError(kProtocolError);
+    }
+
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) {
+        // Stream já encerrado (resposta enviada ou reset): dados descartados
+        return streamId <= lastStreamId_ ? true : connectionError(kProtocolError);
+    }
+
+    Stream& stream = *it->second;
+    if (stream.remoteClosed) {
+        resetStream(streamId, kStreamClosed);
+        return true;
+    }
+
+    stream.receiveWindow -= static_cast<int64_t>(frameLength);
+    if (stream.receiveWindow < 0) {
+        resetStream(streamId, kFlowControlError);
+        return true;
+    }
+    if (!stream.response) {
+        // Corpo acima do limite da rota, ou sem espaço no total entre conexões: a resposta de erro
+        // sai já e a janela do stream deixa de ser renovada
+        if (stream.request.body.size() + length > stream.bodyLimit) {
+            respondEarly(stream, 413, "Payload Too Large");
+        } else if (length > 0 && !buffers_.acquire(length, std::chrono::milliseconds(0))) {
+            respondEarly(stream, 503, "Service Unavailable");
+        } else {
+            stream.buffers = &buffers_;
+            stream.bufferedBytes += length;
+            stream.request.body.append(reinterpret_cast<const char*>(payload), length);
+        }
+    }
+
+    if ((flags & kEndStream) == 0 && !stream.response && stream.receiveWindow < config_.initialWindowSize / 2) {
+        appendWindowUpdate(control_, streamId, static_cast<uint32_t>(config_.initialWindowSize - stream.receiveWindow));
+        stream.receiveWindow = config_.initialWindowSize;
+    }
+
+    if (flags & kEndStream) {
+        if (stream.response) {
+            stream.remoteClosed = true;
+        } else {
+            completeRequest(stream);
+        }
+    }
+    return true;
+}
+
+bool Http2Session::handleSettings(uint8_t flags, uint32_t streamId, const uint8_t* payload, size_t length) {
+    if (streamId != 0) {
+        return connectionError(kProtocolError);
+    }
+    if (flags & kAck) {
+        return length == 0 ? true : connectionError(kFrameSizeError);
+    }
+    if (length % 6 != 0) {
+        return connectionError(kFrameSizeError);
+    }
+    if (!applySettings(payload, length)) {
+        return false;
+    }
+    settingsReceived_ = true;
+    appendFrameHeader(control_, 0, kSettings, kAck, 0);
+    return true;
+}
+
+bool Http2Session::applySettings(const uint8_t* payload, size_t length) {
+    for (size_t offset = 0; offset + 6 <= length; offset += 6) {
+        uint16_t id = static_cast<uint16_t>((payload[offset] << 8) | payload[offset + 1]);
+        uint32_t value = readUint32(payload + offset + 2);
+
+        switch (id) {
+            case kEnablePush:
+                if (value > 1) {
+                    return connectionError(kProtocolError);
+                }
+                break;
+
+            case kInitialWindowSize: {
+                if (value > kMaxWindow) {
+                    return connectionError(kFlowControlError);
+                }
+                // A diferença vale para as janelas de todos os streams abertos
+                int64_t delta = static_cast<int64_t>(value) - peerInitialWindow_;
+                peerInitialWindow_ = value;
+                for (auto& entry : streams_) {
+                    entry.second->sendWindow += delta;
+                    if (entry.second->sendWindow > kMaxWindow) {
+                        return connectionError(kFlowControlError);
+                    }
+                }
+                break;
+            }
+
+            case kMaxFrameSize:
+                if (value < 16384 || value > 16777215) {
+                    return connectionError(kProtocolError);
+                }
+                peerMaxFrameSize_ = value;
+                break;
+
+            default:
+                // Tamanho da tabela HPACK: o codificador não usa tabela dinâmica
+                break;
+        }
+    }
+    return true;
+}
+
+bool Http2Session::handleWindowUpdate(uint32_t streamId, const uint8_t* payload, size_t length) {
+    if (length != 4) {
+        return connectionError(kFrameSizeError);
+    }
+    int64_t increment = readUint32(payload) & 0x7fffffff;
+
+    if (streamId == 0) {
+        if (increment == 0) {
+            return connectionError(kProtocolError);
+        }
+        sendWindow_ += increment;
+        return sendWindow_ > kMaxWindow ? connectionError(kFlowControlError) : true;
+    }
+
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) {
+        return streamId <= lastStreamId_ ? true : connectionError(kProtocolError);
+    }
+    if (increment == 0) {
+        resetStream(streamId, kProtocolError);
+        return true;
+    }
+    it->second->sendWindow += increment;
+    if (it->second->sendWindow > kMaxWindow) {
+        resetStream(streamId, kFlowControlError);
+    }
+    return true;
+}
+
+Http2Session::Stream* Http2Session::openStream(uint32_t id, uint16_t weight) {
+    auto stream = std::make_unique<Stream>();
+    stream->id = id;
+    stream->weight = weight;
+    stream->sendWindow = peerInitialWindow_;
+    stream->receiveWindow = config_.initialWindowSize;
+    Stream* pointer = stream.get();
+    streams_[id] = std::move(stream);
+    return pointer;
+}
+
+void Http2Session::completeRequest(Stream& stream) {
+    stream.remoteClosed = true;
+    if (stream.declaredLength >= 0 &&
+        static_cast<uint64_t>(stream.declaredLength) != stream.request.body.size()) {
+        resetStream(stream.id, kProtocolError);
+        return;
+    }
+
+    stream.response = std::make_unique<HttpResponse>();
+    handler_(stream.request, *stream.response);
+    // O handler já consumiu o corpo (movido para o BodyReader)
+    stream.request.body.clear();
+    stream.releaseBody();
+
+    LOG_LIMITED(Logger::Level::INFO, 100, 200, "HTTP/2 {} {} - Response {} (stream {})",
+                stream.request.method, stream.request.path, stream.response->statusCode, stream.id);
+    prepareResponse(stream);
+}
+
+void Http2Session::respondEarly(Stream& stream, int statusCode, const char* statusText) {
+    std::string().swap(stream.request.body);
+    stream.releaseBody();
+    stream.response = std::make_unique<HttpResponse>();
+    stream.response->statusCode = statusCode;
+    stream.response->statusText = statusText;
+    prepareResponse(stream);
+}
+
+void Http2Session::prepareResponse(Stream& stream) {
+    HttpResponse& response = *stream.response;
+
+    if (!tableSizeSent_) {
+        HpackEncoder::encodeTableSizeZero(stream.headerBlock);
+        tableSizeSent_ = true;
+    }
+    HpackEncoder::encode(":status", std::to_string(response.statusCode), stream.headerBlock);
+    for (const auto& header : response.headers) {
+        std::string name = header.first;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (!isConnectionSpecific(name) && name != "content-length") {
+            HpackEncoder::encode(name, header.second, stream.headerBlock);
+        }
+    }
+
+    bool bodyless = stream.request.methodId == HttpMethod::Head || response.statusCode == 304 ||
+                    response.statusCode == 204;
+    if (!response.stream && !bodyless) {
+        uint64_t contentLength = response.body.length() +
+                                 (response.sharedBody ? response.sharedBody->length() : 0) +
+                                 (response.file ? response.file->contentLength() : 0);
+        HpackEncoder::encode("content-length", std::to_string(contentLength), stream.headerBlock);
+    }
+    if (bodyless) {
+        return;
+    }
+
+    // Mesmas partes que sendResponse envia no HTTP/1.1, agora fatiadas em frames DATA
+    auto addMemory = [&stream](const char* data, uint64_t length) {
+        if (length > 0) {
+            BodyPart part;
+            part.data = data;
+            part.length = length;
+            stream.parts.push_back(std::move(part));
+        }
+    };
+
+    addMemory(response.body.data(), response.body.size());
+    if (response.sharedBody) {
+        addMemory(response.sharedBody->data(), response.sharedBody->size());
+    }
+    if (response.file) {
+        const FileBody& file = *response.file;
+        for (const auto& segment : file.segments) {
+            addMemory(segment.prefix.data(), segment.prefix.size());
+            // Sempre por pread, mesmo com mapeamento: o frame é montado em espaço de usuário, e ler
+            // páginas de um arquivo truncado depois do mmap derrubaria o processo com SIGBUS
+            if (segment.length > 0) {
+                BodyPart part;
+                part.fd = file.fd;
+                part.offset = segment.offset;
+                part.length = segment.length;
+                stream.parts.push_back(std::move(part));
+            }
+        }
+        addMemory(file.trailer.data(), file.trailer.size());
+    }
+    stream.generating = static_cast<bool>(response.stream);
+}
+
+void Http2Session::resetStream(uint32_t id, uint32_t errorCode) {
+    std::string payload;
+    writeUint32(payload, errorCode);
+    appendFrame(control_, kRstStream, 0, id, payload);
+    streams_.erase(id);
+    countReset();
+}
+
+bool Http2Session::countReset() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - resetWindowStart_ >= kResetWindow) {
+        resetWindowStart_ = now;
+        resets_ = 0;
+    }
+    if (++resets_ > config_.maxResets && !closing_) {
+        LOG_LIMITED(Logger::Level::WARNING, 1, 10, "HTTP/2 session closed: {} streams reset within {}s from {}",
+                    resets_, kResetWindow.count(), connection_.peerAddress);
+        return connectionError(kEnhanceYourCalm);
+    }
+    return true;
+}
+
+bool Http2Session::connectionError(uint32_t errorCode) {
+    appendGoAway(errorCode);
+    closing_ = true;
+    return false;
+}
+
+void Http2Session::appendGoAway(uint32_t errorCode) {
+    std::string payload;
+    writeUint32(payload, lastStreamId_);
+    writeUint32(payload, errorCode);
+    appendFrame(control_, kGoAway, 0, 0, payload);
+    goawaySent_ = true;
+}
+
+bool Http2Session::hasSendableData() const {
+    if (!control_.empty()) {
+        return true;
+    }
+    for (const auto& entry : streams_) {
+        const Stream& stream = *entry.second;
+        if (!stream.response || stream.finished) {
+            continue;
+        }
+        // Fim do corpo (frame vazio com END_STREAM) não depende das janelas
+        if (!stream.headersSent || !stream.hasBody() ||
+            (stream.sendWindow > 0 && sendWindow_ > 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Http2Session::writeRound() {
+    std::vector<iovec> buffers;
+    std::deque<std::string> storage;    // Cabeçalhos de frame e blocos lidos: endereços estáveis
+    std::vector<std::shared_ptr<std::string>> generated;
+
+    auto append = [&buffers](const char* data, size_t length) {
+        if (length > 0) {
+            buffers.push_back({const_cast<char*>(data), length});
+        }
+    };
+
+    if (!control_.empty()) {
+        storage.push_back(std::move(control_));
+        control_.clear();
+        append(storage.back().data(), storage.back().size());
+    }
+
+    // Headers primeiro (não sujeitos ao controle de fluxo), fatiados em CONTINUATION se preciso
+    for (auto& entry : streams_) {
+        Stream& stream = *entry.second;
+        if (!stream.response || stream.headersSent) {
+            continue;
+        }
+        stream.headersSent = true;
+        stream.finished = !stream.hasBody();
+
+        const std::string& block = stream.headerBlock;
+        size_t offset = 0;
+        do {
+            size_t length = std::min<size_t>(block.size() - offset, peerMaxFrameSize_);
+            bool last = offset + length == block.size();
+            uint8_t flags = last ? kEndHeaders : 0;
+            if (offset == 0 && stream.finished) {
+                flags |= kEndStream;
+            }
+            storage.emplace_back();
+            appendFrameHeader(storage.back(), length, offset == 0 ? kHeaders : kContinuation, flags, stream.id);
+            append(storage.back().data(), storage.back().size());
+            append(block.data() + offset, length);
+            offset += length;
+        } while (offset < block.size());
+    }
+
+    // Dados por rodada (um único writev) limitados pelo buffer por conexão; se algum corpo vem de
+    // arquivo lido com pread, a rodada inteira é reservada no limite global antes de ler
+    size_t budget = buffers_.config().connectionBufferBytes;
+    bool readsFile = false;
+    for (const auto& entry : streams_) {
+        const Stream& stream = *entry.second;
+        readsFile = readsFile || (stream.headersSent && std::any_of(stream.parts.begin(), stream.parts.end(),
+                                                                    [](const BodyPart& part) { return part.fd >= 0; }));
+    }
+    StreamBufferReservation reservation(buffers_, readsFile ? budget : 0, buffers_.stallTimeout());
+    if (!reservation) {
+        LOG_LIMITED(Logger::Level::WARNING, 1, 10, "HTTP/2 session closed: no room for file data within {}s",
+                    buffers_.config().stallTimeoutSeconds);
+        return false;
+    }
+    
+    // Round-robin ponderado (déficit): cada stream recebe um quantum proporcional ao peso
+    // por passada; as passadas se repetem até esgotar o orçamento da rodada ou as janelas
+    bool progress = true;
+    while (budget > 0 && progress) {
+        progress = false;
+        for (auto& entry : streams_) {
+            Stream& stream = *entry.second;
+            if (!stream.headersSent || stream.finished) {
+                continue;
+            }
+
+            stream.deficit += stream.weight * kQuantumPerWeight;
+            while (!stream.finished && budget > 0) {
+                // Gerador: produz o próximo bloco quando as partes conhecidas acabam
+                while (stream.parts.empty() && stream.generating) {
+                    auto chunk = std::make_shared<std::string>();
+                    stream.generating = stream.response->stream(*chunk);
+                    if (!chunk->empty()) {
+                        BodyPart part;
+                        part.data = chunk->data();
+                        part.length = chunk->size();
+                        part.owned = std::move(chunk);
+                        stream.parts.push_back(std::move(part));
+                    }
+                }
+
+                int64_t allowed = std::min<int64_t>({stream.sendWindow, sendWindow_, stream.deficit,
+                                                     static_cast<int64_t>(peerMaxFrameSize_),
+                                                     static_cast<int64_t>(budget)});
+                if (!stream.parts.empty() && allowed <= 0) {
+                    break;
+                }
+
+                storage.emplace_back();
+                std::string& frameHeader = storage.back();
+                size_t headerIndex = buffers.size();
+                buffers.push_back({nullptr, kFrameHeaderBytes});
+
+                size_t length = 0;
+                bool readFailed = false;
+                while (!stream.parts.empty() && length < static_cast<size_t>(allowed)) {
+                    BodyPart& part = stream.parts.front();
+                    size_t take = static_cast<size_t>(std::min<uint64_t>(part.length, allowed - length));
+
+                    if (part.data) {
+                        append(part.data, take);
+                        part.data += take;
+                    } else {
+                        storage.emplace_back(take, '\0');
+                        ssize_t got = pread(part.fd, &storage.back()[0], take, static_cast<off_t>(part.offset));
+                        if (got != static_cast<ssize_t>(take)) {
+                            readFailed = true;
+                            break;
+                        }
+                        append(storage.back().data(), take);
+                        part.offset += take;
+                    }
+
+                    length += take;
+                    part.length -= take;
+                    if (part.length == 0) {
+                        if (part.owned) {
+                            generated.push_back(std::move(part.owned));
+                        }
+                        stream.parts.pop_front();
+                    }
+                }
+
+                if (readFailed) {
+                    // Arquivo encolheu durante o envio: o stream é abortado com RST_STREAM
+                    buffers.resize(headerIndex);
+                    std::string payload;
+                    writeUint32(payload, kInternalError);
+                    appendFrame(frameHeader, kRstStream, 0, stream.id, payload);
+                    append(frameHeader.data(), frameHeader.size());
+                    stream.parts.clear();
+                    stream.generating = false;
+                    stream.finished = true;
+                    stream.remoteClosed = true;
+                    break;
+                }
+
+                stream.finished = !stream.hasBody();
+                appendFrameHeader(frameHeader, length, kData, stream.finished ? kEndStream : 0, stream.id);
+                buffers[headerIndex].iov_base = &frameHeader[0];
+
+                stream.sendWindow -= static_cast<int64_t>(length);
+                sendWindow_ -= static_cast<int64_t>(length);
+                stream.deficit -= static_cast<int64_t>(length);
+                budget -= length;
+                progress = true;
+            }
+
+            // Déficit não se acumula enquanto o stream está bloqueado pelas janelas
+            if (stream.finished || stream.sendWindow <= 0 || sendWindow_ <= 0) {
+                stream.deficit = 0;
+            }
+        }
+        if (sendWindow_ <= 0) {
+            break;
+        }
+    }
+
+    if (buffers.empty()) {
+        return true;
+    }
+
+    bool sent;
+    {
+        SocketDeadline deadline(timers_, connection_.socket, config_.timeoutSeconds);
+        sent = sendVectored(connection_.socket, buffers);
+    }
+
+    // Respostas completas encerram o stream; se o cliente ainda envia o corpo, ele é avisado
+    for (auto it = streams_.begin(); it != streams_.end();) {
+        Stream& stream = *it->second;
+        if (!stream.finished) {
+            ++it;
+            continue;
+        }
+        if (!stream.remoteClosed) {
+            std::string payload;
+            writeUint32(payload, kNoError);
+            appendFrame(control_, kRstStream, 0, stream.id, payload);
+        }
+        it = streams_.erase(it);
+    }
+    return sent;
+}
@@ -1,78 +1,782 @@
 #include "http_handler.h"
 #include "logger.h"
+#include "http_utils.h"
+#include "socket_io.h"
 #include <sstream>
-#include <fstream>
 #include <filesystem>
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <atomic>
 
-#ifdef _WIN32
-    #include <winsock2.h>
-#else
-    #include <unistd.h>
-    #include <sys/socket.h>
-    #include <sys/time.h>
-    #define closesocket close
-#endif
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <strings.h>
 
-HttpHandler::HttpHandler(const std::string& documentRoot, const KeepAliveConfig& config) 
-    : documentRoot_(documentRoot), keepAliveConfig_(config) {
+namespace {
+
+// Resposta do backend bufferizada para streams HTTP/2
+constexpr size_t kMaxProxiedBodyBytes = 16 * 1024 * 1024;
+
+void setErrorResponse(HttpResponse& response, int statusCode, const char* statusText) {
+    response.statusCode = statusCode;
+    response.statusText = statusText;
+    response.body = "<html><body><h1>" + std::to_string(statusCode) + " " + statusText + "</h1></body></html>";
+}
+
+// 429 sem corpo HTML: sob abuso a resposta precisa sair barata
+void setRateLimited(HttpResponse& response, int retryAfterSeconds) {
+    response.statusCode = 429;
+    response.statusText = "Too Many Requests";
+    response.headers["Retry-After"] = std::to_string(retryAfterSeconds);
+}
+
+void setBodyError(HttpResponse& response, int statusCode) {
+    if (statusCode == 413) {
+        setErrorResponse(response, 413, "Content Too Large");
+    } else if (statusCode == 501) {
+        setErrorResponse(response, 501, "Not Implemented");
+    } else {
+        setErrorResponse(response, 400, "Bad Request");
+    }
+}
+
+// Enquadramento do corpo (RFC 9112 6.3); 0 ou o status de erro
+int requestBodyFraming(const HttpRequest& request, BodyReader::Framing& framing, uint64_t& length) {
+    framing = BodyReader::Framing::None;
+    length = 0;
+    
+    auto transferIt = request.headers.find("transfer-encoding");
+    auto lengthIt = request.headers.find("content-length");
+    if (transferIt != request.headers.end()) {
+        // Com os dois headers a mensagem é ambígua (request smuggling): recusa
+        if (lengthIt != request.headers.end()) {
+            return 400;
+        }
+        std::string value = transferIt->second;
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        if (value != "chunked") {
+            return 501;
+        }
+        framing = BodyReader::Framing::Chunked;
+        return 0;
+    }
+    
+    if (lengthIt != request.headers.end()) {
+        const std::string& value = lengthIt->second;
+        if (value.empty() || value.size() > 19 ||
+            !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            return 400;
+        }
+        length = std::stoull(value);
+        framing = length > 0 ? BodyReader::Framing::Length : BodyReader::Framing::None;
+    }
+    return 0;
+}
+
+uint32_t elapsedMicros(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    return static_cast<uint32_t>(std::min<int64_t>(micros, UINT32_MAX));
+}
+
+void serveHealth(HttpHandler&, const HttpRequest&, HttpResponse& response) {
+    response.headers["Content-Type"] = "text/plain";
+    response.headers["Cache-Control"] = "no-store";
+    response.body = "ok\n";
+}
+
+void serveStats(HttpHandler& handler, const HttpRequest&, HttpResponse& response) {
+    HandlerStats stats = handler.stats();
+    std::ostringstream json;
+    json << "{\"indexedDocuments\":" << stats.indexedDocuments
+         << ",\"compressionCache\":{\"bytes\":" << stats.compressionCacheBytes
+         << ",\"entries\":" << stats.compressionCacheEntries << "}"
+         << ",\"mappedFiles\":{\"bytes\":" << stats.mappedBytes
+         << ",\"entries\":" << stats.mappedFiles << "}"
+         << ",\"responseCache\":{\"bytes\":" << stats.responseCacheBytes
+         << ",\"entries\":" << stats.responseCacheEntries << "}"
+         << ",\"webSockets\":{\"clients\":" << stats.webSocketClients
+         << ",\"droppedMessages\":" << stats.webSocketDropped << "}"
+         << ",\"clients\":{\"addresses\":" << stats.clients.trackedAddresses
+         << ",\"perIpRejected\":" << stats.clients.perIpRejected
+         << ",\"headerLimitRejected\":" << stats.clients.headerLimitRejected
+         << ",\"slowReceiveCut\":" << stats.clients.slowReceiveCut
+         << ",\"slowSendCut\":" << stats.clients.slowSendCut << "}"
+         << ",\"accessLog\":{\"droppedRecords\":" << stats.accessLogDropped << "}"
+         << ",\"rateLimit\":{\"limited\":" << stats.rateLimit.limited
+         << ",\"untracked\":" << stats.rateLimit.untracked
+         << ",\"buckets\":" << stats.rateLimit.buckets << "}"
+         << ",\"streaming\":{\"bufferedBytes\":" << stats.streaming.buffered
+         << ",\"peakBytes\":" << stats.streaming.peak
+         << ",\"waits\":" << stats.streaming.waits
+         << ",\"denied\":" << stats.streaming.denied << "}"
+         << ",\"tls\":{\"handshakes\":" << stats.tls.handshakes
+         << ",\"resumed\":" << stats.tls.resumed
+         << ",\"failed\":" << stats.tls.failed
+         << ",\"notOffloaded\":" << stats.tls.notOffloaded << "}"
+         << ",\"dispatch\":{\"policy\":\"" << WorkerDispatcher::policyName(stats.dispatch.policy) << "\""
+         << ",\"queued\":" << stats.dispatch.queued
+         << ",\"imbalance\":" << stats.dispatch.imbalance
+         << ",\"rerouted\":" << stats.dispatch.rerouted << ",\"workers\":[";
+    for (size_t i = 0; i < stats.dispatch.workers.size(); ++i) {
+        const WorkerLoad& load = stats.dispatch.workers[i];
+        json << (i > 0 ? "," : "") << "{\"handled\":" << load.handled
+             << ",\"busyMs\":" << load.busyMicros / 1000 << ",\"queued\":" << load.queued << "}";
+    }
+    json << "],\"lanes\":[";
+    for (size_t i = 0; i < stats.dispatch.lanes.size(); ++i) {
+        const LaneStats& lane = stats.dispatch.lanes[i];
+        json << (i > 0 ? "," : "") << "{\"name\":\"" << lane.name << "\",\"weight\":" << lane.weight
+             << ",\"maxActive\":" << lane.maxActive << ",\"active\":" << lane.active
+             << ",\"served\":" << lane.served << ",\"costUs\":" << lane.costMicros
+             << ",\"waitUs\":" << lane.waitMicros << "}";
+    }
+    json << "]}}\n";
+    
+    response.headers["Content-Type"] = "application/json";
+    response.headers["Cache-Control"] = "no-store";
+    response.body = json.str();
+}
+
+// Rotas embutidas: a tabela de despacho é montada em tempo de compilação
+constexpr StaticRoute<HttpHandler> kBuiltinRoutes[] = {
+    {HttpMethod::Get, "/_server/health", &serveHealth},
+    {HttpMethod::Get, "/_server/stats", &serveStats},
+};
+
+using BuiltinRouter = StaticRouter<HttpHandler, kBuiltinRoutes>;
+
+}
+
+FileBody::FileBody(int fd)
+    : fd(fd) {
+}
+
+FileBody::~FileBody() {
+    close(fd);
+}
+
+uint64_t FileBody::contentLength() const {
+    uint64_t total = trailer.length();
+    for (const auto& segment : segments) {
+        total += segment.prefix.length() + segment.length;
+    }
+    return total;
+}
+
+HttpHandler::HttpHandler(const std::string& documentRoot, TimerWheel& timers, const HandlerConfig& config) 
+    : documentRoot_(documentRoot), timers_(timers),
+      keepAliveConfig_(std::make_shared<const KeepAliveConfig>(config.keepAlive)),
+      requestBodyConfig_(std::make_shared<const RequestBodyConfig>(config.requestBody)),
+      http2Config_(config.http2),
+      compressionConfig_(config.compression), compressionCache_(config.compression.cacheBytes),
+      mappedFiles_(config.mappedFiles), documentIndex_(documentRoot), preloadConfig_(config.preload),
+      webSockets_(config.webSocket), clientGuard_(config.clientLimits),
+      accessLog_(config.accessLog), rateLimiter_(config.rateLimit),
+      streamBuffers_(config.streaming), corkResponses_(config.socket.cork) {
+    
+    if (config.tls.enabled()) {
+        tls_ = std::make_unique<TlsContext>(config.tls, http2Config_.enabled);
+    }
+    
+    if (!config.proxy.routes.empty()) {
+        proxyHandler_ = std::make_unique<ProxyHandler>(config.proxy, timers_, streamBuffers_.stallTimeout());
+        
+        responseCacheConfig_ = config.responseCache;
+        if (responseCacheConfig_.enabled) {
+            responseCache_ = std::make_unique<ResponseCache>(responseCacheConfig_, [this](const HttpRequest& request) {
+                ProxyCapture capture;
+                capture.maxBodyBytes = responseCacheConfig_.maxEntryBytes;
+                proxyHandler_->fetch(request, capture);
+                if (!capture.complete) {
+                    return std::shared_ptr<const CachedResponse>();
+                }
+                return ResponseCache::makeEntry(request, capture.statusCode, std::move(capture.statusText),
+                                                std::move(capture.headers), std::move(capture.body));
+            });
+        }
+    }
     
     if (!std::filesystem::exists(documentRoot_)) {
         std::filesystem::create_directories(documentRoot_);
         Logger::getInstance().info("Created document root: " + documentRoot_);
     }
+    
+    warmUp();
+}
+
+HttpHandler::~HttpHandler() {
+    if (indexRefreshThread_.joinable()) {
+        indexRefreshThread_.join();
+    }
 }
 
-void HttpHandler::handleConnection(SOCKET clientSocket) {
-    handleConnectionWithKeepAlive(clientSocket);
+void HttpHandler::warmUp() {
+    size_t threads = std::max<size_t>(1, preloadConfig_.threads);
+    const std::string& snapshotPath = preloadConfig_.snapshotPath;
+    
+    bool restored = !snapshotPath.empty() && documentIndex_.loadSnapshot(snapshotPath);
+    if (!restored) {
+        documentIndex_.rebuild(threads);
+        if (!snapshotPath.empty() && !documentIndex_.saveSnapshot(snapshotPath)) {
+            Logger::getInstance().warning("Failed to write index snapshot " + snapshotPath);
+        }
+    }
+    
+    if (preloadConfig_.enabled) {
+        preloadFiles();
+    }
+    
+    if (restored) {
+        // O snapshot pode estar desatualizado: revarre em segundo plano e regrava
+        indexRefreshThread_ = std::thread([this, threads, snapshotPath] {
+            documentIndex_.rebuild(threads);
+            documentIndex_.saveSnapshot(snapshotPath);
+        });
+    }
 }
 
-void HttpHandler::handleConnectionWithKeepAlive(SOCKET clientSocket) {
-    int requestCount = 0;
+void HttpHandler::preloadFiles() {
+    auto startTime = std::chrono::steady_clock::now();
+    
+    std::vector<std::shared_ptr<const DocumentEntry>> candidates;
+    for (auto& entry : documentIndex_.entries()) {
+        if (entry->size > 0 && entry->size <= preloadConfig_.maxFileSize) {
+            candidates.push_back(std::move(entry));
+        }
+    }
+    
+    // Menores primeiro: o orçamento cobre o maior número possível de arquivos
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a->size < b->size;
+    });
+    
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> loadedFiles(0);
+    std::atomic<uint64_t> loadedBytes(0);
+    
+    auto worker = [&] {
+        for (size_t i = next++; i < candidates.size(); i = next++) {
+            const DocumentEntry& entry = *candidates[i];
+            if (loadedBytes.fetch_add(entry.size) + entry.size > preloadConfig_.maxTotalBytes) {
+                break;
+            }
+            
+            int fd = open(entry.filePath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                continue;
+            }
+            
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode)) {
+                int64_t mtimeNs = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000LL +
+                                  fileStat.st_mtim.tv_nsec;
+                if (mappedFiles_.acquire(entry.filePath, fd, fileStat.st_size, fileStat.st_ino, mtimeNs, true)) {
+                    loadedFiles++;
+                }
+            }
+            close(fd);
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::max<size_t>(1, preloadConfig_.threads); ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : workers) {
+        t.join();
+    }
+    
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    Logger::getInstance().info("Preloaded " + std::to_string(loadedFiles.load()) + " files (" +
+                              std::to_string(mappedFiles_.mappedBytes() / 1024) + " KB mapped) in " +
+                              std::to_string(duration.count()) + "ms");
+}
+
+bool HttpHandler::handleConnection(Connection& connection) {
+    clientGuard_.track(connection);
+    struct Untrack {
+        ClientGuard& guard;
+        Connection& connection;
+        ~Untrack() {
+            guard.untrack(connection);
+        }
+    } untrack{clientGuard_, connection};
+    
+    // Handshake e nada mais: a primeira requisição ainda não chegou, e a conexão espera por ela
+    // no event loop como qualquer keep-alive ociosa
+    if (connection.tlsPending) {
+        if (!tls_ || !tls_->accept(connection, timers_)) {
+            return false;
+        }
+        connection.tlsPending = false;
+        connection.tls = true;
+        return true;
+    }
     
-    while (requestCount < keepAliveConfig_.maxRequests) {
+    return handleConnectionWithKeepAlive(connection);
+}
+
+void HttpHandler::beginDrain() {
+    draining_.store(true);
+    webSockets_.closeAll(1001);
+}
+
+size_t HttpHandler::cutConnections() {
+    // Clientes WebSocket que não terminaram o close fecham junto com o hub
+    return clientGuard_.cutAll() + webSockets_.clients();
+}
+
+size_t HttpHandler::activeConnections() const {
+    return clientGuard_.tracked() + webSockets_.clients();
+}
+
+bool HttpHandler::handleConnectionWithKeepAlive(Connection& connection) {
+    // Sessão HTTP/2 que esperava no event loop: o cliente voltou a enviar
+    if (connection.http2) {
+        return connection.http2->resume();
+    }
+    
+    std::unique_ptr<Http2Session> http2;
+    bool upgraded = false;
+    
+    // Limites lidos uma vez por conexão: um reload não muda as regras no meio de uma requisição
+    auto keepAliveConfig = std::atomic_load(&keepAliveConfig_);
+    auto requestBodyConfig = std::atomic_load(&requestBodyConfig_);
+    
+    while (connection.requestCount < keepAliveConfig->maxRequests) {
+        SocketDeadline requestDeadline(timers_, connection.socket, keepAliveConfig->requestTimeoutSeconds);
         std::string requestData;
         
-        if (!receiveRequestWithTimeout(clientSocket, requestData)) {
-            break; // Timeout ou erro
+        auto started = std::chrono::system_clock::now();
+        auto receiveStart = std::chrono::steady_clock::now();
+        if (!receiveRequestWithTimeout(connection, requestData)) {
+            return false; // Timeout ou erro
+        }
+        auto handlerStart = std::chrono::steady_clock::now();
+        
+        // HTTP/2 com conhecimento prévio: a sessão roda fora do prazo desta requisição
+        if (http2Config_.enabled && Http2Session::isPreface(requestData)) {
+            http2 = makeHttp2Session(connection);
+            break;
         }
         
         HttpRequest request;
         HttpResponse response;
+        bool parsed = parseRequest(requestData, request);
         
-        if (parseRequest(requestData, request)) {
-            Logger::getInstance().info("HTTP " + request.method + " " + request.path + 
-                                     " - Processing (req #" + std::to_string(requestCount + 1) + ")");
+        if (parsed && http2Config_.enabled && (http2 = acceptH2cUpgrade(connection, request))) {
+            upgraded = true;
+            break;
+        }
+        bool shouldKeepAlive = request.keepAlive && !draining_.load() &&
+                               (connection.requestCount + 1 < keepAliveConfig->maxRequests);
+        bool responded = false;
+        
+        if (parsed) {
+            LOG_DEBUG("HTTP {} {} - Processing (req #{})", request.method, request.path, connection.requestCount + 1);
             
-            if (request.method == "GET") {
-                handleGetRequest(request, response);
+            int retryAfter = 0;
+            if (rateLimiter_.enabled() && !rateLimiter_.admit(connection.peerAddress, request.path, retryAfter)) {
+                setRateLimited(response, retryAfter);
+                // Corpo não lido: a conexão fecha em vez de descartá-lo
+                auto lengthIt = request.headers.find("content-length");
+                if (request.headers.count("transfer-encoding") != 0 ||
+                    (lengthIt != request.headers.end() && lengthIt->second != "0")) {
+                    shouldKeepAlive = false;
+                }
+            } else if (proxyHandler_ && proxyHandler_->matches(request.path)) {
+                responded = handleProxyRequest(connection, request, shouldKeepAlive, response, requestDeadline);
             } else {
-                response.statusCode = 405;
-                response.statusText = "Method Not Allowed";
-                response.body = "<html><body><h1>405 Method Not Allowed</h1></body></html>";
+                BodyReader::Framing framing;
+                uint64_t contentLength;
+                int framingError = requestBodyFraming(request, framing, contentLength);
+                if (framingError != 0) {
+                    setBodyError(response, framingError);
+                    shouldKeepAlive = false;
+                } else {
+                    auto expectIt = request.headers.find("expect");
+                    bool expectContinue = expectIt != request.headers.end() &&
+                                          strcasecmp(expectIt->second.c_str(), "100-continue") == 0;
+                    
+                    BodyReader body(connection, framing, contentLength, requestBodyConfig->maxBodyBytes, expectContinue);
+                    request.bodyReader = &body;
+                    dispatch(request, response);
+                    request.bodyReader = nullptr;
+                    
+                    // Corpo que o handler não leu: descartado se pequeno, senão a conexão fecha
+                    if (!body.drain(requestBodyConfig->maxDrainBytes)) {
+                        shouldKeepAlive = false;
+                    }
+                }
             }
         } else {
-            response.statusCode = 400;
-            response.statusText = "Bad Request";
-            response.body = "<html><body><h1>400 Bad Request</h1></body></html>";
+            setErrorResponse(response, 400, "Bad Request");
         }
         
-        bool shouldKeepAlive = request.keepAlive && (requestCount + 1 < keepAliveConfig_.maxRequests);
-        sendResponse(clientSocket, response, shouldKeepAlive);
+        auto sendStart = std::chrono::steady_clock::now();
+        uint64_t bytesSent = 0;
+        if (!responded) {
+            // Um download grande pode passar do prazo da requisição: o envio tem prazo por janela
+            requestDeadline.cancel();
+            bytesSent = sendResponse(connection.socket, response, shouldKeepAlive);
+        }
+        if (accessLog_.enabled()) {
+            auto finished = std::chrono::steady_clock::now();
+            logAccess(connection, request, response, started, bytesSent,
+                      elapsedMicros(receiveStart, handlerStart), elapsedMicros(handlerStart, sendStart),
+                      elapsedMicros(sendStart, finished), shouldKeepAlive ? kAccessFlagKeepAlive : 0);
+        }
         
-        Logger::getInstance().info("HTTP " + request.method + " " + request.path + 
-                                 " - Response " + std::to_string(response.statusCode) +
-                                 (shouldKeepAlive ? " (keep-alive)" : " (close)"));
+        // Uma linha por requisição: o registro completo fica no log de acesso
+        LOG_LIMITED(Logger::Level::INFO, 100, 200, "HTTP {} {} - Response {} ({})",
+                    request.method, request.path, response.statusCode,
+                    response.takeover ? "upgrade" : shouldKeepAlive ? "keep-alive" : "close");
         
-        requestCount++;
+        connection.requestCount++;
+        
+        if (response.takeover) {
+            response.takeover(connection);
+            return false;
+        }
         
         if (!shouldKeepAlive) {
-            break;
+            return false;
+        }
+        
+        // Sem requisição em pipeline: a conexão aguarda ociosa no event loop
+        if (connection.readBuffer.empty()) {
+            return true;
         }
     }
     
-    closesocket(clientSocket);
+    // A sessão HTTP/2 fica com a conexão até o fim; ociosa, as duas esperam juntas no event loop
+    if (http2) {
+        Logger::getInstance().info(upgraded ? "HTTP/2 session started (h2c upgrade)"
+                                            : "HTTP/2 session started (prior knowledge)");
+        connection.http2 = std::move(http2);
+        return connection.http2->serve(upgraded);
+    }
+    return false;
+}
+
+std::unique_ptr<Http2Session> HttpHandler::makeHttp2Session(Connection& connection) {
+    auto requestBodyConfig = std::atomic_load(&requestBodyConfig_);
+    // Sem BodyReader ligado ao socket, o corpo sempre acumula na sessão: rotas com streaming
+    // aceitam até maxBodyBytes, as demais só o que aceitariam em HTTP/1.1
+    auto bodyLimit = [this, requestBodyConfig](const HttpRequest& request) -> uint64_t {
+        RouteParams params;
+        uint32_t allowed = 0;
+        const auto* route = routes_.find(request.methodId, request.path, params, allowed);
+        return route && route->streamBody ? requestBodyConfig->maxBodyBytes : requestBodyConfig->maxBufferedBytes;
+    };
+    return std::make_unique<Http2Session>(connection, timers_, http2Config_, streamBuffers_, bodyLimit,
+        [this, &connection](HttpRequest& request, HttpResponse& response) {
+            auto started = std::chrono::system_clock::now();
+            auto handlerStart = std::chrono::steady_clock::now();
+            int retryAfter = 0;
+            if (rateLimiter_.enabled() && !rateLimiter_.admit(connection.peerAddress, request.path, retryAfter)) {
+                setRateLimited(response, retryAfter);
+            } else {
+                handleHttp2Request(request, response);
+            }
+            // Os quadros saem pela sessão, intercalados com outros streams: só o tempo do handler
+            if (accessLog_.enabled()) {
+                uint64_t bodyBytes = response.body.length() +
+                                     (response.sharedBody ? response.sharedBody->length() : 0) +
+                                     (response.file ? response.file->contentLength() : 0);
+                logAccess(connection, request, response, started, bodyBytes, 0,
+                          elapsedMicros(handlerStart, std::chrono::steady_clock::now()), 0, kAccessFlagHttp2);
+            }
+        }, &draining_);
+}
+
+std::unique_ptr<Http2Session> HttpHandler::acceptH2cUpgrade(Connection& connection, HttpRequest& request) {
+    // Sob TLS o HTTP/2 só vem pelo ALPN (RFC 9113, 3.1)
+    if (connection.tls) {
+        return nullptr;
+    }
+    auto upgradeIt = request.headers.find("upgrade");
+    auto settingsIt = request.headers.find("http2-settings");
+    if (upgradeIt == request.headers.end() || settingsIt == request.headers.end() ||
+        !containsToken(upgradeIt->second, "h2c")) {
+        return nullptr;
+    }
+    
+    // Com corpo, o upgrade é ignorado e a requisição segue em HTTP/1.1 (RFC 7540, 3.2)
+    auto lengthIt = request.headers.find("content-length");
+    if (request.headers.count("transfer-encoding") != 0 ||
+        (lengthIt != request.headers.end() && lengthIt->second != "0")) {
+        return nullptr;
+    }
+    
+    std::string settings = settingsIt->second;
+    auto session = makeHttp2Session(connection);
+    if (!session->acceptUpgrade(settings)) {
+        return nullptr;
+    }
+    
+    // A requisição só passa à sessão com o 101 enviado: em falha ela segue intacta em HTTP/1.1
+    static const char kSwitching[] = "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n";
+    if (!sendAll(connection.socket, kSwitching, sizeof(kSwitching) - 1)) {
+        return nullptr;
+    }
+    session->adoptUpgradeRequest(request);
+    return session;
+}
+
+void HttpHandler::handleHttp2Request(HttpRequest& request, HttpResponse& response) {
+    if (proxyHandler_ && proxyHandler_->matches(request.path)) {
+        fetchProxied(request, response);
+        return;
+    }
+    
+    // Corpo já recebido pela sessão: rotas com streaming o leem do mesmo BodyReader
+    BodyReader body(std::move(request.body));
+    request.body.clear();
+    request.bodyReader = &body;
+    dispatch(request, response);
+    request.bodyReader = nullptr;
+}
+
+void HttpHandler::fetchProxied(const HttpRequest& request, HttpResponse& response) {
+    // O repasse de corpo ao backend depende da conexão HTTP/1.1 do cliente
+    if (!request.body.empty()) {
+        setErrorResponse(response, 501, "Not Implemented");
+        return;
+    }
+    
+    std::string key;
+    std::shared_ptr<ResponseCache::Flight> flight;
+    if (responseCache_ && ResponseCache::isCacheableRequest(request)) {
+        key = ResponseCache::makeKey(request);
+        std::shared_ptr<const CachedResponse> cached;
+        CacheLookup state = responseCache_->lookup(key, request, cached);
+        
+        if (state == CacheLookup::Stale) {
+            responseCache_->revalidate(key, request);
+        }
+        
+        bool leader = true;
+        if (state == CacheLookup::Miss) {
+            flight = responseCache_->join(key, leader);
+            if (!leader) {
+                cached = responseCache_->wait(flight);
+                flight.reset();
+                if (cached && !cached->matchesRequest(request)) {
+                    cached.reset();
+                }
+            }
+        }
+        
+        if (cached) {
+            fillFromCache(*cached, state == CacheLookup::Stale ? "STALE" : "HIT", response);
+            return;
+        }
+    }
+    
+    ProxyCapture capture;
+    capture.maxBodyBytes = kMaxProxiedBodyBytes;
+    ProxyResult result = proxyHandler_->fetch(request, capture);
+    
+    if (flight) {
+        std::shared_ptr<const CachedResponse> entry;
+        if (capture.complete && capture.body.size() <= responseCacheConfig_.maxEntryBytes) {
+            entry = ResponseCache::makeEntry(request, capture.statusCode, capture.statusText,
+                                             capture.headers, capture.body);
+        }
+        responseCache_->complete(key, flight, std::move(entry));
+    }
+    
+    if (!capture.complete) {
+        setErrorResponse(response, result.statusCode ? result.statusCode : 502,
+                         result.statusCode ? result.statusText.c_str() : "Bad Gateway");
+        return;
+    }
+    
+    response.statusCode = capture.statusCode;
+    response.statusText = std::move(capture.statusText);
+    for (auto& header : capture.headers) {
+        response.headers[header.first] = std::move(header.second);
+    }
+    response.body = std::move(capture.body);
+}
+
+bool HttpHandler::handleProxyRequest(Connection& connection, const HttpRequest& request,
+                                     bool& keepAlive, HttpResponse& response, SocketDeadline& requestDeadline) {
+    ProxyResult result;
+    
+    if (responseCache_ && ResponseCache::isCacheableRequest(request)) {
+        std::string key = ResponseCache::makeKey(request);
+        std::shared_ptr<const CachedResponse> cached;
+        CacheLookup state = responseCache_->lookup(key, request, cached);
+        
+        if (state == CacheLookup::Stale) {
+            responseCache_->revalidate(key, request);
+        }
+        
+        if (state == CacheLookup::Miss) {
+            // Só o líder busca no backend; as demais threads esperam pela mesma resposta
+            bool leader = false;
+            auto flight = responseCache_->join(key, leader);
+            if (leader) {
+                // A entrada é publicada ao fim da leitura do backend, antes do repasse a este cliente
+                bool published = false;
+                ProxyCapture capture;
+                capture.maxBodyBytes = responseCacheConfig_.maxEntryBytes;
+                capture.onReady = [&](ProxyCapture& ready) {
+                    published = true;
+                    std::shared_ptr<const CachedResponse> entry;
+                    if (ready.complete) {
+                        entry = ResponseCache::makeEntry(request, ready.statusCode, std::move(ready.statusText),
+                                                         std::move(ready.headers), std::move(ready.body));
+                    }
+                    responseCache_->complete(key, flight, std::move(entry));
+                };
+                result = proxyHandler_->forward(connection, request, keepAlive, requestDeadline, &capture);
+                if (!published) {
+                    responseCache_->complete(key, flight, nullptr);
+                }
+            } else {
+                cached = responseCache_->wait(flight);
+                if (!cached || !cached->matchesRequest(request)) {
+                    result = proxyHandler_->forward(connection, request, keepAlive, requestDeadline);
+                    cached.reset();
+                }
+            }
+        }
+        
+        if (cached) {
+            fillFromCache(*cached, state == CacheLookup::Stale ? "STALE" : "HIT", response);
+            return false;
+        }
+    } else {
+        result = proxyHandler_->forward(connection, request, keepAlive, requestDeadline);
+    }
+    
+    keepAlive = result.keepAlive;
+    response.statusCode = result.statusCode;
+    if (!result.responded) {
+        setErrorResponse(response, result.statusCode, result.statusText.c_str());
+    }
+    return result.responded;
+}
+
+void HttpHandler::fillFromCache(const CachedResponse& cached, const char* cacheStatus, HttpResponse& response) {
+    response.statusCode = cached.statusCode;
+    response.statusText = cached.statusText;
+    for (const auto& header : cached.headers) {
+        response.headers[header.first] = header.second;
+    }
+    response.headers["Age"] = std::to_string(cached.ageSeconds(CachedResponse::Clock::now()));
+    response.headers["X-Cache"] = cacheStatus;
+    response.sharedBody = cached.body;
+}
+
+KeepAliveConfig HttpHandler::keepAliveConfig() const {
+    return *std::atomic_load(&keepAliveConfig_);
+}
+
+void HttpHandler::reload(const HandlerConfig& config) {
+    std::atomic_store(&keepAliveConfig_, std::make_shared<const KeepAliveConfig>(config.keepAlive));
+    std::atomic_store(&requestBodyConfig_, std::make_shared<const RequestBodyConfig>(config.requestBody));
+    
+    compressionCache_.setCapacity(config.compression.cacheBytes);
+    mappedFiles_.setCapacity(config.mappedFiles.cacheBytes);
+    // O cache de respostas só é criado na inicialização; capacidade zero deixa de armazenar
+    if (responseCache_) {
+        responseCache_->setCapacity(config.responseCache.enabled ? config.responseCache.cacheBytes : 0);
+    }
+}
+
+HandlerStats HttpHandler::stats() const {
+    HandlerStats stats;
+    stats.indexedDocuments = documentIndex_.size();
+    stats.compressionCacheBytes = compressionCache_.sizeBytes();
+    stats.compressionCacheEntries = compressionCache_.entries();
+    stats.mappedBytes = mappedFiles_.mappedBytes();
+    stats.mappedFiles = mappedFiles_.entries();
+    if (responseCache_) {
+        stats.responseCacheBytes = responseCache_->sizeBytes();
+        stats.responseCacheEntries = responseCache_->entries();
+    }
+    stats.webSocketClients = webSockets_.clients();
+    stats.webSocketDropped = webSockets_.droppedMessages();
+    stats.clients = clientGuard_.stats();
+    stats.accessLogDropped = accessLog_.droppedRecords();
+    stats.rateLimit = rateLimiter_.stats();
+    stats.streaming = streamBuffers_.stats();
+    if (tls_) {
+        stats.tls = tls_->stats();
+    }
+    if (dispatchStats_) {
+        stats.dispatch = dispatchStats_();
+    }
+    return stats;
+}
+
+ClientGuard& HttpHandler::clientGuard() {
+    return clientGuard_;
+}
+
+void HttpHandler::addRoute(HttpMethod method, const std::string& pattern, RouteTrie::Handler handler,
+                           bool streamBody) {
+    routes_.add(method, pattern, std::move(handler), streamBody);
+    Logger::getInstance().info(std::string("Registered route ") + methodName(method) + " " + pattern);
+}
+
+WebSocketHub& HttpHandler::webSockets() {
+    return webSockets_;
+}
+
+void HttpHandler::setDispatchStatsSource(std::function<DispatchStats()> source) {
+    dispatchStats_ = std::move(source);
+}
+
+bool HttpHandler::tlsEnabled() const {
+    return tls_ != nullptr;
+}
+
+void HttpHandler::dispatch(HttpRequest& request, HttpResponse& response) {
+    uint32_t allowed = 0;
+    if (auto handler = BuiltinRouter::find(request.methodId, request.path, allowed)) {
+        handler(*this, request, response);
+        return;
+    }
+    
+    if (!routes_.empty()) {
+        RouteParams params;
+        uint32_t pluginAllowed = 0;
+        if (const auto* route = routes_.find(request.methodId, request.path, params, pluginAllowed)) {
+            BodyReader* body = request.bodyReader;
+            if (!route->streamBody && body && !body->readAll(request.body, std::atomic_load(&requestBodyConfig_)->maxBufferedBytes)) {
+                setBodyError(response, body->errorStatus());
+                return;
+            }
+            
+            route->handler(request, response, params);
+            
+            // Falha na leitura em streaming prevalece sobre uma resposta de sucesso
+            if (body && body->errorStatus() != 0 && response.statusCode < 400) {
+                setBodyError(response, body->errorStatus());
+            }
+            return;
+        }
+        allowed |= pluginAllowed;
+    }
+    
+    // Sem rota para o caminho: arquivos estáticos
+    if (allowed == 0 && request.methodId == HttpMethod::Get) {
+        handleGetRequest(request, response);
+        return;
+    }
+    
+    setErrorResponse(response, 405, "Method Not Allowed");
+    response.headers["Allow"] = allowed ? allowHeader(allowed) : "GET";
 }
 
 bool HttpHandler::parseRequest(const std::string& requestData, HttpRequest& request) {
@@ -88,6 +792,12 @@ bool HttpHandler::parseRequest(const std::string& requestData, HttpRequest& requ
     if (!(firstLine >> request.method >> request.path >> request.version)) {
         return false;
     }
+    request.methodId = parseMethod(request.method);
+    
+    // Normaliza uma única vez: decodifica, separa a query e bloqueia ".." fora da raiz
+    if (!normalizeRequestPath(request.path, request.query)) {
+        return false;
+    }
     
     // Parse headers
     while (std::getline(stream, line) && !line.empty() && line != "\r") {
@@ -122,25 +832,264 @@ bool HttpHandler::parseRequest(const std::string& requestData, HttpRequest& requ
 }
 
 void HttpHandler::handleGetRequest(const HttpRequest& request, HttpResponse& response) {
-    std::string filePath = documentRoot_ + request.path;
-    
-    if (request.path.back() == '/') {
-        filePath += "index.html";
-    }
+    auto entry = documentIndex_.resolve(request.path);
+    const std::string& filePath = entry->filePath;
     
-    if (fileExists(filePath)) {
-        response.body = readFile(filePath);
-        response.headers["Content-Type"] = getMimeType(filePath);
-        response.headers["Content-Length"] = std::to_string(response.body.length());
-    } else {
+    int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat fileStat;
+    if (fd < 0 || fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+        if (fd >= 0) {
+            close(fd);
+        }
         response.statusCode = 404;
         response.statusText = "Not Found";
         response.body = "<html><body><h1>404 Not Found</h1></body></html>";
         response.headers["Content-Type"] = "text/html";
+        return;
+    }
+    
+    auto file = std::make_unique<FileBody>(fd);
+    uint64_t fileSize = static_cast<uint64_t>(fileStat.st_size);
+    int64_t mtimeNs = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000LL + fileStat.st_mtim.tv_nsec;
+    std::string identityETag = entry->matches(fileStat.st_ino, fileSize, mtimeNs) ?
+                               entry->etag : makeETag(fileStat.st_ino, fileSize, mtimeNs);
+    file->mapping = mappedFiles_.acquire(filePath, fd, fileSize, fileStat.st_ino, mtimeNs);
+    
+    const char* mimeType = entry->mimeType;
+    response.headers["Content-Type"] = mimeType;
+    response.headers["Last-Modified"] = formatHttpDate(fileStat.st_mtime);
+    
+    bool compressible = compressionConfig_.enabled && entry->compressible;
+    if (compressible) {
+        // A representação varia com Accept-Encoding mesmo quando enviada sem compressão
+        response.headers["Vary"] = "Accept-Encoding";
+    }
+    
+    // Range só é atendido sobre a representação sem codificação
+    std::vector<ByteRange> ranges;
+    RangeResult rangeResult = RangeResult::None;
+    auto rangeIt = request.headers.find("range");
+    if (rangeIt != request.headers.end() && ifRangeMatches(request, identityETag, fileStat.st_mtime)) {
+        rangeResult = parseRangeHeader(rangeIt->second, fileSize, ranges);
+    }
+    
+    bool precompressed = false;
+    ContentEncoding encoding = ContentEncoding::Identity;
+    if (compressible && rangeResult == RangeResult::None) {
+        encoding = selectEncoding(request, filePath, fileSize, fileStat.st_mtime, precompressed);
+    }
+    
+    std::string etag = encoding == ContentEncoding::Identity ? identityETag :
+        makeETag(fileStat.st_ino, fileSize, mtimeNs, encoding == ContentEncoding::Brotli ? "-br" : "-gz");
+    response.headers["ETag"] = etag;
+    
+    if (isNotModified(request, etag, fileStat.st_mtime)) {
+        response.statusCode = 304;
+        response.statusText = "Not Modified";
+        response.headers.erase("Content-Type");
+        return;
+    }
+    
+    if (encoding != ContentEncoding::Identity) {
+        if (loadEncodedVariant(filePath, encoding, precompressed, identityETag, fd, fileSize, response)) {
+            response.headers["Content-Encoding"] = contentEncodingName(encoding);
+            return;
+        }
+        // Falha ao comprimir: segue com o arquivo original
+        response.headers["ETag"] = identityETag;
+    }
+    
+    response.headers["Accept-Ranges"] = "bytes";
+    
+    if (rangeResult == RangeResult::Unsatisfiable) {
+        response.statusCode = 416;
+        response.statusText = "Range Not Satisfiable";
+        response.body = "<html><body><h1>416 Range Not Satisfiable</h1></body></html>";
+        response.headers["Content-Type"] = "text/html";
+        response.headers["Content-Range"] = "bytes */" + std::to_string(fileSize);
+        return;
+    }
+    
+    auto contentRange = [fileSize](const ByteRange& range) {
+        return "bytes " + std::to_string(range.offset) + "-" +
+               std::to_string(range.offset + range.length - 1) + "/" + std::to_string(fileSize);
+    };
+    
+    if (rangeResult == RangeResult::Satisfiable && ranges.size() == 1) {
+        response.statusCode = 206;
+        response.statusText = "Partial Content";
+        response.headers["Content-Range"] = contentRange(ranges[0]);
+        file->segments.push_back({"", ranges[0].offset, ranges[0].length});
+    } else if (rangeResult == RangeResult::Satisfiable) {
+        std::string boundary = "cs-" + identityETag.substr(1, identityETag.size() - 2);
+        response.statusCode = 206;
+        response.statusText = "Partial Content";
+        response.headers["Content-Type"] = "multipart/byteranges; boundary=" + boundary;
+        
+        for (const auto& range : ranges) {
+            file->segments.push_back({"\r\n--" + boundary + "\r\nContent-Type: " + mimeType +
+                                      "\r\nContent-Range: " + contentRange(range) + "\r\n\r\n",
+                                      range.offset, range.length});
+        }
+        file->trailer = "\r\n--" + boundary + "--\r\n";
+    } else {
+        file->segments.push_back({"", 0, fileSize});
+    }
+    
+    response.file = std::move(file);
+}
+
+bool HttpHandler::isNotModified(const HttpRequest& request, const std::string& etag, time_t modified) {
+    // If-None-Match tem precedência sobre If-Modified-Since (RFC 7232, seção 6)
+    auto noneMatchIt = request.headers.find("if-none-match");
+    if (noneMatchIt != request.headers.end()) {
+        return etagListMatches(noneMatchIt->second, etag);
+    }
+    
+    auto modifiedSinceIt = request.headers.find("if-modified-since");
+    time_t since;
+    if (modifiedSinceIt != request.headers.end() && parseHttpDate(modifiedSinceIt->second, since)) {
+        return modified <= since;
     }
+    
+    return false;
+}
+
+bool HttpHandler::ifRangeMatches(const HttpRequest& request, const std::string& etag, time_t modified) {
+    auto ifRangeIt = request.headers.find("if-range");
+    if (ifRangeIt == request.headers.end()) {
+        return true;
+    }
+    
+    const std::string& value = ifRangeIt->second;
+    if (!value.empty() && value[0] == '"') {
+        return value == etag; // Comparação forte
+    }
+    
+    time_t date;
+    return parseHttpDate(value, date) && modified <= date;
+}
+
+ContentEncoding HttpHandler::selectEncoding(const HttpRequest& request, const std::string& filePath,
+                                            uint64_t fileSize, time_t modified, bool& precompressed) {
+    precompressed = false;
+    
+    auto acceptIt = request.headers.find("accept-encoding");
+    if (acceptIt == request.headers.end()) {
+        return ContentEncoding::Identity;
+    }
+    
+    // Variantes pré-comprimidas (arquivo.br / arquivo.gz) só valem se não forem mais antigas que o original
+    auto hasSibling = [&](ContentEncoding encoding) {
+        struct stat siblingStat;
+        std::string sibling = filePath + contentEncodingExtension(encoding);
+        return stat(sibling.c_str(), &siblingStat) == 0 && S_ISREG(siblingStat.st_mode) &&
+               siblingStat.st_mtime >= modified;
+    };
+    
+    bool brotliSibling = hasSibling(ContentEncoding::Brotli);
+    bool gzipSibling = hasSibling(ContentEncoding::Gzip);
+    bool compressOnTheFly = fileSize >= compressionConfig_.minFileSize &&
+                            fileSize <= compressionConfig_.maxFileSize;
+    
+    ContentEncoding encoding = negotiateEncoding(acceptIt->second,
+        brotliSibling || (compressOnTheFly && isEncodingSupported(ContentEncoding::Brotli)),
+        gzipSibling || (compressOnTheFly && isEncodingSupported(ContentEncoding::Gzip)));
+    
+    precompressed = (encoding == ContentEncoding::Brotli && brotliSibling) ||
+                    (encoding == ContentEncoding::Gzip && gzipSibling);
+    return encoding;
 }
 
-void HttpHandler::sendResponse(SOCKET clientSocket, const HttpResponse& response, bool keepAlive) {
+bool HttpHandler::loadEncodedVariant(const std::string& filePath, ContentEncoding encoding, bool precompressed,
+                                     const std::string& etag, int fd, uint64_t size, HttpResponse& response) {
+    if (precompressed) {
+        std::string siblingPath = filePath + contentEncodingExtension(encoding);
+        int siblingFd = open(siblingPath.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat siblingStat;
+        if (siblingFd < 0 || fstat(siblingFd, &siblingStat) != 0) {
+            if (siblingFd >= 0) {
+                close(siblingFd);
+            }
+            return false;
+        }
+        
+        auto sibling = std::make_unique<FileBody>(siblingFd);
+        uint64_t siblingSize = static_cast<uint64_t>(siblingStat.st_size);
+        int64_t siblingMtime = static_cast<int64_t>(siblingStat.st_mtim.tv_sec) * 1000000000LL +
+                               siblingStat.st_mtim.tv_nsec;
+        sibling->mapping = mappedFiles_.acquire(siblingPath, siblingFd, siblingSize, siblingStat.st_ino, siblingMtime);
+        sibling->segments.push_back({"", 0, siblingSize});
+        response.file = std::move(sibling);
+        return true;
+    }
+    
+    auto cached = compressionCache_.get(filePath, etag, encoding);
+    
+    if (!cached) {
+        // Só o líder comprime; as demais threads que pedem a mesma variante esperam pelo resultado
+        bool leader = false;
+        auto flight = compressionCache_.join(filePath, etag, encoding, leader);
+        if (!leader) {
+            cached = compressionCache_.wait(flight);
+            if (!cached) {
+                return false;
+            }
+            response.sharedBody = std::move(cached);
+            return true;
+        }
+        
+        struct Publish {
+            CompressionCache& cache;
+            const std::string& path;
+            const std::string& etag;
+            ContentEncoding encoding;
+            std::shared_ptr<CompressionCache::Flight> flight;
+            std::shared_ptr<const std::string> content;
+            ~Publish() {
+                cache.complete(path, etag, encoding, flight, std::move(content));
+            }
+        } publish{compressionCache_, filePath, etag, encoding, std::move(flight), nullptr};
+        
+        // Publicada por outro líder entre a consulta e o join
+        cached = compressionCache_.get(filePath, etag, encoding);
+        if (!cached) {
+            // O arquivo é lido para a memória mesmo quando mapeado (o compressor tocaria as páginas em
+            // espaço de usuário: SIGBUS se o arquivo for truncado), e só se couber no limite global;
+            // senão a resposta sai sem compressão
+            auto compressed = std::make_shared<std::string>();
+            StreamBufferReservation reservation(streamBuffers_, static_cast<size_t>(size), std::chrono::milliseconds(0));
+            std::string content;
+            if (!reservation || !readFile(fd, size, content) ||
+                !compressContent(content.data(), content.size(), encoding, compressionConfig_, *compressed)) {
+                return false;
+            }
+            cached = compressed;
+        }
+        publish.content = cached;
+    }
+    
+    response.sharedBody = std::move(cached);
+    return true;
+}
+
+void HttpHandler::logAccess(const Connection& connection, const HttpRequest& request, const HttpResponse& response,
+                            std::chrono::system_clock::time_point start, uint64_t bytesSent,
+                            uint32_t headerUs, uint32_t handlerUs, uint32_t sendUs, uint8_t flags) {
+    AccessRecord record;
+    record.timestampUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count());
+    record.bytesSent = bytesSent;
+    record.headerUs = headerUs;
+    record.handlerUs = handlerUs;
+    record.sendUs = sendUs;
+    record.status = static_cast<uint16_t>(response.statusCode);
+    record.method = static_cast<uint8_t>(request.methodId);
+    record.flags = flags;
+    accessLog_.record(record, request.path, connection.peerAddress);
+}
+
+uint64_t HttpHandler::sendResponse(SOCKET clientSocket, const HttpResponse& response, bool keepAlive) {
     std::ostringstream responseStream;
     
     responseStream << "HTTP/1.1 " << response.statusCode << " " << response.statusText << "\r\n";
@@ -150,74 +1099,192 @@ void HttpHandler::sendResponse(SOCKET clientSocket, const HttpResponse& response
         responseStream << header.first << ": " << header.second << "\r\n";
     }
     
-    // Adicionar Content-Length
-    responseStream << "Content-Length: " << response.body.length() << "\r\n";
+    // Adicionar Content-Length (304 não carrega corpo nem repete o tamanho);
+    // corpo gerado aos poucos segue em chunked
+    if (response.stream) {
+        responseStream << "Transfer-Encoding: chunked\r\n";
+    } else if (response.statusCode != 304 && response.statusCode != 101) {
+        uint64_t contentLength = response.body.length() +
+                                 (response.sharedBody ? response.sharedBody->length() : 0) +
+                                 (response.file ? response.file->contentLength() : 0);
+        responseStream << "Content-Length: " << contentLength << "\r\n";
+    }
     
-    // Adicionar Connection header
-    if (keepAlive) {
-        responseStream << "Connection: keep-alive\r\n";
-        responseStream << "Keep-Alive: timeout=" << keepAliveConfig_.timeoutSeconds 
-                      << ", max=" << keepAliveConfig_.maxRequests << "\r\n";
-    } else {
-        responseStream << "Connection: close\r\n";
+    // Adicionar Connection header (no 101 ele já vem nos headers do upgrade)
+    if (response.statusCode != 101) {
+        if (keepAlive) {
+            responseStream << "Connection: keep-alive\r\n";
+            auto keepAliveConfig = std::atomic_load(&keepAliveConfig_);
+            responseStream << "Keep-Alive: timeout=" << keepAliveConfig->timeoutSeconds 
+                          << ", max=" << keepAliveConfig->maxRequests << "\r\n";
+        } else {
+            responseStream << "Connection: close\r\n";
+        }
     }
     
-    responseStream << "\r\n" << response.body;
+    responseStream << "\r\n";
+    if (!response.stream) {
+        responseStream << response.body;
+    }
     
     std::string responseStr = responseStream.str();
-    send(clientSocket, responseStr.c_str(), responseStr.length(), 0);
-}
-
-std::string HttpHandler::getMimeType(const std::string& filename) {
-    auto pos = filename.find_last_of('.');
-    if (pos == std::string::npos) {
-        return "application/octet-stream";
+    
+    // Headers, corpo compartilhado e trechos mapeados saem juntos em um único writev;
+    // trechos sem mapeamento interrompem o vetor para um sendfile
+    std::vector<iovec> pending;
+    auto append = [&pending](const char* data, size_t length) {
+        if (length > 0) {
+            pending.push_back({const_cast<char*>(data), length});
+        }
+    };
+    
+    append(responseStr.data(), responseStr.length());
+    
+    // Mais de uma escrita (writev + sendfile, chunks): o cork evita um segmento parcial por escrita
+    struct Cork {
+        SOCKET socket;
+        bool active;
+        ~Cork() {
+            if (active) {
+                setCork(socket, false);
+            }
+        }
+    } cork{clientSocket, corkResponses_ && (response.stream || (response.file && !response.file->mapping))};
+    if (cork.active) {
+        setCork(clientSocket, true);
     }
     
-    std::string extension = filename.substr(pos + 1);
+    // Corpo em janelas com prazo próprio: o que conta é o progresso, não a duração total
+    const StreamingConfig& streaming = streamBuffers_.config();
+    std::chrono::milliseconds stall = streamBuffers_.stallTimeout();
+    
+    uint64_t sent = 0;
+    auto flush = [&]() {
+        for (const auto& part : pending) {
+            sent += part.iov_len;
+        }
+        bool ok = sendVectoredWindowed(timers_, clientSocket, pending, streaming.windowBytes, stall);
+        pending.clear();
+        return ok;
+    };
+    if (response.sharedBody) {
+        append(response.sharedBody->data(), response.sharedBody->length());
+    }
+    
+    if (response.file) {
+        const FileBody& file = *response.file;
+        for (const auto& segment : file.segments) {
+            append(segment.prefix.data(), segment.prefix.length());
+            
+            if (file.mapping) {
+                append(file.mapping->data() + segment.offset, segment.length);
+                continue;
+            }
+            
+            if (!flush() || !sendFileWindowed(timers_, clientSocket, file.fd, segment.offset, segment.length,
+                                              streaming.windowBytes, stall)) {
+                return sent;
+            }
+            sent += segment.length;
+        }
+        append(file.trailer.data(), file.trailer.length());
+    }
     
-    if (extension == "html" || extension == "htm") return "text/html";
-    if (extension == "txt") return "text/plain";
+    if (!flush() || !response.stream) {
+        return sent;
+    }
     
-    return "application/octet-stream";
+    // Cada bloco vira um chunk (tamanho, dados e CRLF em um único writev), começando por `body`;
+    // o gerador retorna false no último bloco. Um bloco por vez em memória, contabilizado no limite
+    // global: com ele atingido, o gerador só volta a ser chamado quando outra conexão liberar espaço
+    std::string chunk = response.body;
+    bool more = true;
+    while (more || !chunk.empty()) {
+        if (chunk.empty()) {
+            more = response.stream(chunk);
+        }
+        if (chunk.empty()) {
+            continue;
+        }
+        
+        StreamBufferReservation reservation(streamBuffers_, chunk.size(), stall);
+        if (!reservation) {
+            return sent;
+        }
+        char sizeLine[24];
+        int sizeLength = snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", chunk.size());
+        std::vector<iovec> parts = {
+            {sizeLine, static_cast<size_t>(sizeLength)},
+            {&chunk[0], chunk.size()},
+            {const_cast<char*>("\r\n"), 2},
+        };
+        if (!sendVectoredWindowed(timers_, clientSocket, parts, streaming.windowBytes, stall)) {
+            return sent;
+        }
+        sent += static_cast<uint64_t>(sizeLength) + chunk.size() + 2;
+        chunk.clear();
+    }
+    if (sendAll(clientSocket, "0\r\n\r\n", 5)) {
+        sent += 5;
+    }
+    return sent;
 }
 
-std::string HttpHandler::readFile(const std::string& filepath) {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        return "";
+bool HttpHandler::readFile(int fd, uint64_t size, std::string& content) {
+    content.resize(static_cast<size_t>(size));
+    uint64_t offset = 0;
+    while (offset < size) {
+        ssize_t got = pread(fd, &content[offset], static_cast<size_t>(size - offset), static_cast<off_t>(offset));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        offset += static_cast<uint64_t>(got);
     }
-    
-    std::ostringstream content;
-    content << file.rdbuf();
-    return content.str();
+    return true;
 }
 
-bool HttpHandler::fileExists(const std::string& filepath) {
-    return std::filesystem::exists(filepath) && std::filesystem::is_regular_file(filepath);
+void HttpHandler::rejectHeaders(Connection& connection) {
+    clientGuard_.countHeaderRejection();
+    HttpResponse response;
+    setErrorResponse(response, 431, "Request Header Fields Too Large");
+    sendResponse(connection.socket, response, false);
+    LOG_LIMITED(Logger::Level::WARNING, 1, 10, "Rejected oversized request headers from {}", connection.peerAddress);
 }
 
-bool HttpHandler::receiveRequestWithTimeout(SOCKET clientSocket, std::string& requestData) {
-#ifdef _WIN32
-    // Configurar timeout no Windows
-    DWORD timeout = keepAliveConfig_.timeoutSeconds * 1000;
-    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-#else
-    // Configurar timeout no Linux
-    struct timeval timeout;
-    timeout.tv_sec = keepAliveConfig_.timeoutSeconds;
-    timeout.tv_usec = 0;
-    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-#endif
+bool HttpHandler::receiveRequestWithTimeout(Connection& connection, std::string& requestData) {
+    SocketDeadline headerDeadline(timers_, connection.socket,
+                                  std::atomic_load(&keepAliveConfig_)->headerTimeoutSeconds);
     
-    char buffer[4096];
-    int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+    const ClientLimitsConfig& limits = clientGuard_.config();
+    size_t headerEnd;
+    while ((headerEnd = connection.readBuffer.find("\r\n\r\n")) == std::string::npos) {
+        if (connection.readBuffer.size() > limits.maxHeaderBytes) {
+            rejectHeaders(connection);
+            return false;
+        }
+        
+        char buffer[4096];
+        long bytesReceived = connection.receive(buffer, sizeof(buffer));
+        
+        if (bytesReceived <= 0) {
+            return false; // Timeout ou erro
+        }
+        
+        connection.readBuffer.append(buffer, static_cast<size_t>(bytesReceived));
+    }
     
-    if (bytesReceived <= 0) {
-        return false; // Timeout ou erro
+    // Linhas de header além da linha de requisição
+    size_t headerLines = static_cast<size_t>(std::count(connection.readBuffer.begin(),
+                                                        connection.readBuffer.begin() + headerEnd, '\n'));
+    if (headerEnd > limits.maxHeaderBytes || headerLines > limits.maxHeaderCount) {
+        rejectHeaders(connection);
+        return false;
     }
     
-    buffer[bytesReceived] = '\0';
-    requestData = std::string(buffer);
+    requestData = connection.readBuffer.substr(0, headerEnd + 4);
+    connection.readBuffer.erase(0, headerEnd + 4);
     return true;
 }
@@ -1,41 +1,110 @@
 #include "http_server.h"
 #include "thread_pool.h"
-#include "connection_queue.h"
+#include "worker_dispatcher.h"
+#include "request_lanes.h"
 #include "http_handler.h"
+#include "event_loop.h"
 #include "logger.h"
 #include <stdexcept>
+#include <algorithm>
 #include <iostream>
 
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    #pragma comment(lib, "ws2_32.lib")
-#else
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <unistd.h>
-    #define closesocket close
-    #define INVALID_SOCKET -1
-    #define SOCKET int
-#endif
-
-HttpServer::HttpServer(int port, size_t numThreads, size_t maxConnections, const std::string& documentRoot)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <cerrno>
+#include <cstring>
+#define INVALID_SOCKET -1
+
+namespace {
+
+// IPv4 aceito num socket dual-stack chega como ::ffff:a.b.c.d; volta à forma a.b.c.d para que
+// limites por IP e logs vejam o mesmo cliente igual em qualquer socket. Socket Unix não tem IP
+std::string formatPeerAddress(const sockaddr_storage& address) {
+    char text[INET6_ADDRSTRLEN] = {};
+    if (address.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(&address)->sin_addr, text, sizeof(text));
+    } else if (address.ss_family == AF_INET6) {
+        const in6_addr& v6 = reinterpret_cast<const sockaddr_in6*>(&address)->sin6_addr;
+        if (IN6_IS_ADDR_V4MAPPED(&v6)) {
+            inet_ntop(AF_INET, v6.s6_addr + 12, text, sizeof(text));
+        } else {
+            inet_ntop(AF_INET6, &v6, text, sizeof(text));
+        }
+    }
+    return text;
+}
+
+// Caminho deixado por um processo que morreu é removido; um que ainda atende não
+void removeStaleUnixSocket(const std::string& path) {
+    struct stat status;
+    if (lstat(path.c_str(), &status) != 0) {
+        return;
+    }
+    if (!S_ISSOCK(status.st_mode)) {
+        throw std::runtime_error(path + " exists and is not a socket");
+    }
+    
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), std::min(path.size(), sizeof(address.sun_path) - 1));
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool alive = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    if (probe >= 0) {
+        close(probe);
+    }
+    if (alive) {
+        throw std::runtime_error("Unix socket " + path + " is already in use");
+    }
+    unlink(path.c_str());
+}
+
+} // namespace
+
+HttpServer::HttpServer(int port, size_t numThreads, size_t maxConnections, const std::string& documentRoot,
+                       const HandlerConfig& handlerConfig)
     : port_(port), 
       documentRoot_(documentRoot),
+      socketOptions_(handlerConfig.socket),
+      listenersReleased_(false),
+      wakeFd_(-1),
       running_(false),
-      stats_(std::make_shared<ServerStats>()),
+      workerTarget_(numThreads),
+      lanes_(handlerConfig.lanes.enabled() ? std::make_shared<RequestLanes>(handlerConfig.lanes) : nullptr),
       threadPool_(std::make_unique<ThreadPool>(numThreads)),
-      connectionQueue_(std::make_unique<ConnectionQueue>(maxConnections)),
-      httpHandler_(std::make_unique<HttpHandler>(documentRoot_)),
-      serverSocket_(INVALID_SOCKET) {
+      dispatcher_(std::make_unique<WorkerDispatcher>(handlerConfig.dispatch, maxConnections, numThreads, lanes_)),
+      stats_(std::make_shared<ServerStats>()) {
     
-#ifdef _WIN32
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2,2), &wsaData) != 0) {
-        throw std::runtime_error("Failed to initialize Winsock");
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        throw std::runtime_error("Failed to create eventfd");
     }
-#endif
+    
+    eventLoop_ = std::make_unique<EventLoop>(
+        std::chrono::seconds(handlerConfig.keepAlive.timeoutSeconds),
+        [this](std::unique_ptr<Connection> connection) {
+            // Conexão ociosa recebeu dados: volta para as threads trabalhadoras, na faixa da
+            // requisição que chegou
+            if (lanes_) {
+                lanes_->classify(*connection);
+            }
+            if (!dispatcher_->push(connection, std::chrono::milliseconds(0))) {
+                LOG_LIMITED(Logger::Level::WARNING, 1, 10, "Connection queue full, dropping keep-alive connection");
+                stats_->droppedConnections.fetch_add(1);
+            }
+        });
+    httpHandler_ = std::make_unique<HttpHandler>(documentRoot_, eventLoop_->timers(), handlerConfig);
+    httpHandler_->setDispatchStatsSource([this] { return dispatcher_->stats(); });
+    
+    ListenAddress defaultAddress;
+    defaultAddress.port = port_;
+    listeners_.push_back({defaultAddress, INVALID_SOCKET});
     
     Logger::getInstance().info("HTTP Server initialized on port " + std::to_string(port_) + 
                               " with " + std::to_string(numThreads) + " threads");
@@ -43,9 +112,116 @@ HttpServer::HttpServer(int port, size_t numThreads, size_t maxConnections, const
 
 HttpServer::~HttpServer() {
     stop();
-#ifdef _WIN32
-    WSACleanup();
-#endif
+    closeListeners();
+    close(wakeFd_);
+}
+
+void HttpServer::setListenAddresses(const std::vector<ListenAddress>& addresses) {
+    closeListeners();
+    listeners_.clear();
+    for (const auto& address : addresses) {
+        listeners_.push_back({address, INVALID_SOCKET});
+    }
+}
+
+void HttpServer::adoptListeners(const std::vector<SOCKET>& sockets) {
+    for (SOCKET socket : sockets) {
+        auto it = std::find_if(listeners_.begin(), listeners_.end(), [socket](const Listener& listener) {
+            return listener.socket == INVALID_SOCKET && listener.address.matches(socket);
+        });
+        if (it == listeners_.end()) {
+            // Endereço que saiu da configuração: o processo anterior o fecha ao terminar
+            close(socket);
+            Logger::getInstance().info("Closing inherited listening socket not in the current configuration");
+            continue;
+        }
+        
+        it->socket = socket;
+        // Não bloqueante: com o processo anterior ainda aceitando, o poll pode acordar sem conexão
+        fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+        if (!it->address.isUnix()) {
+            applyListeningOptions(socket, socketOptions_);
+        }
+        Logger::getInstance().info("Adopted inherited listening socket for " + it->address.toString());
+    }
+}
+
+std::vector<SOCKET> HttpServer::listenerSockets() const {
+    std::vector<SOCKET> sockets;
+    for (const auto& listener : listeners_) {
+        if (listener.socket != INVALID_SOCKET) {
+            sockets.push_back(listener.socket);
+        }
+    }
+    return sockets;
+}
+
+void HttpServer::releaseListeners() {
+    listenersReleased_ = true;
+}
+
+void HttpServer::openListeners() {
+    int backlog = socketOptions_.backlog > 0 ? socketOptions_.backlog : SOMAXCONN;
+    
+    for (auto& listener : listeners_) {
+        if (listener.socket != INVALID_SOCKET) {
+            continue;
+        }
+        const ListenAddress& address = listener.address;
+        sockaddr_storage storage;
+        socklen_t length = address.toSockaddr(storage);
+        if (length == 0) {
+            throw std::runtime_error("Invalid listen address " + address.toString());
+        }
+        if (address.isUnix()) {
+            removeStaleUnixSocket(address.path);
+        }
+        
+        SOCKET fd = socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == INVALID_SOCKET) {
+            throw std::runtime_error("Failed to create socket for " + address.toString());
+        }
+        
+        if (!address.isUnix()) {
+            int reuse = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, 
+                      reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+            if (address.family == ListenAddress::Family::IPv6) {
+                int v6Only = address.v6Only ? 1 : 0;
+                setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6Only, sizeof(v6Only));
+            }
+            applyListenerOptions(fd, socketOptions_);
+        }
+        
+        if (bind(fd, reinterpret_cast<sockaddr*>(&storage), length) < 0) {
+            std::string error = strerror(errno);
+            close(fd);
+            throw std::runtime_error("Failed to bind socket to " + address.toString() + ": " + error);
+        }
+        
+        if (listen(fd, backlog) < 0) {
+            close(fd);
+            throw std::runtime_error("Failed to listen on " + address.toString());
+        }
+        
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        listener.socket = fd;
+    }
+}
+
+// Chamado com acceptMutex_ travado (ou sem laço de aceitação em curso)
+void HttpServer::closeListeners() {
+    for (auto& listener : listeners_) {
+        if (listener.socket == INVALID_SOCKET) {
+            continue;
+        }
+        close(listener.socket);
+        listener.socket = INVALID_SOCKET;
+        // Entregue na troca de binário, o caminho agora pertence ao processo novo
+        if (listener.address.isUnix() && !listenersReleased_) {
+            unlink(listener.address.path.c_str());
+        }
+    }
 }
 
 bool HttpServer::start() {
@@ -54,54 +230,75 @@ bool HttpServer::start() {
         return false;
     }
     
-    serverSocket_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket_ == INVALID_SOCKET) {
-        throw std::runtime_error("Failed to create socket");
-    }
-    
-    int reuse = 1;
-    setsockopt(serverSocket_, SOL_SOCKET, SO_REUSEADDR, 
-              reinterpret_cast<const char*>(&reuse), sizeof(reuse));
-    
-    sockaddr_in serverAddr{};
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port_);
-    
-    if (bind(serverSocket_, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
-        closesocket(serverSocket_);
-        throw std::runtime_error("Failed to bind socket to port " + std::to_string(port_));
+    for (const auto& listener : listeners_) {
+        if (listener.address.tls && !httpHandler_->tlsEnabled()) {
+            throw std::runtime_error("TLS listener " + listener.address.toString() + " requires a certificate");
+        }
     }
+    openListeners();
+    running_.store(true);
     
-    if (listen(serverSocket_, SOMAXCONN) < 0) {
-        closesocket(serverSocket_);
-        throw std::runtime_error("Failed to listen on socket");
+    std::string addresses;
+    for (const auto& listener : listeners_) {
+        addresses += (addresses.empty() ? "" : ", ") + listener.address.toString();
     }
+    Logger::getInstance().info("Server started and listening on " + addresses);
     
-    running_.store(true);
-    Logger::getInstance().info("Server started and listening on port " + std::to_string(port_));
-    
+    eventLoop_->start();
     startWorkers();
     acceptConnections();
     return true;
 }
 
-void HttpServer::stop() {
-    if (!running_.load()) {
+void HttpServer::stop(std::chrono::milliseconds drainTimeout) {
+    if (!running_.exchange(false)) {
         return;
     }
     
-    Logger::getInstance().info("Stopping server...");
-    running_.store(false);
+    Logger::getInstance().info("Stopping server, draining connections for up to " +
+                              std::to_string(drainTimeout.count()) + "ms...");
+    wakeAcceptor();
     
-    if (serverSocket_ != INVALID_SOCKET) {
-        closesocket(serverSocket_);
-        serverSocket_ = INVALID_SOCKET;
+    {
+        // Só fecha os sockets depois que o laço de aceitação saiu do poll
+        std::lock_guard<std::mutex> lock(acceptMutex_);
+        closeListeners();
     }
     
-    connectionQueue_->shutdown();
+    auto drainStart = std::chrono::steady_clock::now();
+    httpHandler_->beginDrain();
+    size_t idleClosed = eventLoop_->closeIdle();
+    size_t pending = httpHandler_->activeConnections() + dispatcher_->size();
+    
+    // As threads trabalhadoras continuam esvaziando a fila enquanto ela não estiver vazia
+    while (httpHandler_->activeConnections() > 0 || !dispatcher_->empty()) {
+        if (std::chrono::steady_clock::now() - drainStart >= drainTimeout) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    size_t dropped = dispatcher_->clear();
+    size_t cut = httpHandler_->cutConnections();
+    
+    dispatcher_->shutdown();
     threadPool_.reset();
+    eventLoop_->stop();
+    
+    size_t completed = pending - std::min(pending, cut + dropped);
+    stats_->drainIdleClosed.store(idleClosed);
+    stats_->drainCompleted.store(completed);
+    stats_->drainCut.store(cut);
+    stats_->drainQueuedDropped.store(dropped);
     
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - drainStart);
+    std::string summary = "Drain finished in " + std::to_string(elapsed.count()) + "ms: " +
+                          std::to_string(idleClosed) + " idle closed, " + std::to_string(completed) + " completed, " +
+                          std::to_string(cut) + " cut at deadline, " + std::to_string(dropped) + " queued dropped";
+    if (cut + dropped > 0) {
+        Logger::getInstance().warning(summary);
+    } else {
+        Logger::getInstance().info(summary);
+    }
     Logger::getInstance().info("Server stopped");
 }
 
@@ -109,10 +306,23 @@ bool HttpServer::isRunning() const {
     return running_.load();
 }
 
+void HttpServer::reload(size_t numThreads, const HandlerConfig& handlerConfig) {
+    setWorkerThreads(numThreads);
+    eventLoop_->setIdleTimeout(std::chrono::seconds(handlerConfig.keepAlive.timeoutSeconds));
+    httpHandler_->reload(handlerConfig);
+    
+    Logger::getInstance().info("Configuration reloaded: " + std::to_string(numThreads) + " worker threads, " +
+                              "keep-alive timeout " + std::to_string(handlerConfig.keepAlive.timeoutSeconds) + "s");
+}
+
 const ServerStats& HttpServer::getStats() const {
     return *stats_;
 }
 
+HttpHandler& HttpServer::handler() {
+    return *httpHandler_;
+}
+
 void HttpServer::printStats() const {
     std::cout << "=== Estatísticas do Servidor ===" << std::endl;
     std::cout << "Conexões totais: " << stats_->totalConnections.load() << std::endl;
@@ -125,66 +335,193 @@ void HttpServer::printStats() const {
     if (total > 0) {
         std::cout << "Taxa de sucesso: " << (100.0 * stats_->successfulRequests.load() / total) << "%" << std::endl;
     }
+    
+    DispatchStats dispatch = dispatcher_->stats();
+    std::cout << "Distribuição (" << WorkerDispatcher::policyName(dispatch.policy) << "): desequilíbrio "
+              << dispatch.imbalance << ", " << dispatch.rerouted << " redirecionadas" << std::endl;
 }
 
 void HttpServer::startWorkers() {
     size_t numThreads = threadPool_->size();
     
-    for (size_t i = 0; i < numThreads; ++i) {
-        threadPool_->enqueue([this]() {
-            workerLoop();
-        });
+    workerTarget_.store(numThreads);
+    dispatcher_->setWorkers(numThreads);
+    spawnWorkers();
+    
+    Logger::getInstance().info("Started " + std::to_string(numThreads) + " worker threads, " +
+                              WorkerDispatcher::policyName(dispatcher_->stats().policy) + " dispatch");
+}
+
+void HttpServer::setWorkerThreads(size_t numThreads) {
+    numThreads = std::min(std::max<size_t>(1, numThreads), WorkerDispatcher::kMaxWorkers);
+    workerTarget_.store(numThreads);
+    threadPool_->resize(numThreads);
+    // Antes de sobrar laços: as conexões novas já não vão para as filas que vão sair
+    dispatcher_->setWorkers(numThreads);
+    if (!running_.load()) {
+        return;
     }
     
-    Logger::getInstance().info("Started " + std::to_string(numThreads) + " worker threads");
+    // Sobrando, os laços saem sozinhos em retireWorker(); faltando, novos laços entram no pool
+    spawnWorkers();
+}
+
+// Um laço por índice abaixo do alvo; o índice liga a thread à sua fila no dispatcher
+void HttpServer::spawnWorkers() {
+    std::lock_guard<std::mutex> lock(workersMutex_);
+    size_t target = workerTarget_.load();
+    if (workerRunning_.size() < target) {
+        workerRunning_.resize(target, false);
+    }
+    for (size_t index = 0; index < target; ++index) {
+        if (workerRunning_[index]) {
+            continue;
+        }
+        workerRunning_[index] = true;
+        dispatcher_->activate(index);
+        threadPool_->enqueue([this, index]() {
+            workerLoop(index);
+        });
+    }
+}
+
+bool HttpServer::retireWorker(size_t index) {
+    if (index < workerTarget_.load()) {
+        return false;
+    }
+    // Sob o lock: spawnWorkers não pode reativar o índice no meio da saída
+    std::lock_guard<std::mutex> lock(workersMutex_);
+    if (index < workerTarget_.load()) {
+        return false;
+    }
+    workerRunning_[index] = false;
+    size_t dropped = dispatcher_->retire(index);
+    if (dropped > 0) {
+        stats_->droppedConnections.fetch_add(dropped);
+    }
+    return true;
+}
+
+void HttpServer::wakeAcceptor() {
+    uint64_t value = 1;
+    ssize_t written = write(wakeFd_, &value, sizeof(value));
+    (void)written;
 }
 
 void HttpServer::acceptConnections() {
+    std::lock_guard<std::mutex> acceptLock(acceptMutex_);
+    // Todos os sockets de escuta alimentam a mesma fila; o último pollfd é o de despertar
+    std::vector<pollfd> fds;
+    for (const auto& listener : listeners_) {
+        fds.push_back({listener.socket, POLLIN, 0});
+    }
+    fds.push_back({wakeFd_, POLLIN, 0});
+    
     while (running_.load()) {
-        sockaddr_in clientAddr{};
-        socklen_t clientAddrLen = sizeof(clientAddr);
-        
-        SOCKET clientSocket = accept(serverSocket_, 
-                                   reinterpret_cast<sockaddr*>(&clientAddr), 
-                                   &clientAddrLen);
-        
-        if (clientSocket == INVALID_SOCKET) {
-            if (running_.load()) {
-                Logger::getInstance().error("Failed to accept connection");
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno != EINTR) {
+                Logger::getInstance().error("Failed to poll listening sockets");
+                break;
             }
             continue;
         }
         
-        stats_->totalConnections.fetch_add(1);
-        
-        std::string clientIP = inet_ntoa(clientAddr.sin_addr);
-        Logger::getInstance().debug("Accepted connection from " + clientIP);
-        
-        if (!connectionQueue_->push(clientSocket)) {
-            Logger::getInstance().warning("Connection queue full, dropping connection from " + clientIP);
-            closesocket(clientSocket);
-            stats_->droppedConnections.fetch_add(1);
+        for (size_t i = 0; i < listeners_.size() && running_.load(); ++i) {
+            if (fds[i].revents & POLLIN) {
+                acceptFrom(listeners_[i]);
+            }
         }
     }
 }
 
-void HttpServer::workerLoop() {
-    while (running_.load() || !connectionQueue_->empty()) {
-        SOCKET clientSocket;
+void HttpServer::acceptFrom(const Listener& listener) {
+    sockaddr_storage clientAddr{};
+    socklen_t clientAddrLen = sizeof(clientAddr);
+    
+    // As threads trabalhadoras fazem I/O bloqueante com prazo (SocketDeadline), por isso a
+    // conexão não herda O_NONBLOCK; CLOEXEC evita vazá-la para processos filhos
+    SOCKET clientSocket = accept4(listener.socket,
+                                  reinterpret_cast<sockaddr*>(&clientAddr),
+                                  &clientAddrLen, SOCK_CLOEXEC);
+    
+    if (clientSocket == INVALID_SOCKET) {
+        // EAGAIN: a conexão foi aceita por outro processo que compartilha o socket
+        // EMFILE/ENFILE se repetem a cada volta enquanto faltar descritor
+        if (running_.load() && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED) {
+            LOG_LIMITED(Logger::Level::ERROR, 1, 5, "Failed to accept connection: {}", strerror(errno));
+        }
+        return;
+    }
+    
+    stats_->totalConnections.fetch_add(1);
+    // Opções TCP não existem em socket Unix
+    if (!listener.address.isUnix()) {
+        applyConnectionOptions(clientSocket, socketOptions_);
+    }
+    auto connection = std::make_unique<Connection>(clientSocket);
+    connection->tlsPending = listener.address.tls;
+    
+    // Sem IP (socket Unix) a conexão fica fora dos limites por IP: são processos locais
+    connection->peerAddress = formatPeerAddress(clientAddr);
+    std::string clientIP = connection->peerAddress.empty() ? listener.address.toString() : connection->peerAddress;
+    LOG_DEBUG("Accepted connection from {}", clientIP);
+    
+    if (!httpHandler_->clientGuard().admit(*connection)) {
+        // Resposta curta sem bloquear a aceitação; a conexão fecha ao sair do escopo. Antes do
+        // handshake TLS não há como responder em HTTP: só fecha
+        static const char kTooMany[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+                                       "Retry-After: 1\r\nConnection: close\r\n\r\n";
+        if (!connection->tlsPending) {
+            ssize_t sent = send(clientSocket, kTooMany, sizeof(kTooMany) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+            (void)sent;
+        }
+        // Amostra: sob ataque mostra a distribuição dos endereços, não só os primeiros
+        LOG_SAMPLED(Logger::Level::WARNING, 10, 5, "Too many connections from {}, rejecting", clientIP);
+        return;
+    }
+    
+    // Com regras por caminho ou header, a conexão espera a requisição no event loop em vez de
+    // entrar na fila sem faixa. Com TLS o que chega primeiro é o ClientHello: a thread faz o
+    // handshake e devolve a conexão ao event loop, que a classifica pela primeira requisição
+    if (lanes_ && !connection->tlsPending && !lanes_->classify(*connection)) {
+        eventLoop_->park(std::move(connection));
+        return;
+    }
+    
+    if (!dispatcher_->push(connection)) {
+        LOG_LIMITED(Logger::Level::WARNING, 1, 10, "Connection queue full, dropping connection from {}", clientIP);
+        stats_->droppedConnections.fetch_add(1);
+    }
+}
+
+void HttpServer::workerLoop(size_t index) {
+    while (running_.load() || !dispatcher_->empty(index)) {
+        if (running_.load() && retireWorker(index)) {
+            return;
+        }
+        
+        std::unique_ptr<Connection> connection;
         
-        if (connectionQueue_->pop(clientSocket, std::chrono::milliseconds(100))) {
+        if (dispatcher_->pop(index, connection, std::chrono::milliseconds(100))) {
             auto startTime = std::chrono::steady_clock::now();
+            uint8_t lane = connection->lane;
+            dispatcher_->begin(index);
+            bool keepAlive = false;
             
             try {
-                httpHandler_->handleConnection(clientSocket);
+                keepAlive = httpHandler_->handleConnection(*connection);
                 stats_->successfulRequests.fetch_add(1);
             } catch (const std::exception& e) {
-                Logger::getInstance().error("Error handling connection: " + std::string(e.what()));
+                LOG_LIMITED(Logger::Level::ERROR, 5, 20, "Error handling connection: {}", e.what());
                 stats_->failedRequests.fetch_add(1);
-                closesocket(clientSocket);
+            }
+            
+            if (keepAlive && running_.load()) {
+                eventLoop_->park(std::move(connection));
             }
             
             auto endTime = std::chrono::steady_clock::now();
+            dispatcher_->finish(index, lane, endTime - startTime);
             auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
             
             uint64_t oldAvg = stats_->averageResponseTime.load();
@@ -0,0 +1,397 @@
+#include "http_utils.h"
+#include <cstring>
+#include <cstdio>
+#include <cctype>
+#include <string_view>
+#include <algorithm>
+
+std::string formatHttpDate(time_t time) {
+    struct tm tmValue;
+    gmtime_r(&time, &tmValue);
+
+    char buffer[64];
+    size_t length = strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tmValue);
+    return std::string(buffer, length);
+}
+
+bool parseHttpDate(const std::string& value, time_t& time) {
+    static const char* const months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+
+    // Somente IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT"
+    char month[4] = {0};
+    struct tm tmValue{};
+    if (sscanf(value.c_str(), "%*3s, %2d %3s %4d %2d:%2d:%2d GMT",
+               &tmValue.tm_mday, month, &tmValue.tm_year,
+               &tmValue.tm_hour, &tmValue.tm_min, &tmValue.tm_sec) != 6) {
+        return false;
+    }
+
+    tmValue.tm_mon = -1;
+    for (int i = 0; i < 12; ++i) {
+        if (strcmp(month, months[i]) == 0) {
+            tmValue.tm_mon = i;
+            break;
+        }
+    }
+    if (tmValue.tm_mon < 0) {
+        return false;
+    }
+
+    tmValue.tm_year -= 1900;
+    time = timegm(&tmValue);
+    return time != static_cast<time_t>(-1);
+}
+
+std::string makeETag(uint64_t inode, uint64_t size, int64_t mtimeNs, const char* suffix) {
+    char buffer[96];
+    snprintf(buffer, sizeof(buffer), "\"%llx-%llx-%llx%s\"",
+             static_cast<unsigned long long>(inode),
+             static_cast<unsigned long long>(size),
+             static_cast<unsigned long long>(mtimeNs),
+             suffix);
+    return buffer;
+}
+
+bool etagListMatches(const std::string& headerValue, const std::string& etag) {
+    auto opaque = [](const std::string& tag, size_t start, size_t end) {
+        while (start < end && isspace(static_cast<unsigned char>(tag[start]))) start++;
+        while (end > start && isspace(static_cast<unsigned char>(tag[end - 1]))) end--;
+        if (end - start >= 2 && tag.compare(start, 2, "W/") == 0) start += 2;
+        return tag.substr(start, end - start);
+    };
+
+    std::string target = opaque(etag, 0, etag.size());
+
+    size_t start = 0;
+    while (start <= headerValue.size()) {
+        size_t end = headerValue.find(',', start);
+        if (end == std::string::npos) {
+            end = headerValue.size();
+        }
+
+        std::string candidate = opaque(headerValue, start, end);
+        if (candidate == "*" || candidate == target) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+RangeResult parseRangeHeader(const std::string& value, uint64_t fileSize,
+                             std::vector<ByteRange>& ranges, size_t maxRanges) {
+    ranges.clear();
+    if (value.compare(0, 6, "bytes=") != 0) {
+        return RangeResult::None;
+    }
+
+    size_t pos = 6;
+    size_t specs = 0;
+    while (pos <= value.size()) {
+        size_t end = value.find(',', pos);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+
+        std::string spec = value.substr(pos, end - pos);
+        pos = end + 1;
+
+        spec.erase(0, spec.find_first_not_of(" \t"));
+        spec.erase(spec.find_last_not_of(" \t") + 1);
+        if (spec.empty()) {
+            continue;
+        }
+
+        if (++specs > maxRanges) {
+            return RangeResult::None;
+        }
+
+        size_t dash = spec.find('-');
+        if (dash == std::string::npos) {
+            return RangeResult::None;
+        }
+
+        std::string firstStr = spec.substr(0, dash);
+        std::string lastStr = spec.substr(dash + 1);
+        auto numeric = [](const std::string& s) {
+            return !s.empty() && s.size() <= 19 && s.find_first_not_of("0123456789") == std::string::npos;
+        };
+
+        if (firstStr.empty()) {
+            // Sufixo: últimos N bytes
+            if (!numeric(lastStr)) {
+                return RangeResult::None;
+            }
+            uint64_t suffix = std::stoull(lastStr);
+            if (suffix == 0 || fileSize == 0) {
+                continue;
+            }
+            uint64_t length = suffix < fileSize ? suffix : fileSize;
+            ranges.push_back({fileSize - length, length});
+            continue;
+        }
+
+        if (!numeric(firstStr) || (!lastStr.empty() && !numeric(lastStr))) {
+            return RangeResult::None;
+        }
+
+        uint64_t first = std::stoull(firstStr);
+        uint64_t last = lastStr.empty() ? UINT64_MAX : std::stoull(lastStr);
+        if (last < first) {
+            return RangeResult::None;
+        }
+        if (first >= fileSize) {
+            continue;
+        }
+        if (last >= fileSize) {
+            last = fileSize - 1;
+        }
+        ranges.push_back({first, last - first + 1});
+    }
+
+    if (specs == 0) {
+        return RangeResult::None;
+    }
+    return ranges.empty() ? RangeResult::Unsatisfiable : RangeResult::Satisfiable;
+}
+
+bool containsToken(const std::string& value, const std::string& token) {
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+
+        size_t first = start;
+        size_t last = end;
+        while (first < last && (value[first] == ' ' || value[first] == '\t')) {
+            first++;
+        }
+        while (last > first && (value[last - 1] == ' ' || value[last - 1] == '\t')) {
+            last--;
+        }
+        if (last - first == token.size() &&
+            std::equal(token.begin(), token.end(), value.begin() + first,
+                       [](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); })) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+bool normalizeRequestPath(std::string& path, std::string& query) {
+    size_t queryPos = path.find('?');
+    if (queryPos != std::string::npos) {
+        query.assign(path, queryPos + 1, std::string::npos);
+        path.resize(queryPos);
+    }
+
+    size_t fragmentPos = path.find('#');
+    if (fragmentPos != std::string::npos) {
+        path.resize(fragmentPos);
+    }
+
+    if (path.empty() || path[0] != '/') {
+        return false;
+    }
+
+    auto hexValue = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    // Reescreve no próprio buffer: a saída nunca é maior que a entrada
+    size_t out = 0;
+    for (size_t in = 0; in < path.size(); ++in) {
+        char c = path[in];
+        if (c == '%' && in + 2 < path.size() && hexValue(path[in + 1]) >= 0 && hexValue(path[in + 2]) >= 0) {
+            c = static_cast<char>(hexValue(path[in + 1]) * 16 + hexValue(path[in + 2]));
+            in += 2;
+        }
+        if (c == '\0' || c == '\\') {
+            return false;
+        }
+
+        if (c == '/') {
+            // Colapsa barras repetidas
+            if (out > 0 && path[out - 1] == '/') {
+                continue;
+            }
+        }
+        path[out++] = c;
+
+        // Ao fechar um segmento, resolve "." e ".."
+        bool atSegmentEnd = (c == '/') || (in + 1 == path.size());
+        if (!atSegmentEnd) {
+            continue;
+        }
+
+        size_t end = (c == '/') ? out - 1 : out;
+        if (end == 0) {
+            continue; // Barra inicial: não fecha segmento nenhum
+        }
+        size_t start = path.rfind('/', end - 1) + 1;
+        std::string_view segment(path.data() + start, end - start);
+
+        if (segment == ".") {
+            out = start;
+        } else if (segment == "..") {
+            if (start <= 1) {
+                return false; // Tentativa de sair da raiz
+            }
+            out = path.rfind('/', start - 2) + 1;
+        }
+    }
+
+    path.resize(out);
+    return true;
+}
+
+std::string encodeRequestTarget(const std::string& path, const std::string& query) {
+    static const char kHex[] = "0123456789ABCDEF";
+    // pchar da RFC 3986 mais '/'; na query também '?' e o '%' que já veio escapado
+    auto allowed = [](unsigned char c, bool inQuery) {
+        return std::isalnum(c) || std::strchr("-._~!$&'()*+,;=:@/", c) ||
+               (inQuery && (c == '?' || c == '%'));
+    };
+
+    std::string target;
+    target.reserve(path.size() + query.size() + 1);
+    auto append = [&](const std::string& text, bool inQuery) {
+        for (char ch : text) {
+            unsigned char c = static_cast<unsigned char>(ch);
+            if (c != 0 && allowed(c, inQuery)) {
+                target.push_back(ch);
+            } else {
+                target.push_back('%');
+                target.push_back(kHex[c >> 4]);
+                target.push_back(kHex[c & 0x0f]);
+            }
+        }
+    };
+
+    append(path, false);
+    if (!query.empty()) {
+        target.push_back('?');
+        append(query, true);
+    }
+    return target;
+}
+
+size_t ChunkedDecoder::feed(const char* data, size_t length, std::string* output) {
+    size_t pos = 0;
+    while (pos < length && state_ != State::Done && state_ != State::Error) {
+        char c = data[pos];
+
+        switch (state_) {
+            case State::Size: {
+                int digit = -1;
+                if (c >= '0' && c <= '9') digit = c - '0';
+                else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+
+                if (digit >= 0) {
+                    if (++sizeDigits_ > 15) {
+                        state_ = State::Error;
+                        break;
+                    }
+                    chunkRemaining_ = chunkRemaining_ * 16 + static_cast<uint64_t>(digit);
+                } else if (sizeDigits_ > 0 && (c == ';' || c == ' ' || c == '\t')) {
+                    state_ = State::Extension;
+                } else if (sizeDigits_ > 0 && c == '\r') {
+                    state_ = State::SizeLF;
+                } else {
+                    state_ = State::Error;
+                }
+                pos++;
+                break;
+            }
+            case State::Extension:
+                // Só CRLF termina a linha: o proxy repassa os chunks como chegaram, e um LF solto
+                // seria fim de linha para alguns backends e não para outros
+                if (c == '\r') {
+                    state_ = State::SizeLF;
+                } else if (c == '\n') {
+                    state_ = State::Error;
+                    break;
+                }
+                pos++;
+                break;
+            case State::SizeLF:
+                if (c != '\n') {
+                    state_ = State::Error;
+                    break;
+                }
+                state_ = chunkRemaining_ == 0 ? State::TrailerStart : State::Data;
+                pos++;
+                break;
+            case State::Data: {
+                size_t available = std::min<uint64_t>(chunkRemaining_, length - pos);
+                if (output) {
+                    output->append(data + pos, available);
+                }
+                pos += available;
+                chunkRemaining_ -= available;
+                if (chunkRemaining_ == 0) {
+                    state_ = State::DataCR;
+                }
+                break;
+            }
+            case State::DataCR:
+                state_ = c == '\r' ? State::DataLF : State::Error;
+                pos++;
+                break;
+            case State::DataLF:
+                if (c != '\n') {
+                    state_ = State::Error;
+                    break;
+                }
+                state_ = State::Size;
+                sizeDigits_ = 0;
+                pos++;
+                break;
+            case State::TrailerStart:
+                if (c == '\n') {
+                    state_ = State::Error;
+                    break;
+                }
+                state_ = c == '\r' ? State::TrailerLF : State::TrailerLine;
+                pos++;
+                break;
+            case State::TrailerLine:
+                if (c == '\r') {
+                    state_ = State::TrailerLineLF;
+                } else if (c == '\n') {
+                    state_ = State::Error;
+                    break;
+                }
+                pos++;
+                break;
+            case State::TrailerLineLF:
+                state_ = c == '\n' ? State::TrailerStart : State::Error;
+                pos++;
+                break;
+            case State::TrailerLF:
+                state_ = c == '\n' ? State::Done : State::Error;
+                pos++;
+                break;
+            default:
+                break;
+        }
+    }
+    return pos;
+}
+
+bool ChunkedDecoder::done() const {
+    return state_ == State::Done;
+}
+
+bool ChunkedDecoder::failed() const {
+    return state_ == State::Error;
+}
@@ -0,0 +1,184 @@
+#include "listen_address.h"
+#include <cstring>
+#include <sstream>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/un.h>
+
+namespace {
+
+bool parsePort(const std::string& text, int& port) {
+    if (text.empty() || text.size() > 5 || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    port = std::stoi(text);
+    return port > 0 && port <= 65535;
+}
+
+} // namespace
+
+std::string ListenAddress::toString() const {
+    if (tls) {
+        ListenAddress plain = *this;
+        plain.tls = false;
+        return "tls:" + plain.toString();
+    }
+    switch (family) {
+        case Family::Unix:
+            return "unix:" + path;
+        case Family::IPv6:
+            return "[" + (host.empty() ? std::string("::") : host) + "]:" + std::to_string(port);
+        default:
+            return (host.empty() ? std::string("0.0.0.0") : host) + ":" + std::to_string(port);
+    }
+}
+
+socklen_t ListenAddress::toSockaddr(sockaddr_storage& storage) const {
+    std::memset(&storage, 0, sizeof(storage));
+    switch (family) {
+        case Family::Unix: {
+            auto* address = reinterpret_cast<sockaddr_un*>(&storage);
+            if (path.empty() || path.size() >= sizeof(address->sun_path)) {
+                return 0;
+            }
+            address->sun_family = AF_UNIX;
+            std::memcpy(address->sun_path, path.c_str(), path.size());
+            return sizeof(sockaddr_un);
+        }
+        case Family::IPv6: {
+            auto* address = reinterpret_cast<sockaddr_in6*>(&storage);
+            address->sin6_family = AF_INET6;
+            address->sin6_port = htons(port);
+            address->sin6_addr = in6addr_any;
+            if (!host.empty() && inet_pton(AF_INET6, host.c_str(), &address->sin6_addr) != 1) {
+                return 0;
+            }
+            return sizeof(sockaddr_in6);
+        }
+        default: {
+            auto* address = reinterpret_cast<sockaddr_in*>(&storage);
+            address->sin_family = AF_INET;
+            address->sin_port = htons(port);
+            address->sin_addr.s_addr = INADDR_ANY;
+            if (!host.empty() && inet_pton(AF_INET, host.c_str(), &address->sin_addr) != 1) {
+                return 0;
+            }
+            return sizeof(sockaddr_in);
+        }
+    }
+}
+
+bool ListenAddress::matches(SOCKET socket) const {
+    sockaddr_storage expected;
+    if (toSockaddr(expected) == 0) {
+        return false;
+    }
+    sockaddr_storage bound{};
+    socklen_t length = sizeof(bound);
+    if (getsockname(socket, reinterpret_cast<sockaddr*>(&bound), &length) != 0 ||
+        bound.ss_family != expected.ss_family) {
+        return false;
+    }
+
+    switch (family) {
+        case Family::Unix:
+            return std::strncmp(reinterpret_cast<sockaddr_un*>(&bound)->sun_path,
+                                reinterpret_cast<sockaddr_un*>(&expected)->sun_path,
+                                sizeof(sockaddr_un::sun_path)) == 0;
+        case Family::IPv6: {
+            auto* a = reinterpret_cast<sockaddr_in6*>(&bound);
+            auto* b = reinterpret_cast<sockaddr_in6*>(&expected);
+            return a->sin6_port == b->sin6_port && std::memcmp(&a->sin6_addr, &b->sin6_addr, sizeof(in6_addr)) == 0;
+        }
+        default: {
+            auto* a = reinterpret_cast<sockaddr_in*>(&bound);
+            auto* b = reinterpret_cast<sockaddr_in*>(&expected);
+            return a->sin_port == b->sin_port && a->sin_addr.s_addr == b->sin_addr.s_addr;
+        }
+    }
+}
+
+bool ListenAddress::parse(const std::string& spec, int defaultPort, ListenAddress& address) {
+    if (spec.compare(0, 4, "tls:") == 0) {
+        // kTLS só existe em TCP
+        if (!parse(spec.substr(4), defaultPort, address) || address.isUnix()) {
+            return false;
+        }
+        address.tls = true;
+        return true;
+    }
+
+    address = ListenAddress{};
+    address.port = defaultPort;
+
+    if (spec.compare(0, 5, "unix:") == 0) {
+        address.family = Family::Unix;
+        address.path = spec.substr(5);
+        address.port = 0;
+        sockaddr_storage storage;
+        return address.toSockaddr(storage) != 0;
+    }
+
+    std::string port;
+    if (!spec.empty() && spec[0] == '[') {
+        size_t close = spec.find(']');
+        if (close == std::string::npos) {
+            return false;
+        }
+        address.family = Family::IPv6;
+        address.host = spec.substr(1, close - 1);
+        if (close + 1 < spec.size()) {
+            if (spec[close + 1] != ':') {
+                return false;
+            }
+            port = spec.substr(close + 2);
+        }
+    } else if (spec.find_first_not_of("0123456789") == std::string::npos) {
+        port = spec;
+    } else {
+        size_t colon = spec.rfind(':');
+        address.host = spec.substr(0, colon);
+        if (colon != std::string::npos) {
+            port = spec.substr(colon + 1);
+        }
+    }
+
+    if (address.host == "::" || address.host == "0.0.0.0") {
+        address.host.clear();
+    }
+    if (!port.empty() && !parsePort(port, address.port)) {
+        return false;
+    }
+    sockaddr_storage storage;
+    return address.port > 0 && address.toSockaddr(storage) != 0;
+}
+
+bool ListenAddress::parseList(const std::string& spec, int defaultPort, std::vector<ListenAddress>& addresses) {
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item.erase(0, item.find_first_not_of(' '));
+        item.erase(item.find_last_not_of(' ') + 1);
+        if (item.empty()) {
+            continue;
+        }
+        ListenAddress address;
+        if (!parse(item, defaultPort, address)) {
+            return false;
+        }
+        addresses.push_back(address);
+    }
+
+    for (auto& address : addresses) {
+        if (address.family != Family::IPv6) {
+            continue;
+        }
+        for (const auto& other : addresses) {
+            if (other.family == Family::IPv4 && other.port == address.port) {
+                address.v6Only = true;
+            }
+        }
+    }
+    return !addresses.empty();
+}
@@ -0,0 +1,244 @@
+#include "listener_handoff.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kListenerMessage = 'L';
+constexpr char kReadyMessage = 'R';
+constexpr size_t kMaxListeners = 32;   // Bem abaixo do limite de SCM_RIGHTS (253)
+
+bool makeAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+} // namespace
+
+ListenerHandoff::ListenerHandoff(std::string path)
+    : path_(std::move(path)),
+      confirmTimeout_(0),
+      controlFd_(-1),
+      peerFd_(-1),
+      wakeFd_(-1),
+      running_(false),
+      handedOff_(false) {
+}
+
+ListenerHandoff::~ListenerHandoff() {
+    stop();
+    if (peerFd_ >= 0) {
+        close(peerFd_);
+    }
+}
+
+std::vector<SOCKET> ListenerHandoff::takeOver() {
+    std::vector<SOCKET> listeners;
+    sockaddr_un address;
+    if (!makeAddress(path_, address)) {
+        Logger::getInstance().warning("Invalid upgrade socket path: " + path_);
+        return listeners;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return listeners;
+    }
+    // Sem processo atendendo (ou socket velho de um processo que morreu): abre as portas normalmente
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return listeners;
+    }
+
+    timeval timeout{5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char message = 0;
+    iovec iov{&message, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxListeners)];
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(fd, &msg, MSG_CMSG_CLOEXEC) == 1 && message == kListenerMessage) {
+        cmsghdr* header = CMSG_FIRSTHDR(&msg);
+        if (header && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+            size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            listeners.resize(count);
+            std::memcpy(listeners.data(), CMSG_DATA(header), count * sizeof(int));
+        }
+    }
+
+    if (listeners.empty()) {
+        Logger::getInstance().warning("Running server did not hand over its listening sockets");
+        close(fd);
+        return listeners;
+    }
+
+    peerFd_ = fd;
+    return listeners;
+}
+
+bool ListenerHandoff::confirm() {
+    if (peerFd_ < 0) {
+        return true;
+    }
+    // Com o prazo esgotado o antigo fecha a leitura antes da última checagem: o envio falha (EPIPE)
+    bool sent = send(peerFd_, &kReadyMessage, 1, MSG_NOSIGNAL) == 1;
+    close(peerFd_);
+    peerFd_ = -1;
+    return sent;
+}
+
+bool ListenerHandoff::serve(std::vector<SOCKET> listeners, std::chrono::milliseconds confirmTimeout,
+                            std::function<void()> onHandedOff) {
+    if (listeners.empty() || listeners.size() > kMaxListeners) {
+        Logger::getInstance().error("Cannot hand over " + std::to_string(listeners.size()) + " listening sockets");
+        return false;
+    }
+    sockaddr_un address;
+    if (!makeAddress(path_, address)) {
+        Logger::getInstance().warning("Invalid upgrade socket path: " + path_);
+        return false;
+    }
+
+    controlFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (controlFd_ < 0) {
+        return false;
+    }
+
+    // O caminho pode ser de um processo que já entregou o socket (ou que morreu)
+    unlink(path_.c_str());
+    if (bind(controlFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        chmod(path_.c_str(), S_IRUSR | S_IWUSR) < 0 || listen(controlFd_, 4) < 0) {
+        Logger::getInstance().error("Failed to listen on upgrade socket " + path_ + ": " + std::strerror(errno));
+        close(controlFd_);
+        controlFd_ = -1;
+        return false;
+    }
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    listeners_ = std::move(listeners);
+    confirmTimeout_ = confirmTimeout;
+    onHandedOff_ = std::move(onHandedOff);
+    running_.store(true);
+    thread_ = std::thread([this] { run(); });
+
+    Logger::getInstance().info("Accepting binary upgrades on " + path_);
+    return true;
+}
+
+void ListenerHandoff::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    uint64_t value = 1;
+    ssize_t written = write(wakeFd_, &value, sizeof(value));
+    (void)written;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // Depois da troca o caminho pertence ao processo novo
+    if (!handedOff_) {
+        unlink(path_.c_str());
+    }
+    if (controlFd_ >= 0) {
+        close(controlFd_);
+        controlFd_ = -1;
+    }
+    close(wakeFd_);
+    wakeFd_ = -1;
+}
+
+void ListenerHandoff::run() {
+    while (running_.load()) {
+        pollfd fds[2] = {{controlFd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+            return;
+        }
+        if (!running_.load() || !(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        int peer = accept4(controlFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (peer < 0) {
+            continue;
+        }
+
+        bool handedOff = handOff(peer);
+        close(peer);
+        if (handedOff) {
+            handedOff_ = true;
+            Logger::getInstance().info("Listening sockets handed over to new process, draining");
+            onHandedOff_();
+            return;
+        }
+        Logger::getInstance().warning("Binary upgrade aborted: new process did not confirm");
+    }
+}
+
+bool ListenerHandoff::handOff(int peer) {
+    char message = kListenerMessage;
+    iovec iov{&message, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxListeners)];
+    std::memset(control, 0, sizeof(control));
+
+    size_t bytes = sizeof(int) * listeners_.size();
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(bytes);
+
+    cmsghdr* header = CMSG_FIRSTHDR(&msg);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(bytes);
+    std::memcpy(CMSG_DATA(header), listeners_.data(), bytes);
+
+    if (sendmsg(peer, &msg, MSG_NOSIGNAL) != 1) {
+        return false;
+    }
+
+    // O processo novo confirma depois de iniciar; fechar sem confirmar cancela a troca
+    auto deadline = std::chrono::steady_clock::now() + confirmTimeout_;
+    pollfd fds[2] = {{peer, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+    int ready;
+    do {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        ready = poll(fds, 2, static_cast<int>(std::max<int64_t>(remaining.count(), 0)));
+    } while (ready < 0 && errno == EINTR);
+    if (ready < 0 || fds[1].revents & POLLIN) {
+        return false;
+    }
+
+    if (ready == 0) {
+        // Prazo esgotado: depois do shutdown o processo novo não consegue mais confirmar, então
+        // uma confirmação que chegou no limite ainda é lida e as duas pontas concordam
+        Logger::getInstance().warning("New process did not confirm the binary upgrade within " +
+                                      std::to_string(confirmTimeout_.count()) + "ms");
+        shutdown(peer, SHUT_RD);
+    }
+
+    char reply = 0;
+    return recv(peer, &reply, 1, MSG_DONTWAIT) == 1 && reply == kReadyMessage;
+}
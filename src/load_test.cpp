@@ -4,29 +4,127 @@
 #include <atomic>
 #include <chrono>
 #include <random>
+#include <string>
+#include <mutex>
+#include <algorithm>
 
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    #pragma comment(lib, "ws2_32.lib")
-#else
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <unistd.h>
-    #define closesocket close
-    #define SOCKET int
-#endif
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int SOCKET;
 
 std::atomic<int> successfulRequests(0);
 std::atomic<int> failedRequests(0);
 std::atomic<long long> totalResponseTime(0);
+std::mutex latencyMutex;
+std::vector<long long> latenciesUs;
 
-void clientWorker(const std::string& host, int port, int numRequests, int clientId) {
-#ifdef _WIN32
-    WSADATA wsaData;
-    WSAStartup(MAKEWORD(2,2), &wsaData);
-#endif
+struct LoadOptions {
+    bool keepAlive = false;     // Uma conexão por cliente, HTTP/1.1
+    std::string path;           // Vazio: sorteia entre os caminhos de exemplo
+    int thinkMs = -1;           // Pausa entre requisições; -1: aleatória entre 100 e 500 ms
+};
+
+// Lê uma resposta com Content-Length da conexão keep-alive; false em erro ou conexão fechada.
+// `closing`: o servidor avisou que fecha a conexão depois desta resposta
+bool readResponse(SOCKET socket, std::string& pending, bool& closing) {
+    size_t headerEnd;
+    char buffer[16384];
+    while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+        long received = recv(socket, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return false;
+        }
+        pending.append(buffer, static_cast<size_t>(received));
+    }
+    
+    size_t contentLength = 0;
+    std::string headers = pending.substr(0, headerEnd);
+    std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+    size_t lengthPos = headers.find("content-length:");
+    if (lengthPos != std::string::npos) {
+        contentLength = std::stoul(headers.substr(lengthPos + 15));
+    }
+    
+    size_t total = headerEnd + 4 + contentLength;
+    while (pending.size() < total) {
+        long received = recv(socket, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return false;
+        }
+        pending.append(buffer, static_cast<size_t>(received));
+    }
+    pending.erase(0, total);
+    closing = headers.find("connection: close") != std::string::npos;
+    return true;
+}
+
+void keepAliveWorker(const std::string& host, int port, int numRequests, int clientId, const LoadOptions& options) {
+    std::vector<long long> latencies;
+    SOCKET clientSocket = -1;
+    std::string pending;
+    std::string request = "GET " + options.path + " HTTP/1.1\r\nHost: " + host +
+                          "\r\nUser-Agent: LoadTester-Client-" + std::to_string(clientId) + "\r\n\r\n";
+    
+    for (int i = 0; i < numRequests; ++i) {
+        if (clientSocket < 0) {
+            clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in serverAddr{};
+            serverAddr.sin_family = AF_INET;
+            serverAddr.sin_port = htons(port);
+            inet_pton(AF_INET, host.c_str(), &serverAddr.sin_addr);
+            if (clientSocket < 0 ||
+                connect(clientSocket, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
+                if (clientSocket >= 0) {
+                    close(clientSocket);
+                }
+                clientSocket = -1;
+                failedRequests++;
+                continue;
+            }
+            pending.clear();
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        bool closing = false;
+        if (send(clientSocket, request.c_str(), request.length(), 0) < 0 ||
+            !readResponse(clientSocket, pending, closing)) {
+            close(clientSocket);
+            clientSocket = -1;
+            failedRequests++;
+            continue;
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+        
+        // Máximo de requisições por conexão atingido: a próxima abre outra
+        if (closing) {
+            close(clientSocket);
+            clientSocket = -1;
+        }
+        
+        successfulRequests++;
+        long long micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        totalResponseTime += micros / 1000;
+        latencies.push_back(micros);
+        
+        if (options.thinkMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.thinkMs));
+        }
+    }
+    if (clientSocket >= 0) {
+        close(clientSocket);
+    }
+    
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    latenciesUs.insert(latenciesUs.end(), latencies.begin(), latencies.end());
+}
+
+void clientWorker(const std::string& host, int port, int numRequests, int clientId, const LoadOptions& options) {
+    if (options.keepAlive) {
+        keepAliveWorker(host, port, numRequests, clientId, options);
+        return;
+    }
     
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -50,19 +148,19 @@ void clientWorker(const std::string& host, int port, int numRequests, int client
         inet_pton(AF_INET, host.c_str(), &serverAddr.sin_addr);
         
         if (connect(clientSocket, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
-            closesocket(clientSocket);
+            close(clientSocket);
             failedRequests++;
             continue;
         }
         
-        std::string path = paths[pathDist(gen)];
+        std::string path = options.path.empty() ? paths[pathDist(gen)] : options.path;
         std::string request = "GET " + path + " HTTP/1.0\r\n";
         request += "Host: " + host + "\r\n";
         request += "User-Agent: LoadTester-Client-" + std::to_string(clientId) + "\r\n";
         request += "Connection: close\r\n\r\n";
         
         if (send(clientSocket, request.c_str(), request.length(), 0) < 0) {
-            closesocket(clientSocket);
+            close(clientSocket);
             failedRequests++;
             continue;
         }
@@ -73,29 +171,53 @@ void clientWorker(const std::string& host, int port, int numRequests, int client
             totalReceived++;
         }
         
-        closesocket(clientSocket);
+        close(clientSocket);
         
         auto end = std::chrono::steady_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
         
         successfulRequests++;
         totalResponseTime += duration.count();
+        {
+            std::lock_guard<std::mutex> lock(latencyMutex);
+            latenciesUs.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+        }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(delay(gen)));
+        int thinkMs = options.thinkMs >= 0 ? options.thinkMs : delay(gen);
+        if (thinkMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(thinkMs));
+        }
     }
     
-#ifdef _WIN32
-    WSACleanup();
-#endif
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 5) {
-        std::cout << "Usage: " << argv[0] << " <host> <port> <num_clients> <requests_per_client>\n";
+    if (argc < 5) {
+        std::cout << "Usage: " << argv[0] << " <host> <port> <num_clients> <requests_per_client>"
+                  << " [--keep-alive] [--path <path>] [--think <ms>]\n";
         std::cout << "Example: " << argv[0] << " 127.0.0.1 8080 10 5\n";
+        std::cout << "Benchmark: " << argv[0] << " 127.0.0.1 8080 8 5000 --keep-alive --path /index.html --think 0\n";
         return 1;
     }
     
+    LoadOptions options;
+    for (int i = 5; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--keep-alive") {
+            options.keepAlive = true;
+        } else if (arg == "--path" && i + 1 < argc) {
+            options.path = argv[++i];
+        } else if (arg == "--think" && i + 1 < argc) {
+            options.thinkMs = std::stoi(argv[++i]);
+        } else {
+            std::cout << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (options.keepAlive && options.path.empty()) {
+        options.path = "/";
+    }
+    
     std::string host = argv[1];
     int port = std::stoi(argv[2]);
     int numClients = std::stoi(argv[3]);
@@ -112,7 +234,7 @@ int main(int argc, char* argv[]) {
     
     std::vector<std::thread> clients;
     for (int i = 0; i < numClients; ++i) {
-        clients.emplace_back(clientWorker, host, port, requestsPerClient, i + 1);
+        clients.emplace_back(clientWorker, host, port, requestsPerClient, i + 1, std::cref(options));
     }
     
     for (auto& client : clients) {
@@ -134,7 +256,14 @@ int main(int argc, char* argv[]) {
     
     if (successful > 0) {
         std::cout << "Average Response Time: " << (totalTime / successful) << "ms\n";
-        std::cout << "Requests per Second: " << (1000.0 * successful / testDuration.count()) << "\n";
+        std::cout << "Requests per Second: " << (1000.0 * successful / std::max<long long>(testDuration.count(), 1)) << "\n";
+        
+        std::sort(latenciesUs.begin(), latenciesUs.end());
+        auto percentile = [](double fraction) {
+            return latenciesUs[std::min(latenciesUs.size() - 1, static_cast<size_t>(fraction * latenciesUs.size()))];
+        };
+        std::cout << "Latency p50/p99/max: " << percentile(0.50) << " / " << percentile(0.99)
+                  << " / " << latenciesUs.back() << " us\n";
     }
     
     return 0;
@@ -1,5 +1,85 @@
 #include "logger.h"
 #include <iostream>
+#include <random>
+
+namespace {
+
+constexpr size_t kStagingBytes = 256 * 1024;                     // Por thread
+constexpr auto kWriterInterval = std::chrono::milliseconds(10);  // Produtores não acordam a escrita
+
+// Devolve o buffer à thread de escrita quando a thread termina
+struct StagingHandle {
+    std::shared_ptr<LogStagingBuffer> buffer;
+    
+    ~StagingHandle() {
+        if (buffer) {
+            buffer->retire();
+        }
+    }
+};
+
+thread_local StagingHandle tlsStaging;
+
+std::string formatRecord(const LogFormat& format, const char* args, uint32_t suppressed) {
+    std::string text;
+    for (const char* cursor = format.format; *cursor; ++cursor) {
+        if (cursor[0] != '{' || cursor[1] != '}') {
+            text += *cursor;
+            continue;
+        }
+        ++cursor;
+        
+        auto type = static_cast<logformat::ArgType>(*args++);
+        switch (type) {
+            case logformat::ArgType::Signed: {
+                int64_t value;
+                std::memcpy(&value, args, sizeof(value));
+                args += sizeof(value);
+                text += std::to_string(value);
+                break;
+            }
+            case logformat::ArgType::Unsigned: {
+                uint64_t value;
+                std::memcpy(&value, args, sizeof(value));
+                args += sizeof(value);
+                text += std::to_string(value);
+                break;
+            }
+            case logformat::ArgType::Double: {
+                double value;
+                std::memcpy(&value, args, sizeof(value));
+                args += sizeof(value);
+                char buffer[32];
+                snprintf(buffer, sizeof(buffer), "%g", value);
+                text += buffer;
+                break;
+            }
+            case logformat::ArgType::Bool:
+                text += *args++ ? "true" : "false";
+                break;
+            case logformat::ArgType::Char:
+                text += *args++;
+                break;
+            case logformat::ArgType::String: {
+                uint32_t length;
+                std::memcpy(&length, args, sizeof(length));
+                text.append(args + sizeof(length), length);
+                args += sizeof(length) + length;
+                break;
+            }
+        }
+    }
+    if (suppressed > 0) {
+        text += " [" + std::to_string(suppressed) + " similar messages suppressed]";
+    }
+    return text;
+}
+
+} // namespace
+
+LogStagingBuffer::LogStagingBuffer(size_t capacity)
+    : capacity_(capacity), data_(new char[capacity]) {
+}
 
 Logger& Logger::getInstance() {
     static Logger instance;
@@ -7,6 +87,14 @@ Logger& Logger::getInstance() {
 }
 
 Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        stopping_ = true;
+    }
+    writerCondition_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
     if (logFile_.is_open()) {
         logFile_.close();
     }
@@ -21,8 +109,11 @@ void Logger::setLogFile(const std::string& filename) {
 }
 
 void Logger::setLevel(Level level) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    currentLevel_ = level;
+    currentLevel_.store(level, std::memory_order_relaxed);
+}
+
+bool Logger::isEnabled(Level level) const {
+    return level >= currentLevel_.load(std::memory_order_relaxed);
 }
 
 void Logger::debug(const std::string& message) {
@@ -42,15 +133,21 @@ void Logger::error(const std::string& message) {
 }
 
 void Logger::log(Level level, const std::string& message) {
-    if (level < currentLevel_) {
+    if (!isEnabled(level)) {
         return;
     }
     
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    std::string timestamp = getCurrentTimestamp();
-    std::string levelStr = levelToString(level);
-    std::string logMessage = "[" + timestamp + "] [" + levelStr + "] " + message;
+    write(level, std::chrono::system_clock::now(), message);
+}
+
+std::string Logger::formatLine(Level level, std::chrono::system_clock::time_point time, const std::string& message) {
+    return "[" + getCurrentTimestamp(time) + "] [" + levelToString(level) + "] " + message;
+}
+
+// Chamado com mutex_ travado
+void Logger::write(Level level, std::chrono::system_clock::time_point time, const std::string& message) {
+    std::string logMessage = formatLine(level, time, message);
     
     if (consoleOutput_) {
         std::cout << logMessage << std::endl;
@@ -62,14 +159,121 @@ void Logger::log(Level level, const std::string& message) {
     }
 }
 
-std::string Logger::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(writerMutex_);
+    if (!writer_.joinable()) {
+        return;
+    }
+    // Uma passada que comece depois desta chamada: a que está em curso pode não ver os registros
+    uint64_t target = drainPasses_ + 2;
+    flushRequested_ = true;
+    writerCondition_.notify_all();
+    flushedCondition_.wait(lock, [this, target] { return drainPasses_ >= target || stopping_; });
+}
+
+uint64_t Logger::droppedMessages() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+LogStagingBuffer* Logger::stagingBuffer() {
+    if (!tlsStaging.buffer) {
+        tlsStaging.buffer = std::make_shared<LogStagingBuffer>(kStagingBytes);
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        buffers_.push_back(tlsStaging.buffer);
+        
+        std::lock_guard<std::mutex> writerLock(writerMutex_);
+        if (!writer_.joinable() && !stopping_) {
+            writer_ = std::thread(&Logger::writerLoop, this);
+        }
+    }
+    return tlsStaging.buffer.get();
+}
+
+void Logger::writerLoop() {
+    std::unique_lock<std::mutex> lock(writerMutex_);
+    while (!stopping_) {
+        writerCondition_.wait_for(lock, kWriterInterval, [this] { return stopping_ || flushRequested_; });
+        flushRequested_ = false;
+        lock.unlock();
+        drain();
+        lock.lock();
+        ++drainPasses_;
+        flushedCondition_.notify_all();
+    }
+    lock.unlock();
+    drain();
+}
+
+void Logger::drain() {
+    struct Entry {
+        int64_t timestampNs;
+        Level level;
+        std::string text;
+    };
+    std::vector<Entry> entries;
+    
+    std::vector<std::shared_ptr<LogStagingBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        buffers = buffers_;
+    }
+    for (const auto& buffer : buffers) {
+        // Aposentado antes de esvaziar: depois desta passada não chega mais nada nele
+        bool retired = buffer->retired();
+        buffer->consume([&entries](const LogRecordHeader& header, const char* args) {
+            entries.push_back({header.timestampNs, header.format->level,
+                               formatRecord(*header.format, args, header.suppressed)});
+        });
+        if (retired) {
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            buffers_.erase(std::remove(buffers_.begin(), buffers_.end(), buffer), buffers_.end());
+        }
+    }
+    
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (entries.empty() && dropped == droppedReported_) {
+        return;
+    }
+    
+    // Cada thread tem seu buffer: a ordem entre elas vem do horário de cada registro
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+    
+    // A passada inteira sai em uma escrita só por destino
+    std::string batch;
+    for (const auto& entry : entries) {
+        auto time = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(entry.timestampNs)));
+        batch += formatLine(entry.level, time, entry.text);
+        batch += '\n';
+    }
+    if (dropped != droppedReported_) {
+        batch += formatLine(Level::WARNING, std::chrono::system_clock::now(),
+                            std::to_string(dropped - droppedReported_) + " log messages dropped: staging buffer full");
+        batch += '\n';
+        droppedReported_ = dropped;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (consoleOutput_) {
+        std::cout << batch << std::flush;
+    }
+    if (logFile_.is_open()) {
+        logFile_ << batch;
+        logFile_.flush();
+    }
+}
+
+std::string Logger::getCurrentTimestamp(std::chrono::system_clock::time_point now) {
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()) % 1000;
     
     std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    std::tm local{};
+    localtime_r(&time_t, &local);   // A thread de escrita formata fora do mutex
+    ss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
     ss << "." << std::setfill('0') << std::setw(3) << ms.count();
     
     return ss.str();
@@ -84,3 +288,43 @@ std::string Logger::levelToString(Level level) {
         default: return "UNKNOWN";
     }
 }
+
+LogSite::LogSite(double perSecond, uint32_t burst, uint32_t sampleEvery)
+    : intervalNs_(perSecond > 0 ? static_cast<int64_t>(1e9 / perSecond) : 0),
+      toleranceNs_(intervalNs_ * static_cast<int64_t>(burst > 0 ? burst - 1 : 0)),
+      sampleEvery_(sampleEvery > 0 ? sampleEvery : 1),
+      nextAllowedNs_(0),
+      suppressed_(0) {
+}
+
+bool LogSite::admit() {
+    if (sampleEvery_ > 1) {
+        thread_local std::minstd_rand random(std::random_device{}());
+        if (random() % sampleEvery_ != 0) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    if (intervalNs_ == 0) {
+        return true;
+    }
+    
+    // GCRA: equivale a um balde de tokens, com um único atômico como estado
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t next = nextAllowedNs_.load(std::memory_order_relaxed);
+    for (;;) {
+        int64_t start = next > now ? next : now;
+        if (start - now > toleranceNs_) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (nextAllowedNs_.compare_exchange_weak(next, start + intervalNs_, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+uint64_t LogSite::takeSuppressed() {
+    return suppressed_.exchange(0, std::memory_order_relaxed);
+}
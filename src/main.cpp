@@ -1,4 +1,5 @@
 #include "http_server.h"
+#include "listener_handoff.h"
 #include "logger.h"
 #include "cli.h"
 #include <thread>
@@ -8,16 +9,188 @@
 #include <iostream>
 #include <csignal>
 #include <memory>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#include <atomic>
+#include <pthread.h>
 
 std::unique_ptr<HttpServer> g_server;
+std::atomic<bool> g_exiting{false};
 
-void signalHandler(int signal) {
-    if (signal == SIGINT || signal == SIGTERM) {
-        Logger::getInstance().info("Sinal de encerramento recebido");
-        if (g_server) {
-            g_server->stop();
+// Opções que o SIGHUP pode reler; porta e raiz só mudam com reinício
+struct ServerSettings {
+    int port = 8080;
+    std::vector<ListenAddress> listen;      // Vazio: só IPv4 em `port`
+    size_t numThreads = 4;
+    std::string documentRoot;
+    std::chrono::seconds drainTimeout{10};
+    HandlerConfig handler;
+};
+
+// Linha de comando sobre o arquivo de --config; false com o erro já registrado
+bool loadSettings(CLI& cli, ServerSettings& settings) {
+    std::string configPath = cli.getStringOption("--config");
+    std::string error;
+    if (!configPath.empty() && !cli.loadConfigFile(configPath, error)) {
+        Logger::getInstance().error("Arquivo de configuração inválido: " + error);
+        return false;
+    }
+    
+    settings.port = cli.getIntOption("--port", cli.getIntOption("-p", 8080));
+    std::string listen = cli.getStringOption("--listen");
+    if (!listen.empty() && !ListenAddress::parseList(listen, settings.port, settings.listen)) {
+        Logger::getInstance().error("Endereços de escuta inválidos: " + listen);
+        return false;
+    }
+    settings.numThreads = cli.getIntOption("--threads", cli.getIntOption("-t", 4));
+    settings.documentRoot = cli.getStringOption("--docroot", cli.getStringOption("-d", "./www"));
+    settings.drainTimeout = std::chrono::seconds(std::max(cli.getIntOption("--drain-timeout", 10), 0));
+    if (settings.numThreads == 0 || settings.numThreads > 1024) {
+        Logger::getInstance().error("Número de threads inválido: " + std::to_string(settings.numThreads));
+        return false;
+    }
+    
+    HandlerConfig& handlerConfig = settings.handler;
+    handlerConfig.preload.enabled = !cli.hasFlag("--no-preload");
+    handlerConfig.preload.snapshotPath = cli.getStringOption("--index-snapshot");
+    handlerConfig.preload.maxFileSize = static_cast<uint64_t>(cli.getIntOption("--preload-max-kb", 1024)) * 1024;
+    
+    handlerConfig.keepAlive.timeoutSeconds = cli.getIntOption("--keepalive-timeout", handlerConfig.keepAlive.timeoutSeconds);
+    handlerConfig.keepAlive.requestTimeoutSeconds = cli.getIntOption("--request-timeout",
+                                                                     handlerConfig.keepAlive.requestTimeoutSeconds);
+    handlerConfig.requestBody.maxBodyBytes = static_cast<uint64_t>(cli.getIntOption("--max-body-mb", 64)) * 1024 * 1024;
+    handlerConfig.http2.enabled = !cli.hasFlag("--no-http2");
+    if (cli.hasFlag("--ws-drop-slow")) {
+        handlerConfig.webSocket.slowConsumers = SlowConsumerPolicy::DropMessages;
+    }
+    
+    ClientLimitsConfig& clientLimits = handlerConfig.clientLimits;
+    clientLimits.maxConnectionsPerIp = static_cast<size_t>(std::max(
+        cli.getIntOption("--max-conns-per-ip", static_cast<int>(clientLimits.maxConnectionsPerIp)), 0));
+    int minClientRate = std::max(cli.getIntOption("--min-client-rate", static_cast<int>(clientLimits.minReceiveRate)), 0);
+    clientLimits.minReceiveRate = static_cast<uint32_t>(minClientRate);
+    clientLimits.minSendRate = static_cast<uint32_t>(minClientRate);
+    
+    std::string socketProfile = cli.getStringOption("--socket-profile", "default");
+    if (!SocketOptions::fromProfile(socketProfile, handlerConfig.socket)) {
+        Logger::getInstance().error("Perfil de socket desconhecido: " + socketProfile);
+        return false;
+    }
+    std::string dispatch = cli.getStringOption("--dispatch", "shared");
+    if (!WorkerDispatcher::parsePolicy(dispatch, handlerConfig.dispatch)) {
+        Logger::getInstance().error("Política de distribuição desconhecida: " + dispatch);
+        return false;
+    }
+    
+    std::string lanes = cli.getStringOption("--lanes");
+    std::string laneRules = cli.getStringOption("--lane-rules");
+    if (!lanes.empty() && !LanesConfig::parseLanes(lanes, handlerConfig.lanes.lanes)) {
+        Logger::getInstance().error("Faixas de prioridade inválidas: " + lanes);
+        return false;
+    }
+    if (!laneRules.empty() && (!handlerConfig.lanes.enabled() ||
+                               !LanesConfig::parseRules(laneRules, handlerConfig.lanes))) {
+        Logger::getInstance().error("Regras de faixa inválidas (requerem --lanes): " + laneRules);
+        return false;
+    }
+    
+    SocketOptions& socketOptions = handlerConfig.socket;
+    socketOptions.backlog = cli.getIntOption("--backlog", socketOptions.backlog);
+    socketOptions.receiveBuffer = cli.getIntOption("--socket-rcvbuf-kb", socketOptions.receiveBuffer / 1024) * 1024;
+    socketOptions.sendBuffer = cli.getIntOption("--socket-sndbuf-kb", socketOptions.sendBuffer / 1024) * 1024;
+    
+    TlsConfig& tls = handlerConfig.tls;
+    tls.certificateFile = cli.getStringOption("--tls-cert");
+    tls.keyFile = cli.getStringOption("--tls-key");
+    tls.ticketKeyFile = cli.getStringOption("--tls-ticket-key");
+    tls.sessionTimeoutSeconds = std::max(cli.getIntOption("--tls-session-timeout", tls.sessionTimeoutSeconds), 1);
+    bool tlsListener = std::any_of(settings.listen.begin(), settings.listen.end(), [](const ListenAddress& address) {
+        return address.tls;
+    });
+    if (tlsListener && !tls.enabled()) {
+        Logger::getInstance().error("Endereços \"tls:\" requerem --tls-cert");
+        return false;
+    }
+    
+    StreamingConfig& streaming = handlerConfig.streaming;
+    streaming.windowBytes = static_cast<uint64_t>(std::max(cli.getIntOption("--send-window-kb",
+        static_cast<int>(streaming.windowBytes / 1024)), 64)) * 1024;
+    streaming.stallTimeoutSeconds = std::max(cli.getIntOption("--stall-timeout", streaming.stallTimeoutSeconds), 1);
+    streaming.connectionBufferBytes = static_cast<size_t>(std::max(cli.getIntOption("--stream-buffer-kb",
+        static_cast<int>(streaming.connectionBufferBytes / 1024)), 16)) * 1024;
+    streaming.maxBufferedBytes = static_cast<size_t>(std::max(cli.getIntOption("--max-buffered-mb",
+        static_cast<int>(streaming.maxBufferedBytes / (1024 * 1024))), 0)) * 1024 * 1024;
+    
+    RateLimitConfig& rateLimit = handlerConfig.rateLimit;
+    rateLimit.requestsPerSecond = std::max(cli.getIntOption("--rate-limit", 0), 0);
+    rateLimit.burst = static_cast<uint32_t>(std::max(cli.getIntOption("--rate-limit-burst", 0), 0));
+    std::string rateLimitPaths = cli.getStringOption("--rate-limit-path");
+    if (!rateLimitPaths.empty() && !RateLimiter::parseRules(rateLimitPaths, rateLimit.paths)) {
+        Logger::getInstance().error("Limites por caminho inválidos: " + rateLimitPaths);
+        return false;
+    }
+    
+    handlerConfig.accessLog.path = cli.getStringOption("--access-log");
+    handlerConfig.accessLog.maxFileBytes = static_cast<uint64_t>(std::max(cli.getIntOption("--access-log-max-mb", 64), 1)) * 1024 * 1024;
+    handlerConfig.accessLog.maxFiles = std::max(cli.getIntOption("--access-log-files", handlerConfig.accessLog.maxFiles), 0);
+    
+    int compressionCacheMb = cli.getIntOption("--compression-cache-mb", 64);
+    handlerConfig.compression.cacheBytes = static_cast<size_t>(std::max(compressionCacheMb, 0)) * 1024 * 1024;
+    
+    int responseCacheMb = cli.getIntOption("--response-cache-mb", 64);
+    handlerConfig.responseCache.enabled = responseCacheMb > 0;
+    handlerConfig.responseCache.cacheBytes = static_cast<size_t>(std::max(responseCacheMb, 0)) * 1024 * 1024;
+    
+    std::string proxyRoutes = cli.getStringOption("--proxy");
+    if (!proxyRoutes.empty()) {
+        BalancePolicy policy = cli.getStringOption("--proxy-balance") == "least-conn"
+                                   ? BalancePolicy::LeastConnections : BalancePolicy::RoundRobin;
+        if (!ProxyHandler::parseRoutes(proxyRoutes, policy, handlerConfig.proxy.routes)) {
+            Logger::getInstance().error("Rotas de proxy inválidas: " + proxyRoutes);
+            return false;
+        }
+    }
+    return true;
+}
+
+void reloadSettings(int argc, char* argv[], ServerSettings& current) {
+    Logger::getInstance().info("SIGHUP recebido, relendo a configuração");
+    
+    CLI cli(argc, argv);
+    ServerSettings settings;
+    if (!loadSettings(cli, settings)) {
+        Logger::getInstance().warning("Configuração mantida sem alterações");
+        return;
+    }
+    if (settings.port != current.port || settings.documentRoot != current.documentRoot) {
+        Logger::getInstance().warning("Porta e diretório raiz só mudam com reinício (--upgrade-socket)");
+    }
+    
+    g_server->reload(settings.numThreads, settings.handler);
+    current = std::move(settings);
+}
+
+// Os sinais ficam bloqueados em todas as threads e são tratados aqui com sigwait, fora de um
+// handler assíncrono: SIGINT/SIGTERM encerram o servidor, SIGHUP relê a configuração
+void signalLoop(sigset_t signals, int argc, char* argv[], ServerSettings settings) {
+    for (;;) {
+        int signal = 0;
+        if (sigwait(&signals, &signal) != 0) {
+            continue;
+        }
+        if (g_exiting.load()) {
+            return;
         }
-        exit(0);
+        if (signal == SIGHUP) {
+            reloadSettings(argc, argv, settings);
+            continue;
+        }
+        
+        Logger::getInstance().info("Sinal de encerramento recebido");
+        g_server->stop(settings.drainTimeout);
+        return;
     }
 }
 
@@ -52,6 +225,11 @@ void workerThread(int threadId, int numLogs) {
         }
     }
     
+    // Caminho adiado: só os argumentos são copiados aqui, o texto é montado pela thread de escrita
+    for (int i = 0; i < numLogs; ++i) {
+        LOG_FORMAT(Logger::Level::INFO, "Thread {} - Operação adiada {} de {} ({} ms)", threadId, i + 1, numLogs, 0.5 * i);
+    }
+    
     logger.info("Thread " + std::to_string(threadId) + " finalizou todas as operações");
 }
 
@@ -76,17 +254,134 @@ void runLoggerTests(int numThreads, int logsPerThread) {
     
     Logger::getInstance().info("=== Testes Concluídos ===");
     Logger::getInstance().info("Tempo total: " + std::to_string(duration.count()) + "ms");
-    Logger::getInstance().info("Total de logs: " + std::to_string(numThreads * logsPerThread));
+    Logger::getInstance().flush();
+    Logger::getInstance().info("Total de logs: " + std::to_string(2 * numThreads * logsPerThread) +
+                              " (descartados: " + std::to_string(Logger::getInstance().droppedMessages()) + ")");
+}
+
+// PUT /uploads/<nome>: o corpo vai em streaming direto para o disco, sem ficar inteiro na memória
+void registerUploadRoute(HttpServer& server, const std::string& uploadDir) {
+    std::filesystem::create_directories(uploadDir);
+    
+    server.handler().addRoute(HttpMethod::Put, "/uploads/:name",
+        [uploadDir](const HttpRequest& request, HttpResponse& response, const RouteParams& params) {
+            std::string name(params.get("name"));
+            if (name.empty() || name[0] == '.') {
+                response.statusCode = 400;
+                response.statusText = "Bad Request";
+                return;
+            }
+            
+            // Grava em arquivo temporário e renomeia: leitores nunca veem um upload pela metade
+            std::string finalPath = uploadDir + "/" + name;
+            std::string tempPath = uploadDir + "/." + name + ".part";
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            
+            std::string chunk;
+            while (out && request.bodyReader->read(chunk)) {
+                out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            }
+            out.close();
+            
+            if (!out || !request.bodyReader->complete()) {
+                std::remove(tempPath.c_str());
+                if (request.bodyReader->errorStatus() == 0) {
+                    response.statusCode = 500;
+                    response.statusText = "Internal Server Error";
+                }
+                return;
+            }
+            
+            std::rename(tempPath.c_str(), finalPath.c_str());
+            response.statusCode = 201;
+            response.statusText = "Created";
+            response.headers["Location"] = request.path;
+            response.body = std::to_string(request.bodyReader->bytesRead()) + " bytes\n";
+        }, true);
+}
+
+// GET /ws/<tópico>: assina o tópico e repassa as mensagens do cliente aos demais assinantes;
+// POST /publish/<tópico>: publica o corpo para todos os assinantes
+void registerWebSocketRoutes(HttpServer& server) {
+    HttpHandler& handler = server.handler();
+    
+    handler.addRoute(HttpMethod::Get, "/ws/:topic",
+        [&handler](const HttpRequest& request, HttpResponse& response, const RouteParams& params) {
+            std::string topic(params.get("topic"));
+            auto handlers = std::make_shared<WebSocketHandlers>();
+            handlers->onMessage = [topic](WebSocketHub& hub, WebSocketClientId, std::string_view message, bool binary) {
+                hub.publish(topic, message, binary);
+            };
+            handler.webSockets().accept(request, response, handlers, {topic});
+        });
+    
+    handler.addRoute(HttpMethod::Post, "/publish/:topic",
+        [&handler](const HttpRequest& request, HttpResponse& response, const RouteParams& params) {
+            size_t delivered = handler.webSockets().publish(std::string(params.get("topic")), request.body);
+            response.headers["Content-Type"] = "text/plain";
+            response.body = std::to_string(delivered) + " subscribers\n";
+        });
 }
 
 void printUsage() {
     std::cout << "Uso: ./concurrent-server [OPÇÕES]\n";
     std::cout << "Opções do Servidor HTTP:\n";
     std::cout << "  -p, --port <porta>       Porta do servidor (padrão: 8080)\n";
+    std::cout << "  --listen <endereços>     Endereços de escuta separados por vírgula, no lugar de --port:\n";
+    std::cout << "                           \"0.0.0.0:8080,[::]:8080,unix:/run/server.sock\" (\"[::]\" sozinho\n";
+    std::cout << "                           na porta atende IPv4 e IPv6; sem porta usa --port)\n";
+    std::cout << "                           Prefixo \"tls:\" (\"tls:[::]:8443\") termina TLS no endereço\n";
+    std::cout << "  --tls-cert <arq>         Certificado PEM (cadeia completa) dos endereços \"tls:\"\n";
+    std::cout << "  --tls-key <arq>          Chave privada PEM (padrão: no arquivo do certificado)\n";
+    std::cout << "  --tls-ticket-key <arq>   80 bytes para cifrar os tickets de sessão, compartilháveis entre\n";
+    std::cout << "                           processos (padrão: chaves geradas a cada início)\n";
+    std::cout << "  --tls-session-timeout <s> Validade das sessões retomáveis (padrão: 7200)\n";
     std::cout << "  -t, --threads <num>      Número de threads trabalhadoras (padrão: 4)\n";
+    std::cout << "  --dispatch <política>    Distribuição das conexões entre as threads: shared (fila única),\n";
+    std::cout << "                           round-robin, least-loaded ou affinity (mesmo IP, mesma thread)\n";
+    std::cout << "  --lanes <faixas>         Faixas de prioridade servidas por deficit round robin:\n";
+    std::cout << "                           \"health:8,api:4,downloads:1:3\" (nome:peso[:máximo em atendimento]);\n";
+    std::cout << "                           requisições sem regra vão para \"default\" (peso 1)\n";
+    std::cout << "  --lane-rules <regras>    \"path:/_server/health=health;header:X-Priority:high=api;\n";
+    std::cout << "                           client:10.0.=health;client:unix=health\" (a primeira que casar)\n";
     std::cout << "  -d, --docroot <caminho>  Diretório raiz dos documentos (padrão: ./www)\n";
     std::cout << "  -h, --help               Mostrar esta mensagem de ajuda\n";
+    std::cout << "  --config <arquivo>       Arquivo \"opção = valor\" relido com SIGHUP (threads, timeouts, caches)\n";
+    std::cout << "  --drain-timeout <s>      Prazo para drenar as conexões ao encerrar (padrão: 10)\n";
+    std::cout << "  --upgrade-socket <arq>   Socket Unix para troca de binário: o processo novo herda a porta\n";
+    std::cout << "                           do processo em execução, que drena as conexões e encerra\n";
     std::cout << "  --stats                  Mostrar estatísticas do servidor em execução\n";
+    std::cout << "  --access-log <arq>       Log de acesso binário (consultar com access-log-query)\n";
+    std::cout << "  --access-log-max-mb <mb> Tamanho de cada arquivo antes da rotação (padrão: 64)\n";
+    std::cout << "  --access-log-files <n>   Arquivos rotacionados mantidos (padrão: 5)\n";
+    std::cout << "  --index-snapshot <arq>   Snapshot do índice da raiz para reinícios rápidos\n";
+    std::cout << "  --preload-max-kb <kb>    Tamanho máximo dos arquivos pré-carregados (padrão: 1024)\n";
+    std::cout << "  --no-preload             Não pré-carregar arquivos na inicialização\n";
+    std::cout << "  --proxy <rotas>          Proxy reverso: \"/api=host:porta,host:porta;/x=host:porta\"\n";
+    std::cout << "  --proxy-balance <modo>   Balanceamento: round-robin ou least-conn (padrão: round-robin)\n";
+    std::cout << "  --response-cache-mb <mb> Cache das respostas do proxy; 0 desativa (padrão: 64)\n";
+    std::cout << "  --compression-cache-mb <mb> Cache das variantes comprimidas (padrão: 64)\n";
+    std::cout << "  --keepalive-timeout <s>  Tempo ocioso máximo entre requisições (padrão: 5)\n";
+    std::cout << "  --request-timeout <s>    Prazo para ler a requisição e montar a resposta (padrão: 60)\n";
+    std::cout << "  --stall-timeout <s>      Prazo de cada janela do envio da resposta (padrão: 30)\n";
+    std::cout << "  --send-window-kb <kb>    Bytes enviados por janela (sendfile/writev) (padrão: 1024)\n";
+    std::cout << "  --stream-buffer-kb <kb>  Corpo copiado em memória por conexão de cada vez (padrão: 256)\n";
+    std::cout << "  --max-buffered-mb <mb>   Soma desses buffers entre as conexões; 0 sem limite (padrão: 64)\n";
+    std::cout << "  --max-body-mb <mb>       Tamanho máximo do corpo das requisições (padrão: 64)\n";
+    std::cout << "  --max-conns-per-ip <n>   Conexões simultâneas por IP; 0 desativa (padrão: 256)\n";
+    std::cout << "  --min-client-rate <B/s>  Taxa mínima de envio/recepção de um cliente; 0 desativa (padrão: 512)\n";
+    std::cout << "  --socket-profile <nome>  Opções de socket: default, latency (TCP_NODELAY, TCP_FASTOPEN,\n";
+    std::cout << "                           SO_BUSY_POLL) ou throughput (TCP_CORK, buffers e backlog maiores)\n";
+    std::cout << "  --backlog <n>            Fila de conexões pendentes do listen (padrão: SOMAXCONN)\n";
+    std::cout << "  --socket-rcvbuf-kb <kb>  SO_RCVBUF das conexões; 0 mantém o ajuste do kernel\n";
+    std::cout << "  --socket-sndbuf-kb <kb>  SO_SNDBUF das conexões; 0 mantém o ajuste do kernel\n";
+    std::cout << "  --rate-limit <req/s>     Requisições por segundo de cada IP (429 acima); 0 desativa (padrão: 0)\n";
+    std::cout << "  --rate-limit-burst <n>   Rajada permitida acima da taxa (padrão: o dobro da taxa)\n";
+    std::cout << "  --rate-limit-path <regras> Limite por IP e caminho: \"/api=10:20;/login=1\" (prefixo=taxa[:rajada])\n";
+    std::cout << "  --upload-dir <caminho>   Aceita PUT /uploads/<nome> gravando neste diretório\n";
+    std::cout << "  --no-http2               Não aceitar HTTP/2 (h2c) na porta HTTP\n";
+    std::cout << "  --websocket              Tópicos WebSocket em /ws/<tópico> e POST /publish/<tópico>\n";
+    std::cout << "  --ws-drop-slow           Descarta mensagens de clientes lentos em vez de desconectá-los\n";
     std::cout << "\nOpções de Teste:\n";
     std::cout << "  --test-logger            Executar apenas testes do sistema de logging\n";
     std::cout << "  --test-threads <num>     Número de threads para teste (padrão: 5)\n";
@@ -94,6 +389,9 @@ void printUsage() {
     std::cout << "\nExemplos:\n";
     std::cout << "  ./concurrent-server                           # Iniciar servidor HTTP\n";
     std::cout << "  ./concurrent-server --port 9090 --threads 8  # Servidor personalizado\n";
+    std::cout << "  ./concurrent-server --config server.conf      # Configuração em arquivo (kill -HUP relê)\n";
+    std::cout << "  ./concurrent-server --listen \"[::]:8080,unix:/run/cs.sock\"  # Dual-stack e sidecars locais\n";
+    std::cout << "  ./concurrent-server --listen \":8080,tls::8443\" --tls-cert cert.pem --tls-key key.pem  # HTTPS (kTLS)\n";
     std::cout << "  ./concurrent-server --stats                   # Mostrar estatísticas\n";
     std::cout << "  ./concurrent-server --test-logger             # Testar apenas logging\n";
     std::cout << "  ./concurrent-server --test-logger --test-threads 10  # Teste com 10 threads\n";
@@ -124,33 +422,93 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
+    // Bloqueia os sinais antes de criar qualquer thread: todas herdam a máscara
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    // sendfile não aceita MSG_NOSIGNAL: um cliente que fecha (ou é cortado) no meio do envio
+    // não pode derrubar o processo
+    signal(SIGPIPE, SIG_IGN);
+    
     // Configuração do servidor HTTP
-    int port = cli.getIntOption("--port", cli.getIntOption("-p", 8080));
-    size_t numThreads = cli.getIntOption("--threads", cli.getIntOption("-t", 4));
-    std::string documentRoot = cli.getStringOption("--docroot", 
-                                cli.getStringOption("-d", "./www"));
+    ServerSettings settings;
+    if (!loadSettings(cli, settings)) {
+        return 1;
+    }
+    std::string uploadDir = cli.getStringOption("--upload-dir");
+    std::string upgradeSocket = cli.getStringOption("--upgrade-socket");
     
-    signal(SIGINT, signalHandler);
-    signal(SIGTERM, signalHandler);
+    std::unique_ptr<ListenerHandoff> handoff;
+    std::thread signalThread;
+    int status = 0;
     
     try {
         Logger::getInstance().info("=== Servidor HTTP Concorrente ===");
-        Logger::getInstance().info("Porta: " + std::to_string(port));
-        Logger::getInstance().info("Threads: " + std::to_string(numThreads));
-        Logger::getInstance().info("Diretório raiz: " + documentRoot);
+        Logger::getInstance().info("Porta: " + std::to_string(settings.port));
+        Logger::getInstance().info("Threads: " + std::to_string(settings.numThreads));
+        Logger::getInstance().info("Diretório raiz: " + settings.documentRoot);
         
-        g_server = std::make_unique<HttpServer>(port, numThreads, 100, documentRoot);
+        g_server = std::make_unique<HttpServer>(settings.port, settings.numThreads, 100,
+                                                settings.documentRoot, settings.handler);
+        if (!settings.listen.empty()) {
+            g_server->setListenAddresses(settings.listen);
+        }
+        if (!uploadDir.empty()) {
+            registerUploadRoute(*g_server, uploadDir);
+        }
+        if (cli.hasFlag("--websocket")) {
+            registerWebSocketRoutes(*g_server);
+        }
+        signalThread = std::thread(signalLoop, signals, argc, argv, settings);
         
-        Logger::getInstance().info("Iniciando servidor...");
-        if (!g_server->start()) {
-            Logger::getInstance().error("Falha ao iniciar o servidor");
-            return 1;
+        // Troca de binário: herda os sockets de escuta de um processo em execução, se houver um
+        if (!upgradeSocket.empty()) {
+            handoff = std::make_unique<ListenerHandoff>(upgradeSocket);
+            std::vector<SOCKET> inherited = handoff->takeOver();
+            if (!inherited.empty()) {
+                Logger::getInstance().info("Sockets de escuta herdados do processo em execução: " +
+                                           std::to_string(inherited.size()));
+                g_server->adoptListeners(inherited);
+            }
+        }
+        g_server->openListeners();
+        if (handoff && !handoff->confirm()) {
+            // O processo antigo desistiu da troca e segue atendendo nos mesmos sockets
+            Logger::getInstance().error("Troca de binário abortada pelo processo em execução");
+            status = 1;
+        } else {
+            if (handoff) {
+                // Prazo de confirmação do próximo processo novo: o do encerramento gracioso, com um mínimo
+                auto confirmTimeout = std::max<std::chrono::milliseconds>(settings.drainTimeout,
+                                                                         std::chrono::seconds(1));
+                handoff->serve(g_server->listenerSockets(), confirmTimeout, [drainTimeout = settings.drainTimeout] {
+                    g_server->releaseListeners();
+                    g_server->stop(drainTimeout);
+                });
+            }
+            
+            Logger::getInstance().info("Iniciando servidor...");
+            if (!g_server->start()) {
+                Logger::getInstance().error("Falha ao iniciar o servidor");
+                status = 1;
+            }
         }
         
     } catch (const std::exception& e) {
         Logger::getInstance().error("Erro do servidor: " + std::string(e.what()));
-        return 1;
+        status = 1;
     }
     
-    return 0;
+    // A thread de sinais e a de troca podem estar usando o servidor: terminam antes dele
+    if (signalThread.joinable()) {
+        g_exiting.store(true);
+        pthread_kill(signalThread.native_handle(), SIGTERM);
+        signalThread.join();
+    }
+    handoff.reset();
+    g_server.reset();
+    return status;
 }
\ No newline at end of file
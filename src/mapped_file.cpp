@@ -0,0 +1,133 @@
+#include "mapped_file.h"
+
+#include <sys/mman.h>
+
+namespace {
+
+constexpr uint64_t kHugePageThreshold = 2 * 1024 * 1024;
+
+}
+
+std::shared_ptr<const MappedFile> MappedFile::map(int fd, uint64_t size, uint64_t inode,
+                                                  int64_t mtimeNs, bool populate) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate) {
+        flags |= MAP_POPULATE;
+    }
+#else
+    (void)populate;
+#endif
+
+    void* address = mmap(nullptr, size, PROT_READ, flags, fd, 0);
+    if (address == MAP_FAILED) {
+        return nullptr;
+    }
+
+    // Dicas ao kernel: leitura sequencial, readahead imediato e huge pages quando couber
+    madvise(address, size, MADV_SEQUENTIAL);
+    madvise(address, size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    if (size >= kHugePageThreshold) {
+        madvise(address, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    return std::shared_ptr<const MappedFile>(new MappedFile(address, size, inode, mtimeNs));
+}
+
+MappedFile::MappedFile(void* address, uint64_t size, uint64_t inode, int64_t mtimeNs)
+    : address_(address), size_(size), inode_(inode), mtimeNs_(mtimeNs) {
+}
+
+MappedFile::~MappedFile() {
+    munmap(address_, size_);
+}
+
+const char* MappedFile::data() const {
+    return static_cast<const char*>(address_);
+}
+
+uint64_t MappedFile::size() const {
+    return size_;
+}
+
+bool MappedFile::matches(uint64_t inode, uint64_t size, int64_t mtimeNs) const {
+    return inode_ == inode && size_ == size && mtimeNs_ == mtimeNs;
+}
+
+MappedFileCache::MappedFileCache(const MappedFileConfig& config)
+    : config_(config) {
+}
+
+std::shared_ptr<const MappedFile> MappedFileCache::acquire(const std::string& path, int fd, uint64_t size,
+                                                           uint64_t inode, int64_t mtimeNs, bool populate) {
+    if (!config_.enabled || size < config_.minFileSize || size > config_.maxFileSize) {
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(path);
+        if (it != index_.end()) {
+            if (it->second->file->matches(inode, size, mtimeNs)) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                return it->second->file;
+            }
+
+            // Arquivo mudou: descarta o mapeamento antigo (respostas em curso mantêm sua cópia)
+            currentBytes_ -= it->second->file->size();
+            lru_.erase(it->second);
+            index_.erase(it);
+        }
+    }
+
+    // O mmap acontece fora do lock; duas threads podem mapear o mesmo arquivo e a última vence
+    auto file = MappedFile::map(fd, size, inode, mtimeNs, populate || config_.populate);
+    if (!file) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(path);
+    if (it != index_.end()) {
+        currentBytes_ -= it->second->file->size();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    currentBytes_ += file->size();
+    lru_.push_front(Entry{path, file});
+    index_[path] = lru_.begin();
+    evict();
+    return file;
+}
+
+void MappedFileCache::setCapacity(size_t cacheBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_.cacheBytes = cacheBytes;
+    evict();
+}
+
+size_t MappedFileCache::mappedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return currentBytes_;
+}
+
+size_t MappedFileCache::entries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+}
+
+void MappedFileCache::evict() {
+    while (currentBytes_ > config_.cacheBytes && lru_.size() > 1) {
+        Entry& victim = lru_.back();
+        currentBytes_ -= victim.file->size();
+        index_.erase(victim.path);
+        lru_.pop_back();
+    }
+}
@@ -0,0 +1,133 @@
+#include "mime_types.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace {
+
+struct MimeMapping {
+    std::string_view extension;
+    const char* type;
+};
+
+constexpr MimeMapping kMappings[] = {
+    {"html", "text/html"},
+    {"htm", "text/html"},
+    {"txt", "text/plain"},
+    {"css", "text/css"},
+    {"csv", "text/csv"},
+    {"md", "text/markdown"},
+    {"xml", "application/xml"},
+    {"js", "application/javascript"},
+    {"mjs", "application/javascript"},
+    {"json", "application/json"},
+    {"map", "application/json"},
+    {"webmanifest", "application/manifest+json"},
+    {"wasm", "application/wasm"},
+    {"pdf", "application/pdf"},
+    {"zip", "application/zip"},
+    {"gz", "application/gzip"},
+    {"tar", "application/x-tar"},
+    {"bin", "application/octet-stream"},
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"webp", "image/webp"},
+    {"avif", "image/avif"},
+    {"svg", "image/svg+xml"},
+    {"ico", "image/x-icon"},
+    {"bmp", "image/bmp"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"ttf", "font/ttf"},
+    {"otf", "font/otf"},
+    {"mp3", "audio/mpeg"},
+    {"ogg", "audio/ogg"},
+    {"wav", "audio/wav"},
+    {"mp4", "video/mp4"},
+    {"webm", "video/webm"},
+};
+
+constexpr size_t kMappingCount = sizeof(kMappings) / sizeof(kMappings[0]);
+constexpr size_t kTableSize = 128;
+constexpr size_t kMaxExtensionLength = 16;
+constexpr int16_t kEmptySlot = -1;
+
+constexpr char toLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// FNV-1a com semente, insensível a maiúsculas
+constexpr uint32_t hashExtension(std::string_view extension, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : extension) {
+        hash ^= static_cast<uint8_t>(toLower(c));
+        hash *= 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+// Procura uma semente sem colisões: o hash vira perfeito para o conjunto fixo de extensões
+constexpr uint32_t findPerfectSeed() {
+    for (uint32_t seed = 1; seed < 100000; ++seed) {
+        bool used[kTableSize] = {};
+        bool collision = false;
+        for (size_t i = 0; i < kMappingCount && !collision; ++i) {
+            size_t slot = hashExtension(kMappings[i].extension, seed) & (kTableSize - 1);
+            collision = used[slot];
+            used[slot] = true;
+        }
+        if (!collision) {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+constexpr uint32_t kSeed = findPerfectSeed();
+static_assert(kSeed != 0, "No perfect hash seed found for the MIME table; grow kTableSize");
+
+struct SlotTable {
+    int16_t slots[kTableSize];
+};
+
+constexpr SlotTable buildTable() {
+    SlotTable table{};
+    for (auto& slot : table.slots) {
+        slot = kEmptySlot;
+    }
+    for (size_t i = 0; i < kMappingCount; ++i) {
+        table.slots[hashExtension(kMappings[i].extension, kSeed) & (kTableSize - 1)] = static_cast<int16_t>(i);
+    }
+    return table;
+}
+
+constexpr SlotTable kTable = buildTable();
+
+}
+
+const char* mimeTypeForPath(std::string_view path) {
+    static constexpr const char* kDefault = "application/octet-stream";
+
+    size_t dot = path.find_last_of("./");
+    if (dot == std::string_view::npos || path[dot] != '.') {
+        return kDefault;
+    }
+
+    std::string_view extension = path.substr(dot + 1);
+    if (extension.empty() || extension.size() > kMaxExtensionLength) {
+        return kDefault;
+    }
+
+    int16_t index = kTable.slots[hashExtension(extension, kSeed) & (kTableSize - 1)];
+    if (index == kEmptySlot || kMappings[index].extension.size() != extension.size()) {
+        return kDefault;
+    }
+
+    for (size_t i = 0; i < extension.size(); ++i) {
+        if (toLower(extension[i]) != kMappings[index].extension[i]) {
+            return kDefault;
+        }
+    }
+    return kMappings[index].type;
+}
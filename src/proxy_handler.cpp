@@ -0,0 +1,698 @@
+#include "proxy_handler.h"
+#include "http_handler.h"
+#include "http_utils.h"
+#include "socket_io.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <sstream>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+namespace {
+
+constexpr size_t kMaxResponseHeaderBytes = 16 * 1024;
+constexpr size_t kRelayBufferBytes = 16 * 1024;
+
+enum class BodyFraming {
+    None,
+    Length,
+    Chunked,
+    UntilClose
+};
+
+struct UpstreamHead {
+    int statusCode = 0;
+    std::string statusText;
+    bool http11 = false;
+    std::vector<std::pair<std::string, std::string>> headers;   // Nome original, valor
+};
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value;
+}
+
+// Headers de salto único (RFC 9110 7.6.1) mais os nomeados no próprio Connection
+bool isHopByHop(const std::string& lowerName, const std::string& connectionTokens) {
+    static const char* const kHopByHop[] = {
+        "connection", "keep-alive", "proxy-connection", "te", "upgrade", "proxy-authorization"
+    };
+    for (const char* name : kHopByHop) {
+        if (lowerName == name) {
+            return true;
+        }
+    }
+    return !connectionTokens.empty() && containsToken(connectionTokens, lowerName);
+}
+
+bool parseLength(const std::string& value, uint64_t& length) {
+    if (value.empty() || value.size() > 19 ||
+        !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return false;
+    }
+    length = std::stoull(value);
+    return true;
+}
+
+bool parseUpstreamHead(const std::string& data, size_t headerEnd, UpstreamHead& head) {
+    size_t lineEnd = data.find("\r\n");
+    std::string statusLine = data.substr(0, lineEnd);
+    if (statusLine.compare(0, 5, "HTTP/") != 0 || statusLine.size() < 12) {
+        return false;
+    }
+
+    head.http11 = statusLine.compare(0, 8, "HTTP/1.0") != 0;
+    size_t codeStart = statusLine.find(' ');
+    if (codeStart == std::string::npos || codeStart + 4 > statusLine.size()) {
+        return false;
+    }
+    std::string code = statusLine.substr(codeStart + 1, 3);
+    if (!std::all_of(code.begin(), code.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return false;
+    }
+    head.statusCode = std::stoi(code);
+    head.statusText = codeStart + 5 < statusLine.size() ? statusLine.substr(codeStart + 5) : "";
+
+    size_t position = lineEnd + 2;
+    while (position < headerEnd) {
+        size_t end = data.find("\r\n", position);
+        std::string line = data.substr(position, end - position);
+        position = end + 2;
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos || colon == 0) {
+            return false;
+        }
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t") + 1);
+        head.headers.emplace_back(line.substr(0, colon), value);
+    }
+    return true;
+}
+
+std::string peerAddress(SOCKET socket) {
+    sockaddr_storage address{};
+    socklen_t length = sizeof(address);
+    if (getpeername(socket, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return "";
+    }
+
+    char text[INET6_ADDRSTRLEN] = {};
+    if (address.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(&address)->sin_addr, text, sizeof(text));
+    } else if (address.ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &reinterpret_cast<sockaddr_in6*>(&address)->sin6_addr, text, sizeof(text));
+    }
+    return text;
+}
+
+// Mantém a contagem de requisições em curso usada pelo balanceamento least-connections
+class ActiveRequest {
+public:
+    explicit ActiveRequest(Backend& backend) : backend_(backend) { backend_.activeRequests++; }
+    ~ActiveRequest() { backend_.activeRequests--; }
+
+private:
+    Backend& backend_;
+};
+
+void fail(ProxyResult& result, int statusCode, const char* statusText) {
+    result.statusCode = statusCode;
+    result.statusText = statusText;
+}
+
+}
+
+ProxyHandler::ProxyHandler(const ProxyConfig& config, TimerWheel& timers, std::chrono::milliseconds relayStall)
+    : config_(config), timers_(timers), relayStall_(relayStall), running_(true) {
+    for (const auto& route : config_.routes) {
+        std::string prefix = route.prefix;
+        while (prefix.size() > 1 && prefix.back() == '/') {
+            prefix.pop_back();
+        }
+        routes_.push_back(Route{prefix, std::make_unique<UpstreamGroup>(route.backends, route.policy)});
+        Logger::getInstance().info("Proxy route " + prefix + " -> " + std::to_string(route.backends.size()) +
+                                  " backend(s)");
+    }
+
+    std::sort(routes_.begin(), routes_.end(), [](const Route& a, const Route& b) {
+        return a.prefix.size() > b.prefix.size();
+    });
+
+    if (config_.healthCheckIntervalMs > 0) {
+        healthThread_ = std::thread(&ProxyHandler::healthCheckLoop, this);
+    }
+}
+
+ProxyHandler::~ProxyHandler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    condition_.notify_all();
+    if (healthThread_.joinable()) {
+        healthThread_.join();
+    }
+}
+
+bool ProxyHandler::matches(const std::string& path) const {
+    return findRoute(path) != nullptr;
+}
+
+const ProxyHandler::Route* ProxyHandler::findRoute(const std::string& path) const {
+    for (const auto& route : routes_) {
+        const std::string& prefix = route.prefix;
+        if (path.compare(0, prefix.size(), prefix) == 0 &&
+            (path.size() == prefix.size() || prefix.back() == '/' || path[prefix.size()] == '/')) {
+            return &route;
+        }
+    }
+    return nullptr;
+}
+
+ProxyResult ProxyHandler::forward(Connection& client, const HttpRequest& request, bool keepAlive,
+                                  SocketDeadline& requestDeadline, ProxyCapture* capture) {
+    return exchange(&client, request, keepAlive, &requestDeadline, capture);
+}
+
+ProxyResult ProxyHandler::fetch(const HttpRequest& request, ProxyCapture& capture) {
+    return exchange(nullptr, request, false, nullptr, &capture);
+}
+
+ProxyResult ProxyHandler::exchange(Connection* client, const HttpRequest& request, bool keepAlive,
+                                   SocketDeadline* requestDeadline, ProxyCapture* capture) {
+    ProxyResult result;
+    result.keepAlive = keepAlive;
+
+    const Route* route = findRoute(request.path);
+    if (!route) {
+        fail(result, 404, "Not Found");
+        return result;
+    }
+
+    // Enquadramento do corpo da requisição, com as mesmas regras do caminho estático: os dois
+    // headers juntos ou outra codificação além de "chunked" abririam espaço para o backend
+    // enxergar outra fronteira entre requisições (request smuggling)
+    BodyFraming requestFraming = BodyFraming::None;
+    uint64_t requestLength = 0;
+    auto transferIt = request.headers.find("transfer-encoding");
+    auto lengthIt = request.headers.find("content-length");
+    if (transferIt != request.headers.end()) {
+        if (lengthIt != request.headers.end()) {
+            result.keepAlive = false;
+            fail(result, 400, "Bad Request");
+            return result;
+        }
+        if (toLower(transferIt->second) != "chunked") {
+            result.keepAlive = false;
+            fail(result, 501, "Not Implemented");
+            return result;
+        }
+        requestFraming = BodyFraming::Chunked;
+    } else if (lengthIt != request.headers.end()) {
+        if (!parseLength(lengthIt->second, requestLength)) {
+            result.keepAlive = false;
+            fail(result, 400, "Bad Request");
+            return result;
+        }
+        requestFraming = requestLength > 0 ? BodyFraming::Length : BodyFraming::None;
+    }
+    if (!client && requestFraming != BodyFraming::None) {
+        fail(result, 400, "Bad Request");
+        return result;
+    }
+
+    std::string connectionTokens;
+    auto connectionIt = request.headers.find("connection");
+    if (connectionIt != request.headers.end()) {
+        connectionTokens = connectionIt->second;
+    }
+
+    // O backend recebe o mesmo caminho que escolheu a rota, nunca o alvo cru do cliente:
+    // "/admin/..%2Fapi/x" chega como "/api/x"
+    std::ostringstream headStream;
+    headStream << request.method << " " << encodeRequestTarget(request.path, request.query) << " HTTP/1.1\r\n";
+    std::string forwardedFor;
+    for (const auto& header : request.headers) {
+        // Expect é respondido aqui mesmo: o backend recebe o corpo sem esperar. O enquadramento
+        // sai do que foi validado acima, nunca dos headers do cliente
+        if (isHopByHop(header.first, connectionTokens) || header.first == "expect" ||
+            header.first == "transfer-encoding" || header.first == "content-length" ||
+            header.first == "x-forwarded-proto") {
+            continue;
+        }
+        if (header.first == "x-forwarded-for") {
+            forwardedFor = header.second + ", ";
+            continue;
+        }
+        headStream << header.first << ": " << header.second << "\r\n";
+    }
+    std::string clientAddress = client ? peerAddress(client->socket) : "";
+    if (!clientAddress.empty()) {
+        headStream << "x-forwarded-for: " << forwardedFor << clientAddress << "\r\n";
+    }
+    if (requestFraming == BodyFraming::Chunked) {
+        // Os chunks seguem como chegaram, já conferidos pelo ChunkedDecoder
+        headStream << "transfer-encoding: chunked\r\n";
+    } else if (lengthIt != request.headers.end()) {
+        headStream << "content-length: " << requestLength << "\r\n";
+    }
+    headStream << "x-forwarded-proto: " << (client && client->tls ? "https" : "http") << "\r\n";
+    headStream << "connection: keep-alive\r\n\r\n";
+    const std::string requestHead = headStream.str();
+
+    UpstreamConnectionPool& pool = UpstreamConnectionPool::local();
+    UpstreamGroup& group = *route->group;
+    char buffer[kRelayBufferBytes];
+
+    // Conexões do pool podem ter sido fechadas pelo backend: nesses casos a requisição
+    // é repetida enquanto nada dela foi consumido do cliente
+    size_t connectAttempts = 0;
+    for (;;) {
+        Backend* backend = group.select();
+        if (!backend) {
+            fail(result, 503, "Service Unavailable");
+            return result;
+        }
+
+        bool reused = false;
+        SOCKET upstream = pool.acquire(*backend, config_.connectTimeoutMs, reused);
+        if (upstream < 0) {
+            LOG_LIMITED(Logger::Level::WARNING, 1, 10, "Proxy: failed to connect to {}:{}", backend->host, backend->port);
+            // Sem checagem ativa não há quem devolva o backend à rotação
+            if (config_.healthCheckIntervalMs > 0) {
+                backend->healthy = false;
+            }
+            if (++connectAttempts < group.backends().size()) {
+                continue;
+            }
+            fail(result, 502, "Bad Gateway");
+            return result;
+        }
+
+        ActiveRequest active(*backend);
+        auto startTime = std::chrono::steady_clock::now();
+        SocketDeadline deadline(timers_, upstream, config_.responseTimeoutSeconds);
+        auto timedOut = [&] {
+            return std::chrono::steady_clock::now() - startTime >= std::chrono::seconds(config_.responseTimeoutSeconds);
+        };
+
+        if (!sendAll(upstream, requestHead.data(), requestHead.size())) {
+            close(upstream);
+            if (reused) {
+                continue;
+            }
+            fail(result, 502, "Bad Gateway");
+            return result;
+        }
+
+        // Corpo da requisição: primeiro o que já está no buffer da conexão, depois o socket
+        bool bodySent = true;
+        bool clientFailed = false;
+        auto expectIt = request.headers.find("expect");
+        if (requestFraming != BodyFraming::None && expectIt != request.headers.end() &&
+            toLower(expectIt->second) == "100-continue" && client->readBuffer.empty()) {
+            static const char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+            clientFailed = !sendAll(client->socket, kContinue, sizeof(kContinue) - 1);
+        }
+        if (!clientFailed && requestFraming == BodyFraming::Length) {
+            uint64_t remaining = requestLength;
+            size_t buffered = static_cast<size_t>(std::min<uint64_t>(remaining, client->readBuffer.size()));
+            bodySent = sendAll(upstream, client->readBuffer.data(), buffered);
+            client->readBuffer.erase(0, buffered);
+            remaining -= buffered;
+
+            while (bodySent && remaining > 0) {
+                ssize_t received = client->receive(buffer,
+                                                   static_cast<size_t>(std::min<uint64_t>(remaining, sizeof(buffer))));
+                if (received <= 0) {
+                    clientFailed = true;
+                    break;
+                }
+                bodySent = sendAll(upstream, buffer, static_cast<size_t>(received));
+                remaining -= static_cast<uint64_t>(received);
+            }
+        } else if (!clientFailed && requestFraming == BodyFraming::Chunked) {
+            ChunkedDecoder decoder;
+            std::string pending = std::move(client->readBuffer);
+            client->readBuffer.clear();
+
+            for (;;) {
+                size_t used = decoder.feed(pending.data(), pending.size(), nullptr);
+                bodySent = sendAll(upstream, pending.data(), used);
+                if (!bodySent || decoder.done() || decoder.failed()) {
+                    // Bytes após o fim do corpo pertencem à próxima requisição em pipeline
+                    client->readBuffer = pending.substr(used);
+                    break;
+                }
+                ssize_t received = client->receive(buffer, sizeof(buffer));
+                if (received <= 0) {
+                    clientFailed = true;
+                    break;
+                }
+                pending.assign(buffer, static_cast<size_t>(received));
+            }
+
+            if (decoder.failed()) {
+                close(upstream);
+                result.keepAlive = false;
+                fail(result, 400, "Bad Request");
+                return result;
+            }
+        }
+
+        if (clientFailed || !bodySent) {
+            close(upstream);
+            result.keepAlive = false;
+            if (clientFailed) {
+                fail(result, 400, "Bad Request");
+            } else {
+                fail(result, timedOut() ? 504 : 502, timedOut() ? "Gateway Timeout" : "Bad Gateway");
+            }
+            return result;
+        }
+
+        // Cabeçalho da resposta; respostas 1xx informativas são descartadas
+        std::string data;
+        UpstreamHead head;
+        size_t headerEnd = std::string::npos;
+        bool headFailed = false;
+        for (;;) {
+            headerEnd = data.find("\r\n\r\n");
+            if (headerEnd != std::string::npos) {
+                head = UpstreamHead();
+                if (!parseUpstreamHead(data, headerEnd, head)) {
+                    headFailed = true;
+                    break;
+                }
+                if (head.statusCode >= 100 && head.statusCode < 200 && head.statusCode != 101) {
+                    data.erase(0, headerEnd + 4);
+                    continue;
+                }
+                break;
+            }
+            if (data.size() > kMaxResponseHeaderBytes) {
+                headFailed = true;
+                break;
+            }
+            ssize_t received = recv(upstream, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                headFailed = true;
+                break;
+            }
+            data.append(buffer, static_cast<size_t>(received));
+        }
+
+        if (headFailed || head.statusCode == 101) {
+            close(upstream);
+            if (reused && data.empty() && requestFraming == BodyFraming::None && !timedOut()) {
+                continue;
+            }
+            if (requestFraming != BodyFraming::None) {
+                result.keepAlive = false;
+            }
+            fail(result, timedOut() ? 504 : 502, timedOut() ? "Gateway Timeout" : "Bad Gateway");
+            return result;
+        }
+
+        // Enquadramento da resposta e montagem do cabeçalho repassado ao cliente
+        BodyFraming responseFraming = BodyFraming::UntilClose;
+        uint64_t responseLength = 0;
+        bool upstreamKeepAlive = head.http11;
+        std::string upstreamConnection;
+        for (const auto& header : head.headers) {
+            std::string name = toLower(header.first);
+            if (name == "connection") {
+                upstreamConnection += header.second + ",";
+            } else if (name == "transfer-encoding" && containsToken(header.second, "chunked")) {
+                responseFraming = BodyFraming::Chunked;
+            } else if (name == "content-length" && responseFraming != BodyFraming::Chunked &&
+                       parseLength(header.second, responseLength)) {
+                responseFraming = BodyFraming::Length;
+            }
+        }
+        if (containsToken(upstreamConnection, "close")) {
+            upstreamKeepAlive = false;
+        } else if (!head.http11 && containsToken(upstreamConnection, "keep-alive")) {
+            upstreamKeepAlive = true;
+        }
+        if (request.method == "HEAD" || head.statusCode == 204 || head.statusCode == 304) {
+            responseFraming = BodyFraming::None;
+        }
+        if (responseFraming == BodyFraming::UntilClose) {
+            upstreamKeepAlive = false;
+            result.keepAlive = false;
+        }
+
+        std::ostringstream responseStream;
+        responseStream << "HTTP/1.1 " << head.statusCode << " " << head.statusText << "\r\n";
+        for (const auto& header : head.headers) {
+            if (!isHopByHop(toLower(header.first), upstreamConnection)) {
+                responseStream << header.first << ": " << header.second << "\r\n";
+            }
+        }
+        responseStream << (result.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+        std::string responseHead = responseStream.str();
+
+        result.responded = true;
+        result.statusCode = head.statusCode;
+        result.statusText = head.statusText;
+
+        bool capturing = capture != nullptr;
+        if (capturing) {
+            capture->statusCode = head.statusCode;
+            capture->statusText = head.statusText;
+            capture->headers.clear();
+            capture->body.clear();
+            for (const auto& header : head.headers) {
+                std::string name = toLower(header.first);
+                if (!isHopByHop(name, upstreamConnection) && name != "transfer-encoding" && name != "content-length") {
+                    capture->headers.push_back(header);
+                }
+            }
+        }
+
+        // Daqui em diante cada escrita ao cliente e cada leitura do backend têm prazo próprio:
+        // um repasse longo só expira quando para de progredir
+        deadline.cancel();
+        if (requestDeadline) {
+            requestDeadline->cancel();
+        }
+
+        // Sem cliente, só a cópia interessa
+        auto emit = [this, client](const char* data, size_t length) {
+            if (!client) {
+                return true;
+            }
+            SocketDeadline stall(timers_, client->socket, relayStall_);
+            return sendAll(client->socket, data, length);
+        };
+
+        // Avisa quem espera pela cópia uma única vez, antes de terminar o repasse ao cliente
+        bool published = false;
+        auto publish = [&](bool captured) {
+            if (capture && !published) {
+                published = true;
+                capture->complete = captured;
+                if (capture->onReady) {
+                    capture->onReady(*capture);
+                }
+            }
+        };
+
+        // Enquanto a cópia cabe no limite, o repasse fica retido em `held`: a resposta é publicada
+        // assim que o backend termina, sem depender da velocidade deste cliente
+        bool holding = capturing && client;
+        std::string held;
+        std::string pending = data.substr(headerEnd + 4);
+        bool clientOk = true;
+        if (holding) {
+            held = std::move(responseHead);
+        } else {
+            clientOk = emit(responseHead.data(), responseHead.size());
+        }
+        bool upstreamOk = true;
+        bool complete = false;
+        uint64_t remaining = responseLength;
+        ChunkedDecoder decoder;
+
+        while (clientOk) {
+            size_t usable = pending.size();
+            if (responseFraming == BodyFraming::None) {
+                usable = 0;
+            } else if (responseFraming == BodyFraming::Length) {
+                usable = static_cast<size_t>(std::min<uint64_t>(remaining, pending.size()));
+                remaining -= usable;
+            } else if (responseFraming == BodyFraming::Chunked) {
+                usable = decoder.feed(pending.data(), pending.size(), capturing ? &capture->body : nullptr);
+            }
+
+            if (capturing && responseFraming != BodyFraming::Chunked) {
+                capture->body.append(pending.data(), usable);
+            }
+            if (capturing && capture->body.size() > capture->maxBodyBytes) {
+                // Grande demais para o cache: o repasse ao cliente continua sem a cópia
+                capturing = false;
+                capture->body.clear();
+                publish(false);
+                if (!client) {
+                    upstreamOk = false;
+                    break;
+                }
+                if (holding) {
+                    holding = false;
+                    clientOk = emit(held.data(), held.size());
+                    held = std::string();
+                }
+            }
+
+            if (holding) {
+                held.append(pending.data(), usable);
+            } else if (clientOk) {
+                clientOk = emit(pending.data(), usable);
+            }
+            if (usable < pending.size()) {
+                // Dados além do fim da mensagem: o backend não é confiável para reuso
+                upstreamKeepAlive = false;
+            }
+
+            if (responseFraming == BodyFraming::None ||
+                (responseFraming == BodyFraming::Length && remaining == 0) ||
+                (responseFraming == BodyFraming::Chunked && decoder.done())) {
+                complete = true;
+                break;
+            }
+            if (decoder.failed()) {
+                upstreamOk = false;
+                break;
+            }
+
+            size_t toRead = sizeof(buffer);
+            if (responseFraming == BodyFraming::Length) {
+                toRead = static_cast<size_t>(std::min<uint64_t>(remaining, sizeof(buffer)));
+            }
+            ssize_t received;
+            {
+                SocketDeadline readDeadline(timers_, upstream, config_.responseTimeoutSeconds);
+                received = recv(upstream, buffer, toRead, 0);
+            }
+            if (received <= 0) {
+                complete = responseFraming == BodyFraming::UntilClose && received == 0;
+                upstreamOk = complete;
+                break;
+            }
+            pending.assign(buffer, static_cast<size_t>(received));
+        }
+
+        // O backend já terminou: a conexão volta ao pool antes da escrita retida ao cliente
+        publish(capturing && upstreamOk && complete);
+        if (upstreamOk && complete && upstreamKeepAlive) {
+            pool.release(*backend, upstream, config_.maxIdlePerBackend);
+        } else {
+            close(upstream);
+        }
+        if (holding && clientOk) {
+            clientOk = emit(held.data(), held.size());
+        }
+
+        if (!clientOk || !upstreamOk) {
+            // Resposta truncada: o cliente só percebe pelo fechamento da conexão
+            result.keepAlive = false;
+        }
+        return result;
+    }
+}
+
+bool ProxyHandler::parseRoutes(const std::string& spec, BalancePolicy policy, std::vector<ProxyRoute>& routes) {
+    std::istringstream routeStream(spec);
+    std::string item;
+    while (std::getline(routeStream, item, ';')) {
+        if (item.empty()) {
+            continue;
+        }
+
+        size_t equals = item.find('=');
+        if (equals == std::string::npos || equals == 0 || item[0] != '/') {
+            return false;
+        }
+
+        ProxyRoute route;
+        route.prefix = item.substr(0, equals);
+        route.policy = policy;
+
+        std::istringstream backendStream(item.substr(equals + 1));
+        std::string backend;
+        while (std::getline(backendStream, backend, ',')) {
+            size_t colon = backend.rfind(':');
+            if (colon == std::string::npos || colon == 0 || colon + 1 == backend.size()) {
+                return false;
+            }
+            route.backends.push_back(backend);
+        }
+        if (route.backends.empty()) {
+            return false;
+        }
+        routes.push_back(std::move(route));
+    }
+    return !routes.empty();
+}
+
+bool ProxyHandler::checkBackend(const Backend& backend) {
+    SOCKET socket = connectWithTimeout(backend.host, backend.port, config_.connectTimeoutMs);
+    if (socket < 0) {
+        return false;
+    }
+
+    SocketDeadline deadline(timers_, socket, std::chrono::milliseconds(config_.connectTimeoutMs));
+    std::string probe = "GET " + config_.healthCheckPath + " HTTP/1.1\r\nHost: " + backend.host +
+                        "\r\nConnection: close\r\n\r\n";
+
+    char status[16] = {};
+    size_t received = 0;
+    if (sendAll(socket, probe.data(), probe.size())) {
+        while (received < 12) {
+            ssize_t n = recv(socket, status + received, 12 - received, 0);
+            if (n <= 0) {
+                break;
+            }
+            received += static_cast<size_t>(n);
+        }
+        // Lê o restante até o backend fechar, evitando um RST do lado dele
+        char discard[1024];
+        while (received == 12 && recv(socket, discard, sizeof(discard), 0) > 0) {
+        }
+    }
+    close(socket);
+
+    // "HTTP/1.1 200": saudável com 2xx ou 3xx
+    return received == 12 && std::string(status, 5) == "HTTP/" && (status[9] == '2' || status[9] == '3');
+}
+
+void ProxyHandler::healthCheckLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        lock.unlock();
+        for (auto& route : routes_) {
+            for (auto& backend : route.group->backends()) {
+                bool healthy = checkBackend(*backend);
+                if (backend->healthy.exchange(healthy) != healthy) {
+                    std::string address = backend->host + ":" + std::to_string(backend->port);
+                    if (healthy) {
+                        Logger::getInstance().info("Proxy backend " + address + " is healthy again");
+                    } else {
+                        Logger::getInstance().warning("Proxy backend " + address + " marked unhealthy");
+                    }
+                }
+            }
+        }
+        lock.lock();
+        condition_.wait_for(lock, std::chrono::milliseconds(config_.healthCheckIntervalMs),
+                            [this] { return !running_; });
+    }
+}
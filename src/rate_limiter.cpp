@@ -0,0 +1,198 @@
+#include "rate_limiter.h"
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+#include <mutex>
+
+#include <arpa/inet.h>
+
+namespace {
+
+constexpr int64_t kNanosPerSecond = 1000000000;
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+RateLimiter::RateLimiter(const RateLimitConfig& config)
+    : config_(config),
+      addressLimit_(makeLimit(config.requestsPerSecond, config.burst)),
+      idleNs_(static_cast<int64_t>(std::max(config.idleSeconds, 1)) * kNanosPerSecond),
+      shards_(std::make_unique<Shard[]>(kShards)),
+      bucketCount_(0),
+      limited_(0),
+      untracked_(0) {
+    // Prefixos mais longos primeiro: "/api/login" vale antes de "/api"
+    std::stable_sort(config_.paths.begin(), config_.paths.end(), [](const RateLimitRule& a, const RateLimitRule& b) {
+        return a.prefix.size() > b.prefix.size();
+    });
+    for (const auto& rule : config_.paths) {
+        pathLimits_.push_back(makeLimit(rule.requestsPerSecond, rule.burst));
+    }
+}
+
+bool RateLimiter::enabled() const {
+    return addressLimit_.intervalNs > 0 || !pathLimits_.empty();
+}
+
+RateLimiter::Limit RateLimiter::makeLimit(double requestsPerSecond, uint32_t burst) {
+    Limit limit;
+    if (requestsPerSecond <= 0) {
+        return limit;
+    }
+    if (burst == 0) {
+        burst = static_cast<uint32_t>(std::max(2 * requestsPerSecond, 1.0));
+    }
+    limit.intervalNs = static_cast<int64_t>(kNanosPerSecond / requestsPerSecond);
+    limit.toleranceNs = limit.intervalNs * static_cast<int64_t>(burst - 1);
+    return limit;
+}
+
+bool RateLimiter::admit(const std::string& address, const std::string& path, int& retryAfterSeconds) {
+    // Conexão por socket Unix: processo local, sem IP para separar os clientes
+    if (address.empty()) {
+        return true;
+    }
+    Key key{0, 0, 0};
+    in_addr v4;
+    in6_addr v6;
+    if (inet_pton(AF_INET, address.c_str(), &v4) == 1) {
+        key.high = 0;
+        key.low = (uint64_t{0xffff} << 32) | ntohl(v4.s_addr);
+    } else if (inet_pton(AF_INET6, address.c_str(), &v6) == 1) {
+        std::memcpy(&key.high, v6.s6_addr, sizeof(key.high));
+        std::memcpy(&key.low, v6.s6_addr + sizeof(key.high), sizeof(key.low));
+    }
+
+    int64_t now = nowNanos();
+    int64_t waitNs = 0;
+    bool admitted = true;
+
+    if (addressLimit_.intervalNs > 0) {
+        admitted = take(key, addressLimit_, now, waitNs);
+    }
+    for (size_t i = 0; admitted && i < pathLimits_.size(); ++i) {
+        if (path.compare(0, config_.paths[i].prefix.size(), config_.paths[i].prefix) == 0) {
+            key.rule = static_cast<uint32_t>(i + 1);
+            admitted = take(key, pathLimits_[i], now, waitNs);
+            break;
+        }
+    }
+
+    if (!admitted) {
+        limited_.fetch_add(1, std::memory_order_relaxed);
+        retryAfterSeconds = static_cast<int>((waitNs + kNanosPerSecond - 1) / kNanosPerSecond);
+        retryAfterSeconds = std::max(retryAfterSeconds, 1);
+    }
+    return admitted;
+}
+
+bool RateLimiter::take(const Key& key, const Limit& limit, int64_t now, int64_t& waitNs) {
+    size_t hash = KeyHash()(key);
+    Shard& shard = shards_[(hash >> 32) % kShards];
+
+    // Caminho comum: cliente conhecido, só leitura no mapa
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.buckets.find(key);
+        if (it != shard.buckets.end()) {
+            return consume(it->second, limit, now, waitNs);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (now >= shard.nextSweepNs) {
+        sweep(shard, now);
+    }
+    auto it = shard.buckets.find(key);
+    if (it == shard.buckets.end()) {
+        if (bucketCount_.load(std::memory_order_relaxed) >= config_.maxBuckets) {
+            untracked_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        it = shard.buckets.try_emplace(key, 0).first;
+        bucketCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return consume(it->second, limit, now, waitNs);
+}
+
+bool RateLimiter::consume(std::atomic<int64_t>& bucket, const Limit& limit, int64_t now, int64_t& waitNs) {
+    int64_t next = bucket.load(std::memory_order_relaxed);
+    for (;;) {
+        int64_t start = std::max(next, now);
+        if (start - now > limit.toleranceNs) {
+            waitNs = start - now - limit.toleranceNs;
+            return false;
+        }
+        if (bucket.compare_exchange_weak(next, start + limit.intervalNs, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+// Chamado com o lock exclusivo do shard
+void RateLimiter::sweep(Shard& shard, int64_t now) {
+    size_t removed = 0;
+    for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+        // Balde que já voltou a encher há mais de idleNs: recriá-lo dá o mesmo resultado
+        if (it->second.load(std::memory_order_relaxed) + idleNs_ < now) {
+            it = shard.buckets.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    bucketCount_.fetch_sub(removed, std::memory_order_relaxed);
+    shard.nextSweepNs = now + idleNs_ / 4;
+}
+
+RateLimiterStats RateLimiter::stats() const {
+    RateLimiterStats stats;
+    stats.limited = limited_.load(std::memory_order_relaxed);
+    stats.untracked = untracked_.load(std::memory_order_relaxed);
+    stats.buckets = bucketCount_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t RateLimiter::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = key.high * 0x9e3779b97f4a7c15ULL ^ key.low;
+    hash ^= (hash >> 31) ^ (uint64_t{key.rule} << 7);
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    return static_cast<size_t>(hash ^ (hash >> 29));
+}
+
+bool RateLimiter::parseRules(const std::string& spec, std::vector<RateLimitRule>& rules) {
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ';')) {
+        if (item.empty()) {
+            continue;
+        }
+        size_t equals = item.find('=');
+        if (equals == std::string::npos || equals == 0 || item[0] != '/') {
+            return false;
+        }
+
+        RateLimitRule rule;
+        rule.prefix = item.substr(0, equals);
+        std::string limit = item.substr(equals + 1);
+        size_t colon = limit.find(':');
+        try {
+            rule.requestsPerSecond = std::stod(limit.substr(0, colon));
+            if (colon != std::string::npos) {
+                rule.burst = static_cast<uint32_t>(std::stoul(limit.substr(colon + 1)));
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (rule.requestsPerSecond <= 0) {
+            return false;
+        }
+        rules.push_back(rule);
+    }
+    return true;
+}
@@ -0,0 +1,184 @@
+#include "request_body.h"
+#include "socket_io.h"
+#include <algorithm>
+
+#include <sys/socket.h>
+
+namespace {
+
+constexpr size_t kReadChunkBytes = 16 * 1024;
+
+}
+
+BodyReader::BodyReader(Connection& connection, Framing framing, uint64_t contentLength,
+                       uint64_t maxBytes, bool expectContinue)
+    : connection_(&connection), framing_(framing), remaining_(contentLength), maxBytes_(maxBytes),
+      expectContinue_(expectContinue), complete_(framing == Framing::None) {
+    if (framing_ == Framing::Length && remaining_ == 0) {
+        complete_ = true;
+    }
+    if (framing_ == Framing::Length && remaining_ > maxBytes_) {
+        fail(413);
+    }
+}
+
+BodyReader::BodyReader(std::string body)
+    : connection_(nullptr), framing_(Framing::Buffered), buffered_(std::move(body)),
+      remaining_(buffered_.size()), maxBytes_(buffered_.size()), expectContinue_(false),
+      complete_(buffered_.empty()) {
+}
+
+bool BodyReader::read(std::string& chunk) {
+    chunk.clear();
+    if (complete_ || errorStatus_ != 0) {
+        return false;
+    }
+
+    if (framing_ == Framing::Buffered) {
+        started_ = true;
+        size_t take = std::min(buffered_.size() - bufferedOffset_, kReadChunkBytes);
+        chunk.assign(buffered_, bufferedOffset_, take);
+        bufferedOffset_ += take;
+        bytesRead_ += take;
+        complete_ = bufferedOffset_ == buffered_.size();
+        return true;
+    }
+
+    if (!started_) {
+        started_ = true;
+        static const char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+        if (expectContinue_ && connection_->readBuffer.empty() &&
+            !sendAll(connection_->socket, kContinue, sizeof(kContinue) - 1)) {
+            fail(400);
+            return false;
+        }
+    }
+
+    std::string& buffer = connection_->readBuffer;
+
+    if (framing_ == Framing::Length) {
+        if (buffer.empty()) {
+            // Sem bytes pendentes: recebe direto no bloco, sem passar pelo buffer da conexão
+            chunk.resize(static_cast<size_t>(std::min<uint64_t>(remaining_, kReadChunkBytes)));
+            ssize_t received = connection_->receive(&chunk[0], chunk.size());
+            if (received <= 0) {
+                chunk.clear();
+                fail(400);
+                return false;
+            }
+            chunk.resize(static_cast<size_t>(received));
+        } else {
+            size_t take = static_cast<size_t>(std::min<uint64_t>({remaining_, buffer.size(), kReadChunkBytes}));
+            chunk.assign(buffer, 0, take);
+            buffer.erase(0, take);
+        }
+
+        remaining_ -= chunk.size();
+        bytesRead_ += chunk.size();
+        complete_ = remaining_ == 0;
+        return true;
+    }
+
+    // Chunked: decodifica o que houver no buffer até produzir dados ou terminar a mensagem
+    while (chunk.empty()) {
+        if (buffer.empty() && !receiveMore()) {
+            return false;
+        }
+
+        size_t limit = std::min(buffer.size(), kReadChunkBytes);
+        size_t used = decoder_.feed(buffer.data(), limit, &chunk);
+        buffer.erase(0, used);
+
+        if (decoder_.failed()) {
+            chunk.clear();
+            fail(400);
+            return false;
+        }
+
+        bytesRead_ += chunk.size();
+        if (bytesRead_ > maxBytes_) {
+            chunk.clear();
+            fail(413);
+            return false;
+        }
+
+        if (decoder_.done()) {
+            complete_ = true;
+            return !chunk.empty();
+        }
+    }
+    return true;
+}
+
+bool BodyReader::readAll(std::string& body, size_t maxBytes) {
+    if (framing_ == Framing::Length && remaining_ > maxBytes) {
+        fail(413);
+        return false;
+    }
+
+    std::string chunk;
+    while (read(chunk)) {
+        if (body.size() + chunk.size() > maxBytes) {
+            fail(413);
+            return false;
+        }
+        body += chunk;
+    }
+    return errorStatus_ == 0;
+}
+
+bool BodyReader::drain(size_t maxBytes) {
+    if (complete_) {
+        return true;
+    }
+    // Cliente aguardando "100 Continue" que nunca foi enviado: não há corpo a descartar com segurança
+    if (errorStatus_ != 0 || (expectContinue_ && !started_)) {
+        return false;
+    }
+    if (framing_ == Framing::Length && remaining_ > maxBytes) {
+        return false;
+    }
+
+    std::string chunk;
+    uint64_t discarded = 0;
+    while (read(chunk)) {
+        discarded += chunk.size();
+        if (discarded > maxBytes) {
+            return false;
+        }
+    }
+    return complete_;
+}
+
+bool BodyReader::complete() const {
+    return complete_;
+}
+
+bool BodyReader::started() const {
+    return started_;
+}
+
+int BodyReader::errorStatus() const {
+    return errorStatus_;
+}
+
+uint64_t BodyReader::bytesRead() const {
+    return bytesRead_;
+}
+
+bool BodyReader::receiveMore() {
+    char buffer[kReadChunkBytes];
+    ssize_t received = connection_->receive(buffer, sizeof(buffer));
+    if (received <= 0) {
+        fail(400);
+        return false;
+    }
+    connection_->readBuffer.append(buffer, static_cast<size_t>(received));
+    return true;
+}
+
+void BodyReader::fail(int status) {
+    if (errorStatus_ == 0) {
+        errorStatus_ = status;
+    }
+}
@@ -0,0 +1,273 @@
+#include "request_lanes.h"
+#include <algorithm>
+#include <sstream>
+#include <strings.h>
+
+#include <sys/socket.h>
+
+namespace {
+
+constexpr size_t kMaxLanes = 16;
+constexpr size_t kPeekBytes = 2048;     // Linha de requisição e os primeiros headers
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+// Caminho da linha de requisição ("GET /api/x?y HTTP/1.1" -> "/api/x"); vazio se não for HTTP/1
+std::string requestPath(const std::string& head) {
+    size_t start = head.find(' ');
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = head.find_first_of(" ?\r\n", start + 1);
+    if (end == std::string::npos) {
+        return "";
+    }
+    return head.substr(start + 1, end - start - 1);
+}
+
+// Valor do header `name` dentro do trecho espiado; false se não aparece nele
+bool headerValue(const std::string& head, const std::string& name, std::string& value) {
+    size_t lineStart = head.find("\r\n");
+    while (lineStart != std::string::npos) {
+        lineStart += 2;
+        size_t lineEnd = head.find("\r\n", lineStart);
+        if (lineEnd == std::string::npos || lineEnd == lineStart) {
+            return false;
+        }
+        if (lineEnd - lineStart > name.size() && head[lineStart + name.size()] == ':' &&
+            strncasecmp(head.c_str() + lineStart, name.c_str(), name.size()) == 0) {
+            size_t valueStart = head.find_first_not_of(' ', lineStart + name.size() + 1);
+            value = valueStart < lineEnd ? head.substr(valueStart, lineEnd - valueStart) : "";
+            return true;
+        }
+        lineStart = lineEnd;
+    }
+    return false;
+}
+
+} // namespace
+
+bool LanesConfig::parseLanes(const std::string& spec, std::vector<LaneConfig>& lanes) {
+    for (const auto& item : split(spec, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        std::vector<std::string> fields = split(item, ':');
+        if (fields.empty() || fields.size() > 3 || fields[0].empty()) {
+            return false;
+        }
+
+        LaneConfig lane;
+        lane.name = fields[0];
+        try {
+            if (fields.size() > 1) {
+                lane.weight = static_cast<uint32_t>(std::stoul(fields[1]));
+            }
+            if (fields.size() > 2) {
+                lane.maxActive = std::stoul(fields[2]);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        bool duplicate = std::any_of(lanes.begin(), lanes.end(), [&lane](const LaneConfig& other) {
+            return other.name == lane.name;
+        });
+        if (lane.weight == 0 || duplicate) {
+            return false;
+        }
+        lanes.push_back(lane);
+    }
+
+    if (!lanes.empty() && std::none_of(lanes.begin(), lanes.end(), [](const LaneConfig& lane) {
+            return lane.name == "default";
+        })) {
+        lanes.push_back({"default", 1, 0});
+    }
+    return lanes.size() <= kMaxLanes;
+}
+
+bool LanesConfig::parseRules(const std::string& spec, LanesConfig& config) {
+    for (const auto& item : split(spec, ';')) {
+        if (item.empty()) {
+            continue;
+        }
+        size_t equals = item.rfind('=');
+        size_t colon = item.find(':');
+        if (equals == std::string::npos || colon == std::string::npos || colon > equals) {
+            return false;
+        }
+
+        std::string laneName = item.substr(equals + 1);
+        auto lane = std::find_if(config.lanes.begin(), config.lanes.end(), [&laneName](const LaneConfig& candidate) {
+            return candidate.name == laneName;
+        });
+        if (lane == config.lanes.end()) {
+            return false;
+        }
+
+        LaneRule rule;
+        rule.lane = static_cast<uint8_t>(lane - config.lanes.begin());
+        std::string kind = item.substr(0, colon);
+        std::string match = item.substr(colon + 1, equals - colon - 1);
+        if (kind == "path") {
+            rule.kind = LaneRule::Kind::Path;
+        } else if (kind == "header") {
+            rule.kind = LaneRule::Kind::Header;
+            size_t valueColon = match.find(':');
+            if (valueColon != std::string::npos) {
+                rule.value = match.substr(valueColon + 1);
+                match.resize(valueColon);
+            }
+        } else if (kind == "client") {
+            rule.kind = LaneRule::Kind::Client;
+        } else {
+            return false;
+        }
+        if (match.empty()) {
+            return false;
+        }
+        rule.match = match;
+        config.rules.push_back(rule);
+    }
+    return true;
+}
+
+RequestLanes::RequestLanes(const LanesConfig& config)
+    : rules_(config.rules),
+      defaultLane_(0),
+      needsRequest_(false) {
+    for (size_t i = 0; i < config.lanes.size(); ++i) {
+        lanes_.push_back(std::make_unique<Lane>());
+        lanes_.back()->config = config.lanes[i];
+        if (config.lanes[i].name == "default") {
+            defaultLane_ = static_cast<uint8_t>(i);
+        }
+    }
+    if (lanes_.empty()) {
+        lanes_.push_back(std::make_unique<Lane>());
+        lanes_.back()->config.name = "default";
+    }
+    for (const auto& rule : rules_) {
+        needsRequest_ = needsRequest_ || rule.kind != LaneRule::Kind::Client;
+    }
+}
+
+size_t RequestLanes::count() const {
+    return lanes_.size();
+}
+
+bool RequestLanes::classify(Connection& connection) const {
+    connection.lane = defaultLane_;
+
+    std::string head;
+    if (needsRequest_) {
+        if (!connection.readBuffer.empty()) {
+            head = connection.readBuffer.substr(0, kPeekBytes);
+        } else {
+            char buffer[kPeekBytes];
+            long received = recv(connection.socket, buffer, sizeof(buffer), MSG_PEEK | MSG_DONTWAIT);
+            if (received > 0) {
+                head.assign(buffer, static_cast<size_t>(received));
+            }
+        }
+    }
+
+    for (const auto& rule : rules_) {
+        // Regra de caminho ou header antes de a requisição chegar: decidir agora seria adivinhar
+        if (rule.kind != LaneRule::Kind::Client && head.empty()) {
+            return false;
+        }
+        if (matches(rule, connection, head)) {
+            connection.lane = rule.lane;
+            break;
+        }
+    }
+    return true;
+}
+
+bool RequestLanes::matches(const LaneRule& rule, const Connection& connection, const std::string& head) const {
+    switch (rule.kind) {
+        case LaneRule::Kind::Path: {
+            std::string path = requestPath(head);
+            return !path.empty() && path.compare(0, rule.match.size(), rule.match) == 0;
+        }
+        case LaneRule::Kind::Header: {
+            std::string value;
+            return headerValue(head, rule.match, value) &&
+                   strncasecmp(value.c_str(), rule.value.c_str(), rule.value.size()) == 0;
+        }
+        default:
+            if (rule.match == "unix") {
+                return connection.peerAddress.empty();
+            }
+            return connection.peerAddress.compare(0, rule.match.size(), rule.match) == 0;
+    }
+}
+
+uint32_t RequestLanes::weight(uint8_t lane) const {
+    return lanes_[lane]->config.weight;
+}
+
+int64_t RequestLanes::costMicros(uint8_t lane) const {
+    return lanes_[lane]->costMicros.load(std::memory_order_relaxed);
+}
+
+bool RequestLanes::admits(uint8_t lane) const {
+    const Lane& current = *lanes_[lane];
+    return current.config.maxActive == 0 || current.active.load(std::memory_order_relaxed) < current.config.maxActive;
+}
+
+bool RequestLanes::limited(uint8_t lane) const {
+    return lanes_[lane]->config.maxActive > 0;
+}
+
+bool RequestLanes::tryStart(uint8_t lane, std::chrono::steady_clock::duration waited) {
+    Lane& current = *lanes_[lane];
+    size_t active = current.active.load(std::memory_order_relaxed);
+    do {
+        if (current.config.maxActive > 0 && active >= current.config.maxActive) {
+            return false;
+        }
+    } while (!current.active.compare_exchange_weak(active, active + 1, std::memory_order_relaxed));
+
+    current.served.fetch_add(1, std::memory_order_relaxed);
+    current.waitMicros.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(waited).count(),
+                                 std::memory_order_relaxed);
+    return true;
+}
+
+void RequestLanes::finished(uint8_t lane, std::chrono::steady_clock::duration busy) {
+    Lane& current = *lanes_[lane];
+    current.active.fetch_sub(1, std::memory_order_relaxed);
+
+    // Média móvel (1/8): acompanha mudanças de perfil sem oscilar a cada requisição
+    int64_t sample = std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(busy).count(), 1);
+    int64_t cost = current.costMicros.load(std::memory_order_relaxed);
+    current.costMicros.store(std::max<int64_t>(cost + (sample - cost) / 8, 1), std::memory_order_relaxed);
+}
+
+std::vector<LaneStats> RequestLanes::stats() const {
+    std::vector<LaneStats> stats;
+    for (const auto& lane : lanes_) {
+        LaneStats current;
+        current.name = lane->config.name;
+        current.weight = lane->config.weight;
+        current.maxActive = lane->config.maxActive;
+        current.active = lane->active.load(std::memory_order_relaxed);
+        current.served = lane->served.load(std::memory_order_relaxed);
+        current.costMicros = static_cast<uint64_t>(lane->costMicros.load(std::memory_order_relaxed));
+        if (current.served > 0) {
+            current.waitMicros = lane->waitMicros.load(std::memory_order_relaxed) / current.served;
+        }
+        stats.push_back(current);
+    }
+    return stats;
+}
@@ -0,0 +1,407 @@
+#include "response_cache.h"
+#include "http_handler.h"
+#include "http_utils.h"
+#include "logger.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value;
+}
+
+std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    return value.substr(start, value.find_last_not_of(" \t") - start + 1);
+}
+
+// Diretivas de Cache-Control em minúsculas; valores sem aspas
+std::unordered_map<std::string, std::string> parseCacheControl(const std::string& value) {
+    std::unordered_map<std::string, std::string> directives;
+    std::istringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item = trim(item);
+        if (item.empty()) {
+            continue;
+        }
+        size_t equals = item.find('=');
+        std::string name = toLower(trim(item.substr(0, equals)));
+        std::string argument;
+        if (equals != std::string::npos) {
+            argument = trim(item.substr(equals + 1));
+            if (argument.size() >= 2 && argument.front() == '"' && argument.back() == '"') {
+                argument = argument.substr(1, argument.size() - 2);
+            }
+        }
+        directives[name] = argument;
+    }
+    return directives;
+}
+
+bool parseSeconds(const std::string& value, int64_t& seconds) {
+    if (value.empty() || value.size() > 10 ||
+        !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return false;
+    }
+    seconds = std::stoll(value);
+    return true;
+}
+
+// Status armazenáveis sem validade explícita restrita (RFC 9110 15.1)
+bool isCacheableStatus(int statusCode) {
+    switch (statusCode) {
+        case 200: case 203: case 204: case 300: case 301: case 308:
+        case 404: case 405: case 410: case 414: case 501:
+            return true;
+        default:
+            return false;
+    }
+}
+
+const std::string* findHeader(const std::vector<std::pair<std::string, std::string>>& headers, const char* name) {
+    for (const auto& header : headers) {
+        if (toLower(header.first) == name) {
+            return &header.second;
+        }
+    }
+    return nullptr;
+}
+
+std::string requestHeader(const HttpRequest& request, const std::string& name) {
+    auto it = request.headers.find(name);
+    return it != request.headers.end() ? it->second : "";
+}
+
+}
+
+struct ResponseCache::Flight {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool done = false;
+    std::shared_ptr<const CachedResponse> response;
+};
+
+bool CachedResponse::matchesRequest(const HttpRequest& request) const {
+    for (const auto& header : vary) {
+        if (requestHeader(request, header.first) != header.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int64_t CachedResponse::ageSeconds(Clock::time_point now) const {
+    return initialAge + std::chrono::duration_cast<std::chrono::seconds>(now - storedAt).count();
+}
+
+size_t CachedResponse::sizeBytes() const {
+    size_t total = sizeof(*this) + statusText.size() + (body ? body->size() : 0);
+    for (const auto& header : headers) {
+        total += header.first.size() + header.second.size();
+    }
+    for (const auto& header : vary) {
+        total += header.first.size() + header.second.size();
+    }
+    return total;
+}
+
+ResponseCache::ResponseCache(const ResponseCacheConfig& config, Fetcher fetcher)
+    : config_(config), fetcher_(std::move(fetcher)) {
+    size_t shards = std::max<size_t>(1, config_.shards);
+    shardBytes_ = config_.cacheBytes / shards;
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+    revalidationThread_ = std::thread(&ResponseCache::revalidationLoop, this);
+}
+
+ResponseCache::~ResponseCache() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        running_ = false;
+    }
+    queueCondition_.notify_all();
+    if (revalidationThread_.joinable()) {
+        revalidationThread_.join();
+    }
+}
+
+bool ResponseCache::isCacheableRequest(const HttpRequest& request) {
+    if (request.method != "GET" || request.headers.count("authorization")) {
+        return false;
+    }
+
+    auto directives = parseCacheControl(requestHeader(request, "cache-control"));
+    if (directives.count("no-store") || directives.count("no-cache")) {
+        return false;
+    }
+    return toLower(requestHeader(request, "pragma")).find("no-cache") == std::string::npos;
+}
+
+std::string ResponseCache::makeKey(const HttpRequest& request) {
+    // Os mesmos bytes que o proxy envia ao backend: alvos que chegam iguais lá dividem a entrada,
+    // alvos diferentes nunca
+    std::string key = request.method + " " + toLower(requestHeader(request, "host")) + " ";
+    key += encodeRequestTarget(request.path, request.query);
+    return key;
+}
+
+std::shared_ptr<const CachedResponse> ResponseCache::makeEntry(const HttpRequest& request, int statusCode,
+                                                               std::string statusText,
+                                                               std::vector<std::pair<std::string, std::string>> headers,
+                                                               std::string body) {
+    if (!isCacheableStatus(statusCode) || findHeader(headers, "set-cookie")) {
+        return nullptr;
+    }
+
+    const std::string* cacheControl = findHeader(headers, "cache-control");
+    auto directives = parseCacheControl(cacheControl ? *cacheControl : "");
+    if (directives.count("no-store") || directives.count("private") || directives.count("no-cache")) {
+        return nullptr;
+    }
+
+    // Validade: s-maxage, depois max-age, depois Expires relativo a Date
+    int64_t lifetime = -1;
+    auto sharedMaxAge = directives.find("s-maxage");
+    auto maxAge = directives.find("max-age");
+    if (sharedMaxAge != directives.end()) {
+        parseSeconds(sharedMaxAge->second, lifetime);
+    } else if (maxAge != directives.end()) {
+        parseSeconds(maxAge->second, lifetime);
+    } else if (const std::string* expires = findHeader(headers, "expires")) {
+        time_t expiresAt = 0;
+        time_t date = time(nullptr);
+        const std::string* dateHeader = findHeader(headers, "date");
+        if (dateHeader) {
+            parseHttpDate(*dateHeader, date);
+        }
+        // Expires inválido (ex.: "0") significa já expirado
+        lifetime = parseHttpDate(*expires, expiresAt) ? std::max<int64_t>(0, expiresAt - date) : 0;
+    }
+    if (lifetime < 0) {
+        return nullptr;
+    }
+
+    int64_t staleWindow = 0;
+    auto staleIt = directives.find("stale-while-revalidate");
+    if (staleIt != directives.end()) {
+        parseSeconds(staleIt->second, staleWindow);
+    }
+
+    int64_t age = 0;
+    if (const std::string* ageHeader = findHeader(headers, "age")) {
+        parseSeconds(*ageHeader, age);
+    }
+    if (lifetime + staleWindow <= age) {
+        return nullptr;
+    }
+
+    auto entry = std::make_shared<CachedResponse>();
+    if (const std::string* vary = findHeader(headers, "vary")) {
+        std::istringstream stream(*vary);
+        std::string name;
+        while (std::getline(stream, name, ',')) {
+            name = toLower(trim(name));
+            if (name == "*") {
+                return nullptr;
+            }
+            if (!name.empty()) {
+                entry->vary.emplace_back(name, requestHeader(request, name));
+            }
+        }
+    }
+
+    headers.erase(std::remove_if(headers.begin(), headers.end(), [](const auto& header) {
+        return toLower(header.first) == "age";
+    }), headers.end());
+
+    auto now = CachedResponse::Clock::now();
+    entry->statusCode = statusCode;
+    entry->statusText = std::move(statusText);
+    entry->headers = std::move(headers);
+    entry->body = std::make_shared<const std::string>(std::move(body));
+    entry->initialAge = age;
+    entry->storedAt = now;
+    entry->freshUntil = now + std::chrono::seconds(std::max<int64_t>(0, lifetime - age));
+    entry->staleUntil = entry->freshUntil + std::chrono::seconds(staleWindow);
+    return entry;
+}
+
+ResponseCache::Shard& ResponseCache::shardFor(const std::string& key) {
+    return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+CacheLookup ResponseCache::lookup(const std::string& key, const HttpRequest& request,
+                                  std::shared_ptr<const CachedResponse>& entry) {
+    Shard& shard = shardFor(key);
+    auto now = CachedResponse::Clock::now();
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        return CacheLookup::Miss;
+    }
+
+    const auto& response = it->second->response;
+    if (now >= response->staleUntil) {
+        shard.bytes -= response->sizeBytes() + key.size();
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        return CacheLookup::Miss;
+    }
+    if (!response->matchesRequest(request)) {
+        return CacheLookup::Miss;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    entry = response;
+    return now < response->freshUntil ? CacheLookup::Fresh : CacheLookup::Stale;
+}
+
+void ResponseCache::store(const std::string& key, std::shared_ptr<const CachedResponse> entry) {
+    size_t bytes = entry->sizeBytes() + key.size();
+    if (bytes > shardBytes_) {
+        return;
+    }
+
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        shard.bytes -= it->second->response->sizeBytes() + key.size();
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+
+    shard.lru.push_front(Entry{key, std::move(entry)});
+    shard.index[key] = shard.lru.begin();
+    shard.bytes += bytes;
+    evict(shard);
+}
+
+void ResponseCache::setCapacity(size_t cacheBytes) {
+    shardBytes_.store(cacheBytes / shards_.size());
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        evict(*shard);
+    }
+}
+
+void ResponseCache::evict(Shard& shard) {
+    while (shard.bytes > shardBytes_ && !shard.lru.empty()) {
+        Entry& victim = shard.lru.back();
+        shard.bytes -= victim.response->sizeBytes() + victim.key.size();
+        shard.index.erase(victim.key);
+        shard.lru.pop_back();
+    }
+}
+
+std::shared_ptr<ResponseCache::Flight> ResponseCache::join(const std::string& key, bool& leader) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.flights.find(key);
+    if (it != shard.flights.end()) {
+        leader = false;
+        return it->second;
+    }
+
+    auto flight = std::make_shared<Flight>();
+    shard.flights.emplace(key, flight);
+    leader = true;
+    return flight;
+}
+
+void ResponseCache::complete(const std::string& key, const std::shared_ptr<Flight>& flight,
+                             std::shared_ptr<const CachedResponse> entry) {
+    if (entry) {
+        store(key, entry);
+    }
+
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.flights.erase(key);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(flight->mutex);
+        flight->done = true;
+        flight->response = std::move(entry);
+    }
+    flight->condition.notify_all();
+}
+
+std::shared_ptr<const CachedResponse> ResponseCache::wait(const std::shared_ptr<Flight>& flight) {
+    std::unique_lock<std::mutex> lock(flight->mutex);
+    flight->condition.wait_for(lock, std::chrono::seconds(config_.coalesceTimeoutSeconds),
+                               [&flight] { return flight->done; });
+    return flight->response;
+}
+
+void ResponseCache::revalidate(const std::string& key, const HttpRequest& request) {
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.revalidating.insert(key).second) {
+            return;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        queue_.push_back(Revalidation{key, std::make_shared<HttpRequest>(request)});
+    }
+    queueCondition_.notify_one();
+}
+
+void ResponseCache::revalidationLoop() {
+    for (;;) {
+        Revalidation job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueCondition_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+            if (!running_) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        auto entry = fetcher_(*job.request);
+        if (entry) {
+            store(job.key, std::move(entry));
+        } else {
+            LOG_LIMITED(Logger::Level::WARNING, 1, 10, "Response cache: revalidation of {} failed", job.key);
+        }
+
+        Shard& shard = shardFor(job.key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.revalidating.erase(job.key);
+    }
+}
+
+size_t ResponseCache::sizeBytes() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->bytes;
+    }
+    return total;
+}
+
+size_t ResponseCache::entries() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->index.size();
+    }
+    return total;
+}
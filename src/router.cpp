@@ -0,0 +1,143 @@
+#include "router.h"
+
+std::string allowHeader(uint32_t methods) {
+    std::string allow;
+    for (size_t i = 0; i < kHttpMethodCount; ++i) {
+        if (methods & (1u << i)) {
+            if (!allow.empty()) {
+                allow += ", ";
+            }
+            allow += methodName(static_cast<HttpMethod>(i));
+        }
+    }
+    return allow;
+}
+
+std::string_view RouteParams::get(std::string_view name) const {
+    for (const auto& value : values) {
+        if (value.first == name) {
+            return value.second;
+        }
+    }
+    return {};
+}
+
+RouteTrie::RouteTrie()
+    : root_(std::make_unique<Node>()) {
+}
+
+RouteTrie::~RouteTrie() = default;
+
+void RouteTrie::add(HttpMethod method, std::string_view pattern, Handler handler, bool streamBody) {
+    Node* node = root_.get();
+
+    size_t position = 0;
+    while (position < pattern.size()) {
+        size_t end = pattern.find('/', position);
+        if (end == std::string_view::npos) {
+            end = pattern.size();
+        }
+        std::string_view segment = pattern.substr(position, end - position);
+        position = end + 1;
+
+        if (segment.empty()) {
+            continue;
+        }
+        if (segment == "*") {
+            // O curinga consome o restante do caminho: segmentos depois dele são ignorados
+            if (!node->wildcard) {
+                node->wildcard = std::make_unique<Node>();
+            }
+            node = node->wildcard.get();
+            break;
+        }
+        if (segment.front() == ':') {
+            if (!node->param) {
+                node->param = std::make_unique<Node>();
+                node->paramName = std::string(segment.substr(1));
+            }
+            node = node->param.get();
+            continue;
+        }
+
+        auto& child = node->children[std::string(segment)];
+        if (!child) {
+            child = std::make_unique<Node>();
+        }
+        node = child.get();
+    }
+
+    if (method == HttpMethod::Other) {
+        return;
+    }
+    size_t index = static_cast<size_t>(method);
+    if (!(node->methods & (1u << index))) {
+        routes_++;
+    }
+    node->entries[index] = Entry{std::move(handler), streamBody};
+    node->methods |= 1u << index;
+}
+
+const RouteTrie::Entry* RouteTrie::find(HttpMethod method, std::string_view path, RouteParams& params,
+                                          uint32_t& allowed) const {
+    allowed = 0;
+    params.values.clear();
+
+    const Node* node = match(root_.get(), path, params);
+    if (!node) {
+        return nullptr;
+    }
+
+    allowed = node->methods;
+    if (method == HttpMethod::Other || !(node->methods & (1u << static_cast<size_t>(method)))) {
+        return nullptr;
+    }
+    return &node->entries[static_cast<size_t>(method)];
+}
+
+bool RouteTrie::empty() const {
+    return routes_ == 0;
+}
+
+// Segmentos literais têm precedência sobre parâmetros, que têm precedência sobre o curinga
+const RouteTrie::Node* RouteTrie::match(const Node* node, std::string_view remaining, RouteParams& params) {
+    while (!remaining.empty() && remaining.front() == '/') {
+        remaining.remove_prefix(1);
+    }
+
+    if (remaining.empty()) {
+        if (node->methods) {
+            return node;
+        }
+        if (node->wildcard && node->wildcard->methods) {
+            params.values.emplace_back("*", remaining);
+            return node->wildcard.get();
+        }
+        return nullptr;
+    }
+
+    size_t slash = remaining.find('/');
+    std::string_view segment = remaining.substr(0, slash);
+    std::string_view rest = slash == std::string_view::npos ? std::string_view() : remaining.substr(slash);
+
+    auto it = node->children.find(segment);
+    if (it != node->children.end()) {
+        if (const Node* found = match(it->second.get(), rest, params)) {
+            return found;
+        }
+    }
+
+    if (node->param) {
+        params.values.emplace_back(node->paramName, segment);
+        if (const Node* found = match(node->param.get(), rest, params)) {
+            return found;
+        }
+        params.values.pop_back();
+    }
+
+    if (node->wildcard && node->wildcard->methods) {
+        params.values.emplace_back("*", remaining);
+        return node->wildcard.get();
+    }
+    return nullptr;
+}
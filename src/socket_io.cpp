@@ -0,0 +1,177 @@
+#include "socket_io.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+
+SocketDeadline::SocketDeadline(TimerWheel& timers, SOCKET socket, std::chrono::milliseconds timeout)
+    : timers_(timers),
+      id_(timers.schedule(timeout, [socket] {
+          shutdown(socket, SHUT_RDWR);
+      })) {
+}
+
+SocketDeadline::SocketDeadline(TimerWheel& timers, SOCKET socket, int seconds)
+    : SocketDeadline(timers, socket, std::chrono::milliseconds(seconds * 1000LL)) {
+}
+
+SocketDeadline::~SocketDeadline() {
+    cancel();
+}
+
+void SocketDeadline::cancel() {
+    if (id_ != TimerWheel::kInvalidTimer) {
+        timers_.cancel(id_);
+        id_ = TimerWheel::kInvalidTimer;
+    }
+}
+
+bool sendAll(SOCKET socket, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(socket, data, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool sendVectored(SOCKET socket, std::vector<iovec>& buffers) {
+    size_t index = 0;
+    while (index < buffers.size()) {
+        msghdr message{};
+        message.msg_iov = &buffers[index];
+        message.msg_iovlen = std::min<size_t>(buffers.size() - index, IOV_MAX);
+
+        ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+
+        // Avança sobre os buffers enviados, ajustando o que foi parcialmente escrito
+        size_t remaining = static_cast<size_t>(sent);
+        while (index < buffers.size() && remaining >= buffers[index].iov_len) {
+            remaining -= buffers[index].iov_len;
+            index++;
+        }
+        if (remaining > 0) {
+            buffers[index].iov_base = static_cast<char*>(buffers[index].iov_base) + remaining;
+            buffers[index].iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+bool sendFileRange(SOCKET socket, int fd, uint64_t offset, uint64_t length) {
+    off_t position = static_cast<off_t>(offset);
+    while (length > 0) {
+        ssize_t sent = sendfile(socket, fd, &position, length);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        length -= static_cast<uint64_t>(sent);
+    }
+    return true;
+}
+
+bool sendVectoredWindowed(TimerWheel& timers, SOCKET socket, std::vector<iovec>& buffers,
+                          uint64_t window, std::chrono::milliseconds stall) {
+    size_t index = 0;
+    std::vector<iovec> slice;
+    while (index < buffers.size()) {
+        // Fatia os buffers em até `window` bytes, dividindo o último se preciso
+        slice.clear();
+        uint64_t bytes = 0;
+        while (index < buffers.size() && bytes < window) {
+            iovec& part = buffers[index];
+            size_t take = static_cast<size_t>(std::min<uint64_t>(part.iov_len, window - bytes));
+            slice.push_back({part.iov_base, take});
+            bytes += take;
+            if (take == part.iov_len) {
+                index++;
+            } else {
+                part.iov_base = static_cast<char*>(part.iov_base) + take;
+                part.iov_len -= take;
+            }
+        }
+
+        SocketDeadline deadline(timers, socket, stall);
+        if (!sendVectored(socket, slice)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sendFileWindowed(TimerWheel& timers, SOCKET socket, int fd, uint64_t offset, uint64_t length,
+                      uint64_t window, std::chrono::milliseconds stall) {
+    while (length > 0) {
+        uint64_t chunk = std::min(length, window);
+        SocketDeadline deadline(timers, socket, stall);
+        if (!sendFileRange(socket, fd, offset, chunk)) {
+            return false;
+        }
+        offset += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+SOCKET connectWithTimeout(const std::string& host, int port, int timeoutMs) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+        return -1;
+    }
+
+    SOCKET connected = -1;
+    for (addrinfo* address = result; address && connected < 0; address = address->ai_next) {
+        SOCKET sock = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                             address->ai_protocol);
+        if (sock < 0) {
+            continue;
+        }
+
+        int rc = connect(sock, address->ai_addr, address->ai_addrlen);
+        if (rc < 0 && errno == EINPROGRESS) {
+            pollfd pfd{sock, POLLOUT, 0};
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (poll(&pfd, 1, timeoutMs) == 1 &&
+                getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+                rc = 0;
+            }
+        }
+
+        if (rc == 0) {
+            fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) & ~O_NONBLOCK);
+            connected = sock;
+        } else {
+            close(sock);
+        }
+    }
+
+    freeaddrinfo(result);
+    return connected;
+}
@@ -0,0 +1,78 @@
+#include "socket_options.h"
+#include "logger.h"
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace {
+
+// Opção recusada (kernel antigo, sem permissão para SO_BUSY_POLL...) não impede o servidor de subir
+void setOption(SOCKET socket, int level, int name, int value, const char* label) {
+    if (setsockopt(socket, level, name, &value, sizeof(value)) < 0) {
+        LOG_LIMITED(Logger::Level::WARNING, 1, 5, "Socket option {} = {} not applied: {}", label, value, strerror(errno));
+    }
+}
+
+} // namespace
+
+bool SocketOptions::fromProfile(const std::string& name, SocketOptions& options) {
+    options = SocketOptions{};
+    if (name.empty() || name == "default") {
+        return true;
+    }
+    if (name == "latency") {
+        // Cada resposta sai na hora; TFO e defer accept economizam uma volta e um despertar
+        options.noDelay = true;
+        options.fastOpenQueue = 256;
+        options.deferAcceptSeconds = 1;
+        options.busyPollMicros = 50;
+        return true;
+    }
+    if (name == "throughput") {
+        // Menos segmentos e menos despertares por resposta; fila de aceitação maior para picos
+        options.backlog = 4096;
+        options.deferAcceptSeconds = 1;
+        options.noDelay = true;     // O uncork empurra o resto imediatamente
+        options.cork = true;
+        options.sendBuffer = 4 * 1024 * 1024;
+        options.receiveBuffer = 1024 * 1024;
+        return true;
+    }
+    return false;
+}
+
+void applyListenerOptions(SOCKET socket, const SocketOptions& options) {
+    if (options.receiveBuffer > 0) {
+        setOption(socket, SOL_SOCKET, SO_RCVBUF, options.receiveBuffer, "SO_RCVBUF");
+    }
+    if (options.sendBuffer > 0) {
+        setOption(socket, SOL_SOCKET, SO_SNDBUF, options.sendBuffer, "SO_SNDBUF");
+    }
+    applyListeningOptions(socket, options);
+}
+
+void applyListeningOptions(SOCKET socket, const SocketOptions& options) {
+    if (options.deferAcceptSeconds > 0) {
+        setOption(socket, IPPROTO_TCP, TCP_DEFER_ACCEPT, options.deferAcceptSeconds, "TCP_DEFER_ACCEPT");
+    }
+    if (options.fastOpenQueue > 0) {
+        setOption(socket, IPPROTO_TCP, TCP_FASTOPEN, options.fastOpenQueue, "TCP_FASTOPEN");
+    }
+}
+
+void applyConnectionOptions(SOCKET socket, const SocketOptions& options) {
+    if (options.noDelay) {
+        setOption(socket, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+    }
+    if (options.busyPollMicros > 0) {
+        setOption(socket, SOL_SOCKET, SO_BUSY_POLL, options.busyPollMicros, "SO_BUSY_POLL");
+    }
+}
+
+void setCork(SOCKET socket, bool enabled) {
+    int value = enabled ? 1 : 0;
+    setsockopt(socket, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+}
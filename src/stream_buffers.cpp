@@ -0,0 +1,77 @@
+#include "stream_buffers.h"
+#include <algorithm>
+
+StreamBuffers::StreamBuffers(const StreamingConfig& config)
+    : config_(config),
+      buffered_(0),
+      peak_(0),
+      waits_(0),
+      denied_(0) {
+    config_.windowBytes = std::max<uint64_t>(config_.windowBytes, 64 * 1024);
+    config_.stallTimeoutSeconds = std::max(config_.stallTimeoutSeconds, 1);
+    config_.connectionBufferBytes = std::max<size_t>(config_.connectionBufferBytes, 16 * 1024);
+}
+
+const StreamingConfig& StreamBuffers::config() const {
+    return config_;
+}
+
+std::chrono::milliseconds StreamBuffers::stallTimeout() const {
+    return std::chrono::milliseconds(config_.stallTimeoutSeconds * 1000LL);
+}
+
+bool StreamBuffers::acquire(size_t bytes, std::chrono::milliseconds wait) {
+    size_t limit = config_.maxBufferedBytes;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (limit > 0 && buffered_ + bytes > limit) {
+        // Maior que o limite inteiro nunca caberia: recusa sem esperar
+        if (bytes > limit || wait.count() <= 0) {
+            denied_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        waits_.fetch_add(1, std::memory_order_relaxed);
+        if (!released_.wait_for(lock, wait, [this, bytes, limit] { return buffered_ + bytes <= limit; })) {
+            denied_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    buffered_ += bytes;
+    peak_ = std::max(peak_, buffered_);
+    return true;
+}
+
+void StreamBuffers::release(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffered_ -= std::min(bytes, buffered_);
+    }
+    released_.notify_all();
+}
+
+StreamBufferStats StreamBuffers::stats() const {
+    StreamBufferStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.buffered = buffered_;
+        stats.peak = peak_;
+    }
+    stats.waits = waits_.load(std::memory_order_relaxed);
+    stats.denied = denied_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+StreamBufferReservation::StreamBufferReservation(StreamBuffers& buffers, size_t bytes, std::chrono::milliseconds wait)
+    : buffers_(buffers),
+      bytes_(bytes),
+      granted_(buffers.acquire(bytes, wait)) {
+}
+
+StreamBufferReservation::~StreamBufferReservation() {
+    if (granted_) {
+        buffers_.release(bytes_);
+    }
+}
+
+StreamBufferReservation::operator bool() const {
+    return granted_;
+}
@@ -1,18 +1,11 @@
 #include <iostream>
 #include <string>
 
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    #pragma comment(lib, "ws2_32.lib")
-#else
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <unistd.h>
-    #define closesocket close
-    #define SOCKET int
-#endif
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int SOCKET;
 
 int main(int argc, char* argv[]) {
     if (argc != 3) {
@@ -20,11 +13,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-#ifdef _WIN32
-    WSADATA wsaData;
-    WSAStartup(MAKEWORD(2,2), &wsaData);
-#endif
-
     std::string host = argv[1];
     int port = std::stoi(argv[2]);
 
@@ -53,10 +41,7 @@ int main(int argc, char* argv[]) {
     }
 
     std::cout << "Response:\n" << response << std::endl;
-    closesocket(clientSocket);
+    close(clientSocket);
 
-#ifdef _WIN32
-    WSACleanup();
-#endif
     return 0;
 }
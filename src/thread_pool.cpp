@@ -1,34 +1,44 @@
 #include "thread_pool.h"
+#include <algorithm>
 
 ThreadPool::ThreadPool(size_t numThreads) 
-    : stop_(false), activeThreads_(0) {
+    : stop_(false), activeThreads_(0), liveThreads_(numThreads), retiring_(0) {
     
     workers_.reserve(numThreads);
     for (size_t i = 0; i < numThreads; ++i) {
-        workers_.emplace_back([this] {
-            for (;;) {
-                std::function<void()> task;
+        spawnWorker();
+    }
+}
+
+void ThreadPool::spawnWorker() {
+    workers_.emplace_back([this] {
+        for (;;) {
+            std::function<void()> task;
+            
+            {
+                std::unique_lock<std::mutex> lock(queueMutex_);
+                condition_.wait(lock, [this] {
+                    return stop_ || retiring_ > 0 || !tasks_.empty();
+                });
+                
+                if (retiring_ > 0 && !stop_) {
+                    retiring_--;
+                    return;
+                }
                 
-                {
-                    std::unique_lock<std::mutex> lock(queueMutex_);
-                    condition_.wait(lock, [this] {
-                        return stop_ || !tasks_.empty();
-                    });
-                    
-                    if (stop_ && tasks_.empty()) {
-                        return;
-                    }
-                    
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
-                    activeThreads_++;
+                if (stop_ && tasks_.empty()) {
+                    return;
                 }
                 
-                task();
-                activeThreads_--;
+                task = std::move(tasks_.front());
+                tasks_.pop();
+                activeThreads_++;
             }
-        });
-    }
+            
+            task();
+            activeThreads_--;
+        }
+    });
 }
 
 ThreadPool::~ThreadPool() {
@@ -50,6 +60,30 @@ void ThreadPool::shutdown() {
     }
 }
 
+void ThreadPool::resize(size_t numThreads) {
+    {
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        if (stop_ || numThreads == 0) {
+            return;
+        }
+        
+        // Reaproveita threads ainda não retiradas antes de criar novas
+        size_t current = liveThreads_;
+        liveThreads_ = numThreads;
+        if (numThreads < current) {
+            retiring_ += current - numThreads;
+        } else {
+            size_t missing = numThreads - current;
+            size_t reclaimed = std::min(missing, retiring_);
+            retiring_ -= reclaimed;
+            for (size_t i = reclaimed; i < missing; ++i) {
+                spawnWorker();
+            }
+        }
+    }
+    condition_.notify_all();
+}
+
 size_t ThreadPool::getActiveThreads() const {
     return activeThreads_.load();
 }
@@ -60,5 +94,6 @@ size_t ThreadPool::getQueueSize() const {
 }
 
 size_t ThreadPool::size() const {
-    return workers_.size();
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    return liveThreads_;
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick)
+    : tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1)), start_(Clock::now()) {
+    for (auto& level : slots_) {
+        level.fill(kNil);
+    }
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint32_t index;
+    if (!freeList_.empty()) {
+        index = freeList_.back();
+        freeList_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    // Arredonda para cima: um timer nunca expira antes do prazo pedido
+    uint64_t ticks = (delay.count() + tick_.count() - 1) / tick_.count();
+
+    Node& node = nodes_[index];
+    node.expiry = currentTick_ + (ticks > 0 ? ticks : 1);
+    node.callback = std::move(callback);
+    node.active = true;
+    insert(index);
+    count_++;
+
+    return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (id == kInvalidTimer) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint32_t index = static_cast<uint32_t>(id & 0xffffffffu) - 1;
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (index >= nodes_.size() || !nodes_[index].active || nodes_[index].generation != generation) {
+        return false;
+    }
+
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::advance(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (now < start_) {
+        return;
+    }
+
+    uint64_t target = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_).count() / tick_.count();
+    while (currentTick_ < target) {
+        step();
+    }
+}
+
+size_t TimerWheel::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+std::chrono::milliseconds TimerWheel::tick() const {
+    return tick_;
+}
+
+void TimerWheel::insert(uint32_t index) {
+    Node& node = nodes_[index];
+    uint64_t delta = node.expiry > currentTick_ ? node.expiry - currentTick_ : 0;
+
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+
+    // Prazos além do último nível ficam no slot mais distante e são recascateados
+    uint64_t expiry = node.expiry;
+    if (level == kLevels - 1 && delta >= (uint64_t(1) << (kSlotBits * kLevels))) {
+        expiry = currentTick_ + (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+    }
+
+    uint32_t& head = slots_[level][(expiry >> (kSlotBits * level)) & kSlotMask];
+    node.prev = kNil;
+    node.next = head;
+    node.head = &head;
+    if (head != kNil) {
+        nodes_[head].prev = index;
+    }
+    head = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        *node.head = node.next;
+    }
+    if (node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.prev = node.next = kNil;
+    node.head = nullptr;
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = nodes_[index];
+    node.active = false;
+    node.generation++;
+    node.callback = nullptr;
+    freeList_.push_back(index);
+    count_--;
+}
+
+void TimerWheel::step() {
+    currentTick_++;
+
+    // Cascateia do nível mais alto para o mais baixo, para que timers descendo
+    // de vários níveis cheguem ao slot correto do nível 0
+    int topLevel = 0;
+    while (topLevel < kLevels - 1 &&
+           (currentTick_ & ((uint64_t(1) << (kSlotBits * (topLevel + 1))) - 1)) == 0) {
+        topLevel++;
+    }
+
+    for (int level = topLevel; level >= 1; --level) {
+        uint32_t& head = slots_[level][(currentTick_ >> (kSlotBits * level)) & kSlotMask];
+        uint32_t index = head;
+        head = kNil;
+        while (index != kNil) {
+            uint32_t next = nodes_[index].next;
+            insert(index);
+            index = next;
+        }
+    }
+
+    uint32_t& head = slots_[0][currentTick_ & kSlotMask];
+    while (head != kNil) {
+        uint32_t index = head;
+        unlink(index);
+
+        std::function<void()> callback = std::move(nodes_[index].callback);
+        release(index);
+        if (callback) {
+            callback();
+        }
+    }
+}
@@ -0,0 +1,203 @@
+#include "tls_context.h"
+#include "socket_io.h"
+#include "logger.h"
+#include <memory>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#ifdef HAVE_OPENSSL
+    #include <openssl/ssl.h>
+    #include <openssl/err.h>
+#endif
+
+namespace {
+
+#ifdef HAVE_OPENSSL
+constexpr size_t kTicketKeyBytes = 80;     // Nome (16), HMAC (32) e AES (32), formato do OpenSSL
+// Só cifras que o kernel sabe cifrar (AES-GCM); as demais deixariam o registro no processo
+constexpr char kCipherList[] = "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:"
+                               "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384";
+constexpr char kCipherSuites[] = "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384";
+constexpr unsigned char kProtocolsWithHttp2[] = "\x02h2\x08http/1.1";
+constexpr unsigned char kProtocolsHttp1[] = "\x08http/1.1";
+
+std::string lastError() {
+    unsigned long code = ERR_get_error();
+    ERR_clear_error();
+    if (code == 0) {
+        return "unknown error";
+    }
+    char text[256];
+    ERR_error_string_n(code, text, sizeof(text));
+    return text;
+}
+
+int selectProtocol(SSL*, const unsigned char** out, unsigned char* outLength,
+                   const unsigned char* in, unsigned int inLength, void* arg) {
+    bool offerHttp2 = *static_cast<const bool*>(arg);
+    const unsigned char* protocols = offerHttp2 ? kProtocolsWithHttp2 : kProtocolsHttp1;
+    unsigned int length = offerHttp2 ? sizeof(kProtocolsWithHttp2) - 1 : sizeof(kProtocolsHttp1) - 1;
+    unsigned char* selected = nullptr;
+    if (SSL_select_next_proto(&selected, outLength, protocols, length, in, inLength) != OPENSSL_NPN_NEGOTIATED) {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    *out = selected;
+    return SSL_TLSEXT_ERR_OK;
+}
+#endif
+
+} // namespace
+
+TlsContext::TlsContext(const TlsConfig& config, bool offerHttp2)
+    : config_(config),
+      offerHttp2_(offerHttp2),
+      context_(nullptr),
+      handshakes_(0),
+      resumed_(0),
+      failed_(0),
+      notOffloaded_(0) {
+#ifdef HAVE_OPENSSL
+    if (!kernelSupported()) {
+        throw std::runtime_error("Kernel TLS is not available (load the \"tls\" module)");
+    }
+
+    context_ = SSL_CTX_new(TLS_server_method());
+    if (!context_) {
+        throw std::runtime_error("Failed to create TLS context: " + lastError());
+    }
+    std::string keyFile = config.keyFile.empty() ? config.certificateFile : config.keyFile;
+    if (SSL_CTX_use_certificate_chain_file(context_, config.certificateFile.c_str()) != 1 ||
+        SSL_CTX_use_PrivateKey_file(context_, keyFile.c_str(), SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(context_) != 1) {
+        std::string error = lastError();
+        SSL_CTX_free(context_);
+        throw std::runtime_error("Failed to load TLS certificate " + config.certificateFile + ": " + error);
+    }
+
+    SSL_CTX_set_min_proto_version(context_, TLS1_2_VERSION);
+#if OPENSSL_VERSION_NUMBER < 0x30200000L
+    // Antes do 3.2 o OpenSSL só passa a recepção ao kernel em TLS 1.2
+    SSL_CTX_set_max_proto_version(context_, TLS1_2_VERSION);
+#endif
+    SSL_CTX_set_cipher_list(context_, kCipherList);
+    SSL_CTX_set_ciphersuites(context_, kCipherSuites);
+    SSL_CTX_set_options(context_, SSL_OP_ENABLE_KTLS | SSL_OP_NO_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE);
+
+    // Sessões retomáveis: tickets cifrados com as chaves do contexto e cache interno, ambos
+    // compartilhados por todas as threads
+    static const unsigned char kSessionContext[] = "concurrent-server";
+    SSL_CTX_set_session_id_context(context_, kSessionContext, sizeof(kSessionContext) - 1);
+    SSL_CTX_set_session_cache_mode(context_, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_timeout(context_, config.sessionTimeoutSeconds);
+    SSL_CTX_set_num_tickets(context_, 1);
+
+    if (!config.ticketKeyFile.empty()) {
+        std::ifstream file(config.ticketKeyFile, std::ios::binary);
+        std::string keys((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (keys.size() != kTicketKeyBytes ||
+            SSL_CTX_set_tlsext_ticket_keys(context_, &keys[0], static_cast<long>(keys.size())) != 1) {
+            SSL_CTX_free(context_);
+            throw std::runtime_error("TLS ticket key file must hold exactly 80 bytes: " + config.ticketKeyFile);
+        }
+    }
+
+    SSL_CTX_set_alpn_select_cb(context_, selectProtocol, &offerHttp2_);
+#else
+    throw std::runtime_error("TLS requires building with OpenSSL");
+#endif
+}
+
+TlsContext::~TlsContext() {
+#ifdef HAVE_OPENSSL
+    SSL_CTX_free(context_);
+#endif
+}
+
+bool TlsContext::accept(Connection& connection, TimerWheel& timers) {
+#ifdef HAVE_OPENSSL
+    SSL* ssl = SSL_new(context_);
+    if (!ssl) {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        LOG_LIMITED(Logger::Level::ERROR, 1, 5, "Failed to create TLS session: {}", lastError());
+        return false;
+    }
+    // O SSL só existe durante o handshake: depois dele o kernel guarda o estado da criptografia
+    // (liberar não envia nada nem fecha o socket)
+    std::unique_ptr<SSL, decltype(&SSL_free)> session(ssl, SSL_free);
+    SSL_set_fd(ssl, connection.socket);
+
+    int result;
+    {
+        SocketDeadline deadline(timers, connection.socket, config_.handshakeTimeoutSeconds);
+        result = SSL_accept(ssl);
+    }
+    if (result != 1) {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        LOG_DEBUG("TLS handshake with {} failed: {}", connection.peerAddress, lastError());
+        return false;
+    }
+
+    handshakes_.fetch_add(1, std::memory_order_relaxed);
+    if (SSL_session_reused(ssl)) {
+        resumed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!BIO_get_ktls_send(SSL_get_wbio(ssl)) || !BIO_get_ktls_recv(SSL_get_rbio(ssl))) {
+        notOffloaded_.fetch_add(1, std::memory_order_relaxed);
+        LOG_LIMITED(Logger::Level::WARNING, 1, 10, "TLS connection from {} closed: kernel did not take over {} ({})",
+                    connection.peerAddress, SSL_get_cipher_name(ssl), SSL_get_version(ssl));
+        return false;
+    }
+    return true;
+#else
+    (void)connection;
+    (void)timers;
+    return false;
+#endif
+}
+
+TlsStats TlsContext::stats() const {
+    TlsStats stats;
+    stats.handshakes = handshakes_.load(std::memory_order_relaxed);
+    stats.resumed = resumed_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.notOffloaded = notOffloaded_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool TlsContext::kernelSupported() {
+    // TCP_ULP só vale em conexão estabelecida: um par em loopback basta para a sondagem
+    SOCKET listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        return false;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+
+    bool supported = false;
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+        listen(listener, 1) == 0 &&
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+        SOCKET client = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (client >= 0 && connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            SOCKET server = ::accept(listener, nullptr, nullptr);
+            if (server >= 0) {
+                supported = setsockopt(server, SOL_TCP, TCP_ULP, "tls", 3) == 0;
+                close(server);
+            }
+        }
+        if (client >= 0) {
+            close(client);
+        }
+    }
+    close(listener);
+    return supported;
+}
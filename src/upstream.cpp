@@ -0,0 +1,105 @@
+#include "upstream.h"
+#include "socket_io.h"
+#include <stdexcept>
+#include <climits>
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace {
+
+std::atomic<uint64_t> nextBackendId(1);
+
+}
+
+Backend::Backend(const std::string& host, int port)
+    : host(host), port(port), id(nextBackendId.fetch_add(1)), healthy(true), activeRequests(0) {
+}
+
+UpstreamGroup::UpstreamGroup(const std::vector<std::string>& backends, BalancePolicy policy)
+    : policy_(policy), next_(0) {
+    for (const auto& address : backends) {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos || colon == 0) {
+            throw std::invalid_argument("Invalid upstream address: " + address);
+        }
+        backends_.push_back(std::make_unique<Backend>(address.substr(0, colon), std::stoi(address.substr(colon + 1))));
+    }
+}
+
+Backend* UpstreamGroup::select() {
+    size_t count = backends_.size();
+    size_t start = next_.fetch_add(1);
+
+    if (policy_ == BalancePolicy::LeastConnections) {
+        Backend* best = nullptr;
+        int bestLoad = INT_MAX;
+        // Começa em posições diferentes para distribuir os empates
+        for (size_t i = 0; i < count; ++i) {
+            Backend* candidate = backends_[(start + i) % count].get();
+            int load = candidate->activeRequests.load();
+            if (candidate->healthy.load() && load < bestLoad) {
+                best = candidate;
+                bestLoad = load;
+            }
+        }
+        return best;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Backend* candidate = backends_[(start + i) % count].get();
+        if (candidate->healthy.load()) {
+            return candidate;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::unique_ptr<Backend>>& UpstreamGroup::backends() {
+    return backends_;
+}
+
+UpstreamConnectionPool& UpstreamConnectionPool::local() {
+    thread_local UpstreamConnectionPool pool;
+    return pool;
+}
+
+UpstreamConnectionPool::~UpstreamConnectionPool() {
+    for (auto& entry : idle_) {
+        for (SOCKET socket : entry.second) {
+            close(socket);
+        }
+    }
+}
+
+SOCKET UpstreamConnectionPool::acquire(const Backend& backend, int connectTimeoutMs, bool& reused) {
+    auto it = idle_.find(backend.id);
+    if (it != idle_.end()) {
+        while (!it->second.empty()) {
+            SOCKET socket = it->second.back();
+            it->second.pop_back();
+
+            // Conexão ociosa saudável não tem nada para ler: EOF ou dados inesperados a descartam
+            char probe;
+            ssize_t peeked = recv(socket, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+            if (peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                reused = true;
+                return socket;
+            }
+            close(socket);
+        }
+    }
+
+    reused = false;
+    return connectWithTimeout(backend.host, backend.port, connectTimeoutMs);
+}
+
+void UpstreamConnectionPool::release(const Backend& backend, SOCKET socket, size_t maxIdle) {
+    auto& sockets = idle_[backend.id];
+    if (sockets.size() >= maxIdle) {
+        close(socket);
+        return;
+    }
+    sockets.push_back(socket);
+}
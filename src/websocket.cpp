@@ -0,0 +1,825 @@
+#include "websocket.h"
+#include "http_handler.h"
+#include "http_utils.h"
+#include "logger.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace {
+
+enum Opcode : uint8_t {
+    kContinuation = 0x0,
+    kText = 0x1,
+    kBinary = 0x2,
+    kClose = 0x8,
+    kPing = 0x9,
+    kPong = 0xa
+};
+
+constexpr char kHandshakeGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC11B65";
+constexpr size_t kMaxControlPayload = 125;
+constexpr size_t kMaxWriteBuffers = 64;
+constexpr int kMaxEvents = 256;
+
+// SHA-1 (RFC 3174): usado apenas no Sec-WebSocket-Accept do handshake
+std::string sha1(const std::string& input) {
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+    std::string message = input;
+    uint64_t bitLength = static_cast<uint64_t>(input.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56) {
+        message.push_back('\0');
+    }
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        message.push_back(static_cast<char>(bitLength >> shift));
+    }
+
+    auto rotate = [](uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); };
+    for (size_t block = 0; block < message.size(); block += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* p = reinterpret_cast<const uint8_t*>(message.data() + block + i * 4);
+            w[i] = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            uint32_t temp = rotate(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotate(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::string digest;
+    for (uint32_t word : h) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            digest.push_back(static_cast<char>(word >> shift));
+        }
+    }
+    return digest;
+}
+
+std::string base64Encode(const std::string& input) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string output;
+    size_t i = 0;
+    for (; i + 2 < input.size(); i += 3) {
+        uint32_t value = (static_cast<uint8_t>(input[i]) << 16) | (static_cast<uint8_t>(input[i + 1]) << 8) |
+                         static_cast<uint8_t>(input[i + 2]);
+        output.push_back(kAlphabet[(value >> 18) & 63]);
+        output.push_back(kAlphabet[(value >> 12) & 63]);
+        output.push_back(kAlphabet[(value >> 6) & 63]);
+        output.push_back(kAlphabet[value & 63]);
+    }
+    if (i < input.size()) {
+        uint32_t value = static_cast<uint8_t>(input[i]) << 16;
+        if (i + 1 < input.size()) {
+            value |= static_cast<uint8_t>(input[i + 1]) << 8;
+        }
+        output.push_back(kAlphabet[(value >> 18) & 63]);
+        output.push_back(kAlphabet[(value >> 12) & 63]);
+        output.push_back(i + 1 < input.size() ? kAlphabet[(value >> 6) & 63] : '=');
+        output.push_back('=');
+    }
+    return output;
+}
+
+bool isValidUtf8(const std::string& text) {
+    size_t i = 0;
+    while (i < text.size()) {
+        uint8_t c = static_cast<uint8_t>(text[i]);
+        size_t length;
+        uint32_t codepoint;
+        if (c < 0x80) {
+            i++;
+            continue;
+        } else if ((c & 0xe0) == 0xc0) {
+            length = 2;
+            codepoint = c & 0x1f;
+        } else if ((c & 0xf0) == 0xe0) {
+            length = 3;
+            codepoint = c & 0x0f;
+        } else if ((c & 0xf8) == 0xf0) {
+            length = 4;
+            codepoint = c & 0x07;
+        } else {
+            return false;
+        }
+
+        if (i + length > text.size()) {
+            return false;
+        }
+        for (size_t j = 1; j < length; ++j) {
+            uint8_t next = static_cast<uint8_t>(text[i + j]);
+            if ((next & 0xc0) != 0x80) {
+                return false;
+            }
+            codepoint = (codepoint << 6) | (next & 0x3f);
+        }
+
+        // Formas longas demais, surrogates e valores acima de U+10FFFF
+        static const uint32_t kMinimum[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (codepoint < kMinimum[length] || codepoint > 0x10ffff ||
+            (codepoint >= 0xd800 && codepoint <= 0xdfff)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+// Frames do servidor não são mascarados: o mesmo buffer serve a todos os assinantes
+std::shared_ptr<const std::string> makeFrame(uint8_t opcode, std::string_view payload) {
+    auto frame = std::make_shared<std::string>();
+    frame->reserve(payload.size() + 10);
+    frame->push_back(static_cast<char>(0x80 | opcode));
+    if (payload.size() < 126) {
+        frame->push_back(static_cast<char>(payload.size()));
+    } else if (payload.size() <= 0xffff) {
+        frame->push_back(126);
+        frame->push_back(static_cast<char>(payload.size() >> 8));
+        frame->push_back(static_cast<char>(payload.size()));
+    } else {
+        frame->push_back(127);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame->push_back(static_cast<char>(static_cast<uint64_t>(payload.size()) >> shift));
+        }
+    }
+    frame->append(payload.data(), payload.size());
+    return frame;
+}
+
+std::shared_ptr<const std::string> makeCloseFrame(uint16_t code) {
+    char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code)};
+    return makeFrame(kClose, std::string_view(payload, sizeof(payload)));
+}
+
+}
+
+struct WebSocketHub::Client {
+    WebSocketClientId id = 0;
+    SOCKET socket = -1;
+    std::shared_ptr<const WebSocketHandlers> handlers;
+    std::unordered_set<std::string> topics;
+
+    // Leitura: exclusiva da thread do hub
+    std::string input;
+    std::string message;                // Mensagem fragmentada em remontagem
+    bool fragmented = false;
+    bool messageBinary = false;
+    bool readClosed = false;
+    std::chrono::steady_clock::time_point lastReceived;
+    bool pingSent = false;
+
+    // Escrita: protegida pelo mutex do hub
+    std::deque<Frame> queue;
+    size_t frontOffset = 0;             // Bytes do primeiro frame já enviados
+    size_t queuedBytes = 0;
+    bool dirty = false;
+    bool wantWrite = false;             // EPOLLOUT registrado
+    bool closeAfterFlush = false;       // Frame de close na fila: encerra ao esvaziar
+    bool dead = false;                  // Já listado em closed_
+};
+
+WebSocketHub::WebSocketHub(const WebSocketConfig& config)
+    : config_(config), epollFd_(-1), wakeFd_(-1), running_(false), nextId_(1),
+      droppedMessages_(0), clientCount_(0) {
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        throw std::runtime_error("Failed to create WebSocket epoll instance");
+    }
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        ::close(epollFd_);
+        throw std::runtime_error("Failed to create WebSocket eventfd");
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = 0;     // Ids de cliente começam em 1
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+}
+
+WebSocketHub::~WebSocketHub() {
+    if (running_.exchange(false)) {
+        wakeup();
+        thread_.join();
+    }
+    for (auto& entry : clients_) {
+        ::close(entry.second->socket);
+    }
+    ::close(wakeFd_);
+    ::close(epollFd_);
+}
+
+bool WebSocketHub::accept(const HttpRequest& request, HttpResponse& response,
+                          std::shared_ptr<const WebSocketHandlers> handlers, std::vector<std::string> topics) {
+    auto header = [&request](const char* name) -> std::string {
+        auto it = request.headers.find(name);
+        return it != request.headers.end() ? it->second : std::string();
+    };
+
+    std::string key = header("sec-websocket-key");
+    if (request.methodId != HttpMethod::Get || request.version != "HTTP/1.1" ||
+        !containsToken(header("upgrade"), "websocket") || !containsToken(header("connection"), "upgrade") ||
+        key.size() != 24) {
+        response.statusCode = 400;
+        response.statusText = "Bad Request";
+        return false;
+    }
+    if (header("sec-websocket-version") != "13") {
+        response.statusCode = 426;
+        response.statusText = "Upgrade Required";
+        response.headers["Sec-WebSocket-Version"] = "13";
+        return false;
+    }
+    if (clientCount_.load() >= config_.maxClients) {
+        response.statusCode = 503;
+        response.statusText = "Service Unavailable";
+        return false;
+    }
+
+    response.statusCode = 101;
+    response.statusText = "Switching Protocols";
+    response.headers["Upgrade"] = "websocket";
+    response.headers["Connection"] = "Upgrade";
+    response.headers["Sec-WebSocket-Accept"] = base64Encode(sha1(key + kHandshakeGuid));
+    response.takeover = [this, handlers = std::move(handlers), topics = std::move(topics)](Connection& connection) {
+        std::string pending = std::move(connection.readBuffer);
+        attach(connection.release(), std::move(pending), handlers, topics);
+    };
+    return true;
+}
+
+void WebSocketHub::attach(SOCKET socket, std::string pending, std::shared_ptr<const WebSocketHandlers> handlers,
+                          std::vector<std::string> topics) {
+    std::call_once(started_, [this] {
+        running_ = true;
+        thread_ = std::thread([this] { run(); });
+    });
+
+    int flags = fcntl(socket, F_GETFL, 0);
+    fcntl(socket, F_SETFL, flags | O_NONBLOCK);
+
+    auto client = std::make_unique<Client>();
+    client->id = nextId_.fetch_add(1);
+    client->socket = socket;
+    client->handlers = std::move(handlers);
+    client->input = std::move(pending);
+    client->lastReceived = std::chrono::steady_clock::now();
+    WebSocketClientId id = client->id;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& topic : topics) {
+            topics_[topic].insert(id);
+            client->topics.insert(std::move(topic));
+        }
+        clients_[id] = std::move(client);
+        attached_.push_back(id);
+        clientCount_++;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, socket, &event);
+    wakeup();
+}
+
+void WebSocketHub::subscribe(WebSocketClientId id, const std::string& topic) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Client* client = findClient(id)) {
+        topics_[topic].insert(id);
+        client->topics.insert(topic);
+    }
+}
+
+void WebSocketHub::unsubscribe(WebSocketClientId id, const std::string& topic) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Client* client = findClient(id);
+    auto it = topics_.find(topic);
+    if (!client || it == topics_.end()) {
+        return;
+    }
+    it->second.erase(id);
+    if (it->second.empty()) {
+        topics_.erase(it);
+    }
+    client->topics.erase(topic);
+}
+
+size_t WebSocketHub::publish(const std::string& topic, std::string_view message, bool binary) {
+    // Frame montado uma vez, fora do lock; cada fila guarda só uma referência
+    Frame frame = makeFrame(binary ? kBinary : kText, message);
+    size_t delivered = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = topics_.find(topic);
+        if (it == topics_.end()) {
+            return 0;
+        }
+        for (WebSocketClientId id : it->second) {
+            Client* client = findClient(id);
+            if (client && enqueue(*client, frame)) {
+                delivered++;
+            }
+        }
+    }
+    if (delivered > 0) {
+        wakeup();
+    }
+    return delivered;
+}
+
+bool WebSocketHub::send(WebSocketClientId id, std::string_view message, bool binary) {
+    Frame frame = makeFrame(binary ? kBinary : kText, message);
+    bool queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Client* client = findClient(id);
+        queued = client && enqueue(*client, frame);
+    }
+    if (queued) {
+        wakeup();
+    }
+    return queued;
+}
+
+void WebSocketHub::close(WebSocketClientId id, uint16_t code) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Client* client = findClient(id)) {
+            beginClose(*client, code);
+        }
+    }
+    wakeup();
+}
+
+void WebSocketHub::closeAll(uint16_t code) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : clients_) {
+            if (!entry.second->dead) {
+                beginClose(*entry.second, code);
+            }
+        }
+    }
+    wakeup();
+}
+
+size_t WebSocketHub::clients() const {
+    return clientCount_.load();
+}
+
+uint64_t WebSocketHub::droppedMessages() const {
+    return droppedMessages_.load();
+}
+
+WebSocketHub::Client* WebSocketHub::findClient(WebSocketClientId id) {
+    auto it = clients_.find(id);
+    return it != clients_.end() && !it->second->dead ? it->second.get() : nullptr;
+}
+
+bool WebSocketHub::enqueue(Client& client, const Frame& frame) {
+    if (client.closeAfterFlush) {
+        return false;
+    }
+
+    // Consumidor lento: a fila não cresce além do limite
+    if (client.queuedBytes + frame->size() > config_.maxQueuedBytes) {
+        droppedMessages_++;
+        if (config_.slowConsumers == SlowConsumerPolicy::Disconnect) {
+            LOG_LIMITED(Logger::Level::WARNING, 1, 10, "WebSocket client {} disconnected: send queue full", client.id);
+            client.dead = true;
+            closed_.push_back(client.id);
+        }
+        return false;
+    }
+
+    client.queue.push_back(frame);
+    client.queuedBytes += frame->size();
+    if (!client.dirty) {
+        client.dirty = true;
+        dirty_.push_back(client.id);
+    }
+    return true;
+}
+
+void WebSocketHub::beginClose(Client& client, uint16_t code) {
+    if (client.closeAfterFlush) {
+        return;
+    }
+    // O frame de close não conta para o limite da fila
+    Frame frame = makeCloseFrame(code);
+    client.queue.push_back(frame);
+    client.queuedBytes += frame->size();
+    client.closeAfterFlush = true;
+    client.readClosed = true;
+    if (!client.dirty) {
+        client.dirty = true;
+        dirty_.push_back(client.id);
+    }
+}
+
+void WebSocketHub::flush(Client& client) {
+    while (!client.dead && !client.queue.empty()) {
+        iovec buffers[kMaxWriteBuffers];
+        size_t count = 0;
+        for (const auto& frame : client.queue) {
+            if (count == kMaxWriteBuffers) {
+                break;
+            }
+            size_t offset = count == 0 ? client.frontOffset : 0;
+            buffers[count].iov_base = const_cast<char*>(frame->data() + offset);
+            buffers[count].iov_len = frame->size() - offset;
+            count++;
+        }
+
+        msghdr message{};
+        message.msg_iov = buffers;
+        message.msg_iovlen = count;
+        ssize_t sent = sendmsg(client.socket, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Buffer do socket cheio: retoma quando o cliente consumir (EPOLLOUT)
+            if (!client.wantWrite) {
+                client.wantWrite = true;
+                epoll_event event{};
+                event.events = EPOLLIN | EPOLLOUT;
+                event.data.u64 = client.id;
+                epoll_ctl(epollFd_, EPOLL_CTL_MOD, client.socket, &event);
+            }
+            return;
+        }
+        if (sent <= 0) {
+            client.dead = true;
+            closed_.push_back(client.id);
+            return;
+        }
+
+        size_t remaining = static_cast<size_t>(sent);
+        client.queuedBytes -= remaining;
+        while (remaining > 0) {
+            size_t frontLeft = client.queue.front()->size() - client.frontOffset;
+            if (remaining < frontLeft) {
+                client.frontOffset += remaining;
+                break;
+            }
+            remaining -= frontLeft;
+            client.queue.pop_front();
+            client.frontOffset = 0;
+        }
+    }
+
+    if (client.wantWrite && !client.dead) {
+        client.wantWrite = false;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = client.id;
+        epoll_ctl(epollFd_, EPOLL_CTL_MOD, client.socket, &event);
+    }
+    if (client.closeAfterFlush && client.queue.empty() && !client.dead) {
+        client.dead = true;
+        closed_.push_back(client.id);
+    }
+}
+
+void WebSocketHub::run() {
+    epoll_event events[kMaxEvents];
+    auto lastIdleCheck = std::chrono::steady_clock::now();
+
+    while (running_) {
+        int count = epoll_wait(epollFd_, events, kMaxEvents, 1000);
+        if (count < 0 && errno != EINTR) {
+            Logger::getInstance().error("WebSocket epoll_wait failed: " + std::string(strerror(errno)));
+            break;
+        }
+
+        std::vector<std::function<void()>> callbacks;
+        for (int i = 0; i < count; ++i) {
+            WebSocketClientId id = events[i].data.u64;
+            if (id == 0) {
+                uint64_t value;
+                while (read(wakeFd_, &value, sizeof(value)) > 0) {
+                }
+                continue;
+            }
+
+            Client* client;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                client = findClient(id);
+                if (client && (events[i].events & EPOLLOUT)) {
+                    flush(*client);
+                }
+            }
+            if (!client) {
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                readClient(*client, callbacks);
+            }
+        }
+
+        // Bytes que chegaram junto com o handshake
+        std::vector<WebSocketClientId> attached;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            attached.swap(attached_);
+        }
+        for (WebSocketClientId id : attached) {
+            Client* client;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                client = findClient(id);
+            }
+            if (client && !client->input.empty()) {
+                parseFrames(*client, callbacks);
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (config_.pingIntervalSeconds > 0 && now - lastIdleCheck >= std::chrono::seconds(1)) {
+            lastIdleCheck = now;
+            checkIdle();
+        }
+
+        // Callbacks sem o lock: podem publicar, o que só adiciona às filas
+        for (auto& callback : callbacks) {
+            callback();
+        }
+        callbacks.clear();
+
+        std::vector<WebSocketClientId> closed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<WebSocketClientId> dirty;
+            dirty.swap(dirty_);
+            for (WebSocketClientId id : dirty) {
+                auto it = clients_.find(id);
+                if (it != clients_.end()) {
+                    it->second->dirty = false;
+                    flush(*it->second);
+                }
+            }
+            closed.swap(closed_);
+        }
+        for (WebSocketClientId id : closed) {
+            removeClient(id, callbacks);
+        }
+        for (auto& callback : callbacks) {
+            callback();
+        }
+    }
+}
+
+void WebSocketHub::readClient(Client& client, std::vector<std::function<void()>>& callbacks) {
+    char buffer[16 * 1024];
+    while (true) {
+        ssize_t received = recv(client.socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (received <= 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!client.dead) {
+                client.dead = true;
+                closed_.push_back(client.id);
+            }
+            return;
+        }
+
+        client.lastReceived = std::chrono::steady_clock::now();
+        client.pingSent = false;
+        if (client.readClosed) {
+            continue;   // Close já iniciado: o restante é descartado
+        }
+        client.input.append(buffer, static_cast<size_t>(received));
+        if (!parseFrames(client, callbacks)) {
+            return;
+        }
+    }
+}
+
+bool WebSocketHub::parseFrames(Client& client, std::vector<std::function<void()>>& callbacks) {
+    auto fail = [this, &client](uint16_t code) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        beginClose(client, code);
+        client.input.clear();
+        return false;
+    };
+
+    size_t offset = 0;
+    const std::string& input = client.input;
+    while (!client.readClosed && input.size() - offset >= 2) {
+        const auto* data = reinterpret_cast<const uint8_t*>(input.data()) + offset;
+        size_t available = input.size() - offset;
+        bool fin = (data[0] & 0x80) != 0;
+        uint8_t opcode = data[0] & 0x0f;
+        uint64_t length = data[1] & 0x7f;
+        size_t headerBytes = 2;
+
+        // Sem extensões negociadas (RSV) e com máscara obrigatória para frames do cliente
+        if ((data[0] & 0x70) != 0 || (data[1] & 0x80) == 0) {
+            return fail(1002);
+        }
+        if (length == 126) {
+            if (available < 4) {
+                break;
+            }
+            length = (static_cast<uint64_t>(data[2]) << 8) | data[3];
+            headerBytes = 4;
+        } else if (length == 127) {
+            if (available < 10) {
+                break;
+            }
+            length = 0;
+            for (int i = 0; i < 8; ++i) {
+                length = (length << 8) | data[2 + i];
+            }
+            headerBytes = 10;
+        }
+
+        bool control = (opcode & 0x08) != 0;
+        if (control && (!fin || length > kMaxControlPayload)) {
+            return fail(1002);
+        }
+        if (opcode != kContinuation && opcode != kText && opcode != kBinary &&
+            opcode != kClose && opcode != kPing && opcode != kPong) {
+            return fail(1002);
+        }
+        if (length > config_.maxMessageBytes) {
+            return fail(1009);
+        }
+        if (available < headerBytes + 4 + length) {
+            break;
+        }
+
+        const uint8_t* mask = data + headerBytes;
+        const uint8_t* masked = mask + 4;
+        std::string payload(static_cast<size_t>(length), '\0');
+        for (size_t i = 0; i < payload.size(); ++i) {
+            payload[i] = static_cast<char>(masked[i] ^ mask[i & 3]);
+        }
+        offset += headerBytes + 4 + static_cast<size_t>(length);
+
+        if (opcode == kPing) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            enqueue(client, makeFrame(kPong, payload));
+            continue;
+        }
+        if (opcode == kPong) {
+            continue;
+        }
+        if (opcode == kClose) {
+            // Responde com o mesmo código e encerra depois do envio
+            uint16_t code = 1000;
+            if (payload.size() == 1) {
+                return fail(1002);
+            }
+            if (payload.size() >= 2) {
+                code = static_cast<uint16_t>((static_cast<uint8_t>(payload[0]) << 8) | static_cast<uint8_t>(payload[1]));
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            beginClose(client, code);
+            break;
+        }
+
+        if (opcode == kContinuation) {
+            if (!client.fragmented) {
+                return fail(1002);
+            }
+            if (client.message.size() + payload.size() > config_.maxMessageBytes) {
+                return fail(1009);
+            }
+            client.message += payload;
+        } else {
+            if (client.fragmented) {
+                return fail(1002);
+            }
+            client.message = std::move(payload);
+            client.messageBinary = opcode == kBinary;
+        }
+        client.fragmented = !fin;
+        if (!fin) {
+            continue;
+        }
+
+        if (!client.messageBinary && !isValidUtf8(client.message)) {
+            return fail(1007);
+        }
+        if (client.handlers && client.handlers->onMessage) {
+            callbacks.push_back([this, handlers = client.handlers, id = client.id,
+                                 message = std::move(client.message), binary = client.messageBinary] {
+                handlers->onMessage(*this, id, message, binary);
+            });
+        }
+        client.message.clear();
+    }
+
+    client.input.erase(0, offset);
+    return true;
+}
+
+void WebSocketHub::checkIdle() {
+    auto now = std::chrono::steady_clock::now();
+    auto interval = std::chrono::seconds(config_.pingIntervalSeconds);
+    static const Frame kPingFrame = makeFrame(kPing, std::string_view());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : clients_) {
+        Client& client = *entry.second;
+        if (client.dead) {
+            continue;
+        }
+        auto idle = now - client.lastReceived;
+        if (idle >= interval * 2) {
+            client.dead = true;
+            closed_.push_back(client.id);
+        } else if (idle >= interval && !client.pingSent) {
+            client.pingSent = enqueue(client, kPingFrame);
+        }
+    }
+}
+
+void WebSocketHub::removeClient(WebSocketClientId id, std::vector<std::function<void()>>& callbacks) {
+    std::unique_ptr<Client> client;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = clients_.find(id);
+        if (it == clients_.end()) {
+            return;
+        }
+        client = std::move(it->second);
+        clients_.erase(it);
+
+        for (const auto& topic : client->topics) {
+            auto topicIt = topics_.find(topic);
+            if (topicIt != topics_.end()) {
+                topicIt->second.erase(id);
+                if (topicIt->second.empty()) {
+                    topics_.erase(topicIt);
+                }
+            }
+        }
+        clientCount_--;
+    }
+
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, client->socket, nullptr);
+    ::close(client->socket);
+
+    if (client->handlers && client->handlers->onClose) {
+        callbacks.push_back([this, handlers = client->handlers, id] {
+            handlers->onClose(*this, id);
+        });
+    }
+}
+
+void WebSocketHub::wakeup() {
+    uint64_t value = 1;
+    ssize_t written = write(wakeFd_, &value, sizeof(value));
+    (void)written;
+}
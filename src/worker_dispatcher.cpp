@@ -0,0 +1,249 @@
+#include "worker_dispatcher.h"
+#include <algorithm>
+#include <functional>
+
+WorkerDispatcher::WorkerDispatcher(DispatchPolicy policy, size_t queueCapacity, size_t workers,
+                                   std::shared_ptr<RequestLanes> lanes)
+    : policy_(policy),
+      queueCapacity_(queueCapacity),
+      lanes_(std::move(lanes)),
+      slots_(kMaxWorkers),
+      allocated_(0),
+      workers_(0),
+      next_(0),
+      rerouted_(0) {
+    setWorkers(workers);
+}
+
+WorkerDispatcher::Slot& WorkerDispatcher::slot(size_t index) const {
+    return *slots_[index];
+}
+
+void WorkerDispatcher::setWorkers(size_t workers) {
+    workers = std::min(std::max<size_t>(workers, 1), kMaxWorkers);
+    std::lock_guard<std::mutex> lock(growMutex_);
+    size_t allocated = allocated_.load(std::memory_order_relaxed);
+    for (size_t i = allocated; i < workers; ++i) {
+        slots_[i] = std::make_unique<Slot>(queueCapacity_, lanes_);
+    }
+    if (workers > allocated) {
+        allocated_.store(workers, std::memory_order_release);
+    }
+    workers_.store(workers, std::memory_order_release);
+}
+
+size_t WorkerDispatcher::choose(const Connection& connection, size_t workers) {
+    switch (policy_) {
+        case DispatchPolicy::LeastLoaded: {
+            // Começa em posições diferentes para distribuir os empates
+            size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+            size_t best = start % workers;
+            size_t bestLoad = SIZE_MAX;
+            for (size_t i = 0; i < workers; ++i) {
+                size_t index = (start + i) % workers;
+                const Slot& candidate = slot(index);
+                size_t load = candidate.queued.load(std::memory_order_relaxed) +
+                              candidate.busy.load(std::memory_order_relaxed);
+                if (load < bestLoad) {
+                    best = index;
+                    bestLoad = load;
+                    if (load == 0) {
+                        break;
+                    }
+                }
+            }
+            return best;
+        }
+        case DispatchPolicy::Affinity: {
+            // Socket Unix não tem IP: o descritor ao menos mantém a conexão na mesma thread
+            size_t hash = connection.peerAddress.empty() ? std::hash<SOCKET>()(connection.socket)
+                                                         : std::hash<std::string>()(connection.peerAddress);
+            return hash % workers;
+        }
+        default:
+            return next_.fetch_add(1, std::memory_order_relaxed) % workers;
+    }
+}
+
+bool WorkerDispatcher::push(std::unique_ptr<Connection>& connection, std::chrono::milliseconds timeout) {
+    if (policy_ == DispatchPolicy::Shared) {
+        return slot(0).queue.push(connection, timeout);
+    }
+
+    size_t workers = workers_.load(std::memory_order_acquire);
+    size_t chosen = choose(*connection, workers);
+    // Fila escolhida cheia (ou desativada por uma thread que está saindo): tenta as outras sem
+    // esperar antes de bloquear a aceitação
+    for (size_t i = 0; i < workers; ++i) {
+        Slot& target = slot((chosen + i) % workers);
+        target.queued.fetch_add(1, std::memory_order_relaxed);
+        if (target.queue.push(connection, std::chrono::milliseconds(0))) {
+            if (i > 0) {
+                rerouted_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        target.queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (timeout.count() <= 0) {
+        return false;
+    }
+
+    Slot& target = slot(chosen);
+    target.queued.fetch_add(1, std::memory_order_relaxed);
+    if (target.queue.push(connection, timeout)) {
+        return true;
+    }
+    target.queued.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool WorkerDispatcher::pop(size_t worker, std::unique_ptr<Connection>& connection, std::chrono::milliseconds timeout) {
+    if (policy_ == DispatchPolicy::Shared) {
+        return slot(0).queue.pop(connection, timeout);
+    }
+    Slot& own = slot(worker);
+    if (!own.queue.pop(connection, timeout)) {
+        return false;
+    }
+    own.queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t WorkerDispatcher::retire(size_t worker) {
+    if (policy_ == DispatchPolicy::Shared) {
+        return 0;
+    }
+
+    Slot& own = slot(worker);
+    own.queue.shutdown();
+    size_t dropped = 0;
+    for (auto& connection : own.queue.takeAll()) {
+        own.queued.fetch_sub(1, std::memory_order_relaxed);
+        if (push(connection, std::chrono::milliseconds(0))) {
+            rerouted_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            connection.reset();
+            ++dropped;
+        }
+    }
+    return dropped;
+}
+
+void WorkerDispatcher::activate(size_t worker) {
+    if (policy_ != DispatchPolicy::Shared) {
+        slot(worker).queue.reopen();
+    }
+}
+
+void WorkerDispatcher::begin(size_t worker) {
+    slot(worker).busy.store(1, std::memory_order_relaxed);
+}
+
+void WorkerDispatcher::finish(size_t worker, uint8_t lane, std::chrono::steady_clock::duration busy) {
+    Slot& own = slot(worker);
+    own.busy.store(0, std::memory_order_relaxed);
+    own.handled.fetch_add(1, std::memory_order_relaxed);
+    own.busyMicros.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(busy).count(),
+                             std::memory_order_relaxed);
+    
+    if (!lanes_) {
+        return;
+    }
+    lanes_->finished(lane, busy);
+    // Vaga liberada numa faixa limitada: filas com conexões só dessa faixa podem estar esperando
+    if (lanes_->limited(lane)) {
+        size_t queues = policy_ == DispatchPolicy::Shared ? 1 : allocated_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < queues; ++i) {
+            slot(i).queue.notify();
+        }
+    }
+}
+
+size_t WorkerDispatcher::size() const {
+    size_t total = 0;
+    size_t allocated = allocated_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < allocated; ++i) {
+        total += slot(i).queue.size();
+    }
+    return total;
+}
+
+bool WorkerDispatcher::empty() const {
+    size_t allocated = allocated_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < allocated; ++i) {
+        if (!slot(i).queue.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WorkerDispatcher::empty(size_t worker) const {
+    return slot(policy_ == DispatchPolicy::Shared ? 0 : worker).queue.empty();
+}
+
+size_t WorkerDispatcher::clear() {
+    size_t dropped = 0;
+    size_t allocated = allocated_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < allocated; ++i) {
+        dropped += slot(i).queue.clear();
+        slot(i).queued.store(0, std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void WorkerDispatcher::shutdown() {
+    size_t allocated = allocated_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < allocated; ++i) {
+        slot(i).queue.shutdown();
+    }
+}
+
+DispatchStats WorkerDispatcher::stats() const {
+    DispatchStats stats;
+    stats.policy = policy_;
+    stats.rerouted = rerouted_.load(std::memory_order_relaxed);
+
+    size_t workers = workers_.load(std::memory_order_acquire);
+    uint64_t totalBusy = 0;
+    uint64_t maxBusy = 0;
+    for (size_t i = 0; i < workers; ++i) {
+        const Slot& current = slot(i);
+        WorkerLoad load;
+        load.handled = current.handled.load(std::memory_order_relaxed);
+        load.busyMicros = current.busyMicros.load(std::memory_order_relaxed);
+        load.queued = current.queued.load(std::memory_order_relaxed);
+        totalBusy += load.busyMicros;
+        maxBusy = std::max(maxBusy, load.busyMicros);
+        stats.workers.push_back(load);
+    }
+    stats.queued = size();
+    if (lanes_) {
+        stats.lanes = lanes_->stats();
+    }
+    if (totalBusy > 0) {
+        stats.imbalance = static_cast<double>(maxBusy) * workers / totalBusy;
+    }
+    return stats;
+}
+
+bool WorkerDispatcher::parsePolicy(const std::string& name, DispatchPolicy& policy) {
+    for (DispatchPolicy candidate : {DispatchPolicy::Shared, DispatchPolicy::RoundRobin,
+                                     DispatchPolicy::LeastLoaded, DispatchPolicy::Affinity}) {
+        if (name == policyName(candidate)) {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* WorkerDispatcher::policyName(DispatchPolicy policy) {
+    switch (policy) {
+        case DispatchPolicy::RoundRobin: return "round-robin";
+        case DispatchPolicy::LeastLoaded: return "least-loaded";
+        case DispatchPolicy::Affinity: return "affinity";
+        default: return "shared";
+    }
+}
@@ -0,0 +1,98 @@
+#include "test_support.h"
+#include "http_utils.h"
+
+namespace {
+
+// Mensagem inteira de uma vez; `consumed` diz onde o decodificador parou
+struct Decoded {
+    std::string body;
+    size_t consumed = 0;
+    bool done = false;
+    bool failed = false;
+};
+
+Decoded decodeAll(const std::string& message) {
+    Decoded result;
+    ChunkedDecoder decoder;
+    result.consumed = decoder.feed(message.data(), message.size(), &result.body);
+    result.done = decoder.done();
+    result.failed = decoder.failed();
+    return result;
+}
+
+bool fails(const std::string& message) {
+    return decodeAll(message).failed;
+}
+
+}
+
+// RFC 9112, 7.1
+TEST_CASE(chunked, basic_message) {
+    std::string message = "4\r\nWiki\r\n5\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n0\r\n\r\n";
+    Decoded result = decodeAll(message);
+    CHECK(result.done && !result.failed);
+    CHECK(result.body == "Wikipedia in\r\n\r\nchunks.");
+    CHECK(result.consumed == message.size());
+}
+
+TEST_CASE(chunked, byte_at_a_time) {
+    std::string message = "4\r\nWiki\r\n5;x=1\r\npedia\r\n0\r\nX-Trailer: a\r\n\r\n";
+    ChunkedDecoder decoder;
+    std::string body;
+    for (char c : message) {
+        CHECK(!decoder.done());
+        CHECK(decoder.feed(&c, 1, &body) == 1);
+    }
+    CHECK(decoder.done() && !decoder.failed());
+    CHECK(body == "Wikipedia");
+}
+
+TEST_CASE(chunked, extensions_trailers_and_sizes) {
+    CHECK(decodeAll("5;name=value;flag\r\nhello\r\n0\r\n\r\n").body == "hello");
+    CHECK(decodeAll("5 ; name=\"quoted value\"\r\nhello\r\n0\r\n\r\n").body == "hello");
+    CHECK(decodeAll("A\r\n0123456789\r\n0\r\n\r\n").body == "0123456789");
+    CHECK(decodeAll("a\r\n0123456789\r\n0000\r\n\r\n").body == "0123456789");
+    CHECK(decodeAll("00000000000000a\r\n0123456789\r\n0\r\n\r\n").done);   // 15 dígitos ainda cabem
+
+    Decoded trailers = decodeAll("3\r\nabc\r\n0\r\nExpires: never\r\nX-Sum: 1\r\n\r\n");
+    CHECK(trailers.done && trailers.body == "abc");
+
+    Decoded empty = decodeAll("0\r\n\r\n");
+    CHECK(empty.done && empty.body.empty());
+}
+
+TEST_CASE(chunked, stops_at_message_end) {
+    // Bytes depois do fim pertencem à próxima requisição em pipeline
+    std::string message = "3\r\nabc\r\n0\r\n\r\n";
+    Decoded result = decodeAll(message + "GET / HTTP/1.1\r\n\r\n");
+    CHECK(result.done);
+    CHECK(result.consumed == message.size());
+    CHECK(result.body == "abc");
+
+    ChunkedDecoder decoder;
+    CHECK(decoder.feed(message.data(), message.size(), nullptr) == message.size());
+    CHECK(decoder.done());
+}
+
+TEST_CASE(chunked, incomplete_is_not_an_error) {
+    Decoded partial = decodeAll("5\r\nhel");
+    CHECK(!partial.done && !partial.failed && partial.body == "hel");
+    Decoded noTerminator = decodeAll("5\r\nhello\r\n0\r\n");
+    CHECK(!noTerminator.done && !noTerminator.failed);
+}
+
+TEST_CASE(chunked, malformed_framing) {
+    CHECK(fails("\r\n"));                                   // Tamanho ausente
+    CHECK(fails(" 5\r\nhello\r\n0\r\n\r\n"));               // Espaço antes do tamanho
+    CHECK(fails("-5\r\nhello\r\n0\r\n\r\n"));
+    CHECK(fails("0x5\r\nhello\r\n0\r\n\r\n"));
+    CHECK(fails("g\r\n"));
+    CHECK(fails("1000000000000000\r\n"));                   // 16 dígitos: estouraria 64 bits
+    CHECK(fails("5\nhello\r\n0\r\n\r\n"));                  // LF solto depois do tamanho
+    CHECK(fails("5\r\nhelloX\r\n0\r\n\r\n"));               // Dados além do tamanho declarado
+    CHECK(fails("5\r\nhello\n0\r\n\r\n"));
+    CHECK(fails("5\r\nhello\r\n0\r\n\n"));                  // Fim sem CRLF
+    CHECK(fails("5;ext\nhello\r\n0\r\n\r\n"));              // LF solto na extensão
+    CHECK(fails("0\r\nX-Trailer: a\n\r\n"));                // LF solto num trailer
+    CHECK(fails("0\r\nX-Trailer: a\rb\r\n\r\n"));
+}
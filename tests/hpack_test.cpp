@@ -0,0 +1,153 @@
+#include "test_support.h"
+#include "hpack.h"
+
+namespace {
+
+constexpr size_t kNoLimit = 1 << 20;
+
+bool decodeHex(HpackDecoder& decoder, const std::string& hex, HeaderList& headers, size_t limit = kNoLimit) {
+    std::string block = fromHex(hex);
+    bool tooLarge = false;
+    headers.clear();
+    return decoder.decode(reinterpret_cast<const uint8_t*>(block.data()), block.size(), limit, headers, tooLarge) &&
+           !tooLarge;
+}
+
+const char kDate1[] = "Mon, 21 Oct 2013 20:13:21 GMT";
+const char kDate2[] = "Mon, 21 Oct 2013 20:13:22 GMT";
+const char kLocation[] = "https://www.example.com";
+const char kCookie[] = "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1";
+
+}
+
+// RFC 7541, C.2: representações isoladas
+TEST_CASE(hpack, field_representations) {
+    HeaderList headers;
+    HpackDecoder literalIndexed;
+    CHECK(decodeHex(literalIndexed, "400a 6375 7374 6f6d 2d6b 6579 0d63 7573 746f 6d2d 6865 6164 6572", headers));
+    CHECK((headers == HeaderList{{"custom-key", "custom-header"}}));
+    // A entrada foi para a tabela dinâmica: índice 62
+    CHECK(decodeHex(literalIndexed, "be", headers));
+    CHECK((headers == HeaderList{{"custom-key", "custom-header"}}));
+
+    HpackDecoder decoder;
+    CHECK(decodeHex(decoder, "040c 2f73 616d 706c 652f 7061 7468", headers));
+    CHECK((headers == HeaderList{{":path", "/sample/path"}}));
+    CHECK(decodeHex(decoder, "1008 7061 7373 776f 7264 0673 6563 7265 74", headers));
+    CHECK((headers == HeaderList{{"password", "secret"}}));
+    CHECK(decodeHex(decoder, "82", headers));
+    CHECK((headers == HeaderList{{":method", "GET"}}));
+    // Sem indexação: a tabela dinâmica continua vazia
+    CHECK(!decodeHex(decoder, "be", headers));
+}
+
+// RFC 7541, C.3: requisições em sequência, sem Huffman
+TEST_CASE(hpack, requests_without_huffman) {
+    HpackDecoder decoder;
+    HeaderList headers;
+    CHECK(decodeHex(decoder, "8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d", headers));
+    CHECK((headers == HeaderList{{":method", "GET"}, {":scheme", "http"}, {":path", "/"},
+                                 {":authority", "www.example.com"}}));
+    CHECK(decodeHex(decoder, "8286 84be 5808 6e6f 2d63 6163 6865", headers));
+    CHECK((headers == HeaderList{{":method", "GET"}, {":scheme", "http"}, {":path", "/"},
+                                 {":authority", "www.example.com"}, {"cache-control", "no-cache"}}));
+    CHECK(decodeHex(decoder, "8287 85bf 400a 6375 7374 6f6d 2d6b 6579 0c63 7573 746f 6d2d 7661 6c75 65", headers));
+    CHECK((headers == HeaderList{{":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"},
+                                 {":authority", "www.example.com"}, {"custom-key", "custom-value"}}));
+}
+
+// RFC 7541, C.4: as mesmas requisições com Huffman
+TEST_CASE(hpack, requests_with_huffman) {
+    HpackDecoder decoder;
+    HeaderList headers;
+    CHECK(decodeHex(decoder, "8286 8441 8cf1 e3c2 e5f2 3a6b a0ab 90f4 ff", headers));
+    CHECK((headers == HeaderList{{":method", "GET"}, {":scheme", "http"}, {":path", "/"},
+                                 {":authority", "www.example.com"}}));
+    CHECK(decodeHex(decoder, "8286 84be 5886 a8eb 1064 9cbf", headers));
+    CHECK((headers == HeaderList{{":method", "GET"}, {":scheme", "http"}, {":path", "/"},
+                                 {":authority", "www.example.com"}, {"cache-control", "no-cache"}}));
+    CHECK(decodeHex(decoder, "8287 85bf 4088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf", headers));
+    CHECK((headers == HeaderList{{":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"},
+                                 {":authority", "www.example.com"}, {"custom-key", "custom-value"}}));
+}
+
+// RFC 7541, C.5: respostas com tabela de 256 bytes, forçando despejos
+TEST_CASE(hpack, responses_with_eviction) {
+    HpackDecoder decoder(256);
+    HeaderList headers;
+    CHECK(decodeHex(decoder,
+                    "4803 3330 3258 0770 7269 7661 7465 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a "
+                    "3133 3a32 3120 474d 546e 1768 7474 7073 3a2f 2f77 7777 2e65 7861 6d70 6c65 2e63 6f6d",
+                    headers));
+    CHECK((headers == HeaderList{{":status", "302"}, {"cache-control", "private"}, {"date", kDate1},
+                                 {"location", kLocation}}));
+    CHECK(decodeHex(decoder, "4803 3330 37c1 c0bf", headers));
+    CHECK((headers == HeaderList{{":status", "307"}, {"cache-control", "private"}, {"date", kDate1},
+                                 {"location", kLocation}}));
+    CHECK(decodeHex(decoder,
+                    "88c1 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a 3133 3a32 3220 474d 54c0 5a04 "
+                    "677a 6970 7738 666f 6f3d 4153 444a 4b48 514b 425a 584f 5157 454f 5049 5541 5851 5745 4f49 "
+                    "553b 206d 6178 2d61 6765 3d33 3630 303b 2076 6572 7369 6f6e 3d31",
+                    headers));
+    CHECK((headers == HeaderList{{":status", "200"}, {"cache-control", "private"}, {"date", kDate2},
+                                 {"location", kLocation}, {"content-encoding", "gzip"}, {"set-cookie", kCookie}}));
+}
+
+TEST_CASE(hpack, malformed_blocks) {
+    HeaderList headers;
+    HpackDecoder decoder;
+    CHECK(!decodeHex(decoder, "80", headers));                  // Índice 0
+    CHECK(!decodeHex(decoder, "ff80 8080 8080 8080 8080 01", headers));    // Inteiro longo demais
+    CHECK(!decodeHex(decoder, "040c 2f73 616d", headers));      // String truncada
+    CHECK(!decodeHex(decoder, "0483 ffff ff", headers));        // Preenchimento Huffman com mais de 7 bits
+    CHECK(!decodeHex(decoder, "8220", headers));                // Tamanho de tabela depois de um campo
+}
+
+// A lista decodificada é limitada enquanto decodifica: um byte por campo indexado não pode render
+// uma entrada inteira da tabela a cada repetição
+TEST_CASE(hpack, list_limit_keeps_table_consistent) {
+    HpackDecoder decoder;
+    std::string block = fromHex("40 05") + "x-big" + fromHex("7f a1 1e") + std::string(4000, 'v');
+    block.append(1000, static_cast<char>(0xbe));
+
+    HeaderList headers;
+    bool tooLarge = false;
+    CHECK(decoder.decode(reinterpret_cast<const uint8_t*>(block.data()), block.size(), 64 * 1024, headers,
+                         tooLarge));
+    CHECK(tooLarge);
+    size_t listBytes = 0;
+    for (const auto& header : headers) {
+        listBytes += header.first.size() + header.second.size() + 32;
+    }
+    CHECK(listBytes <= 64 * 1024);
+
+    // A tabela seguiu o bloco inteiro: o próximo bloco da conexão ainda decodifica
+    CHECK(decodeHex(decoder, "be", headers));
+    CHECK(headers.size() == 1 && headers[0].first == "x-big" && headers[0].second.size() == 4000);
+}
+
+TEST_CASE(hpack, encoder_round_trip) {
+    std::string out;
+    HpackEncoder::encode(":method", "GET", out);
+    CHECK(out == fromHex("82"));
+
+    out.clear();
+    HpackEncoder::encode(":authority", "www.example.com", out);
+    CHECK(out == fromHex("018c f1e3 c2e5 f23a 6ba0 ab90 f4ff"));
+
+    out.clear();
+    HpackEncoder::encode("custom-key", "custom-value", out);
+    CHECK(out == fromHex("0088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf"));
+
+    out.clear();
+    HpackEncoder::encodeTableSizeZero(out);
+    HpackEncoder::encode(":status", "200", out);
+    HpackEncoder::encode("content-type", "text/html; charset=utf-8", out);
+    HpackEncoder::encode("x-binary", std::string("\x00\xff\x7f", 3), out);
+    HpackDecoder decoder;
+    HeaderList headers;
+    bool tooLarge = false;
+    CHECK(decoder.decode(reinterpret_cast<const uint8_t*>(out.data()), out.size(), kNoLimit, headers, tooLarge));
+    CHECK((headers == HeaderList{{":status", "200"}, {"content-type", "text/html; charset=utf-8"},
+                                 {"x-binary", std::string("\x00\xff\x7f", 3)}}));
+}
@@ -0,0 +1,126 @@
+#include "test_support.h"
+#include "http_utils.h"
+
+namespace {
+
+bool sameRanges(const std::vector<ByteRange>& ranges, const std::vector<ByteRange>& expected) {
+    if (ranges.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (ranges[i].offset != expected[i].offset || ranges[i].length != expected[i].length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool normalizesTo(const std::string& target, const std::string& expected) {
+    std::string path = target;
+    std::string query;
+    return normalizeRequestPath(path, query) && path == expected;
+}
+
+bool rejects(const std::string& target) {
+    std::string path = target;
+    std::string query;
+    return !normalizeRequestPath(path, query);
+}
+
+}
+
+// RFC 9110, 14.1.2: exemplos para uma representação de 10000 bytes
+TEST_CASE(range, rfc9110_examples) {
+    std::vector<ByteRange> ranges;
+    CHECK(parseRangeHeader("bytes=0-499", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{0, 500}}));
+    CHECK(parseRangeHeader("bytes=500-999", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{500, 500}}));
+    CHECK(parseRangeHeader("bytes=-500", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{9500, 500}}));
+    CHECK(parseRangeHeader("bytes=9500-", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{9500, 500}}));
+    CHECK(parseRangeHeader("bytes=0-0,-1", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{0, 1}, {9999, 1}}));
+    // 14.1.1: sobrepostos e com espaços continuam válidos
+    CHECK(parseRangeHeader("bytes=500-600,601-999", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{500, 101}, {601, 399}}));
+    CHECK(parseRangeHeader("bytes=500-700, 601-999", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{500, 201}, {601, 399}}));
+}
+
+TEST_CASE(range, clamping_and_unsatisfiable) {
+    std::vector<ByteRange> ranges;
+    // Último byte além do fim e sufixo maior que a representação são recortados
+    CHECK(parseRangeHeader("bytes=9000-20000", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{9000, 1000}}));
+    CHECK(parseRangeHeader("bytes=-20000", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{0, 10000}}));
+    // Só o intervalo que cabe é atendido
+    CHECK(parseRangeHeader("bytes=10000-,0-9", 10000, ranges) == RangeResult::Satisfiable);
+    CHECK(sameRanges(ranges, {{0, 10}}));
+
+    CHECK(parseRangeHeader("bytes=10000-", 10000, ranges) == RangeResult::Unsatisfiable);
+    CHECK(parseRangeHeader("bytes=-0", 10000, ranges) == RangeResult::Unsatisfiable);
+    CHECK(parseRangeHeader("bytes=0-", 0, ranges) == RangeResult::Unsatisfiable);
+}
+
+TEST_CASE(range, invalid_is_ignored) {
+    std::vector<ByteRange> ranges;
+    CHECK(parseRangeHeader("items=0-1", 10000, ranges) == RangeResult::None);
+    CHECK(parseRangeHeader("bytes=", 10000, ranges) == RangeResult::None);
+    CHECK(parseRangeHeader("bytes=5-2", 10000, ranges) == RangeResult::None);
+    CHECK(parseRangeHeader("bytes=abc", 10000, ranges) == RangeResult::None);
+    CHECK(parseRangeHeader("bytes=1-2-3", 10000, ranges) == RangeResult::None);
+    CHECK(parseRangeHeader("bytes=-", 10000, ranges) == RangeResult::None);
+    CHECK(parseRangeHeader("bytes=99999999999999999999-", 10000, ranges) == RangeResult::None);
+    // Mais intervalos que o limite: o header inteiro é ignorado
+    CHECK(parseRangeHeader("bytes=0-0,2-2,4-4", 10000, ranges, 2) == RangeResult::None);
+}
+
+TEST_CASE(path, normalization) {
+    CHECK(normalizesTo("/", "/"));
+    CHECK(normalizesTo("/index.html", "/index.html"));
+    CHECK(normalizesTo("/a/b/../c", "/a/c"));
+    CHECK(normalizesTo("/a/./b", "/a/b"));
+    CHECK(normalizesTo("/a/b/..", "/a/"));
+    CHECK(normalizesTo("/a/.", "/a/"));
+    CHECK(normalizesTo("/.", "/"));
+    CHECK(normalizesTo("//a///b", "/a/b"));
+    CHECK(normalizesTo("/%41%62c", "/Abc"));
+    CHECK(normalizesTo("/a%zz", "/a%zz"));
+    CHECK(normalizesTo("/x#frag", "/x"));
+
+    std::string path = "/search?q=a/../b";
+    std::string query;
+    CHECK(normalizeRequestPath(path, query) && path == "/search" && query == "q=a/../b");
+}
+
+TEST_CASE(path, traversal_is_rejected) {
+    CHECK(rejects("/.."));
+    CHECK(rejects("/../etc/passwd"));
+    CHECK(rejects("/a/../.."));
+    CHECK(rejects("/a/b/../../../c"));
+    CHECK(rejects("/%2e%2e/etc/passwd"));
+    CHECK(rejects("/%2E%2E%2Fetc%2Fpasswd"));
+    CHECK(rejects("/a/%2e%2e/%2e%2e/x"));
+    CHECK(rejects("/..%5cwindows"));
+    CHECK(rejects("/a\\b"));
+    CHECK(rejects("/a%00b"));
+    CHECK(rejects("a/b"));
+    CHECK(rejects(""));
+    CHECK(rejects("?x"));
+}
+
+// O proxy repassa o caminho que escolheu a rota: escapes decodificados voltam escapados
+TEST_CASE(path, upstream_target) {
+    std::string path = "/admin/..%2Fapi/x";
+    std::string query;
+    CHECK(normalizeRequestPath(path, query) && encodeRequestTarget(path, query) == "/api/x");
+    CHECK(encodeRequestTarget("/a b", "") == "/a%20b");
+    CHECK(encodeRequestTarget("/a?b#c%d", "") == "/a%3Fb%23c%25d");
+    CHECK(encodeRequestTarget("/~user/a;b=c@d", "") == "/~user/a;b=c@d");
+    CHECK(encodeRequestTarget("/s", "q=a%20b&r=/x?y") == "/s?q=a%20b&r=/x?y");
+    CHECK(encodeRequestTarget("/s", "q=a\r\nx: y") == "/s?q=a%0D%0Ax:%20y");
+    CHECK(encodeRequestTarget("/\xc3\xa9", "") == "/%C3%A9");
+}
@@ -0,0 +1,34 @@
+#include "test_support.h"
+#include <cstring>
+
+std::vector<TestCase>& testRegistry() {
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+// Uso: unit-tests [grupo]; sem grupo roda todos
+int main(int argc, char* argv[]) {
+    const char* group = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+    for (const TestCase& test : testRegistry()) {
+        if (group && std::strcmp(group, test.group) != 0) {
+            continue;
+        }
+        int before = testFailures();
+        test.run();
+        std::printf("%s %s.%s\n", testFailures() == before ? "ok  " : "FAIL", test.group, test.name);
+        run++;
+    }
+
+    if (run == 0) {
+        std::fprintf(stderr, "Nenhum teste no grupo %s\n", group ? group : "(todos)");
+        return 1;
+    }
+    std::printf("%d testes, %d falhas\n", run, testFailures());
+    return testFailures() == 0 ? 0 : 1;
+}
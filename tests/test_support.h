@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Mínimo para os testes unitários, sem dependências: cada TEST_CASE se registra na carga do
+// executável e o main roda os do grupo pedido na linha de comando (um add_test por grupo)
+struct TestCase {
+    const char* group;
+    const char* name;
+    void (*run)();
+};
+
+std::vector<TestCase>& testRegistry();
+int& testFailures();
+
+struct TestRegistrar {
+    TestRegistrar(const char* group, const char* name, void (*run)()) {
+        testRegistry().push_back({group, name, run});
+    }
+};
+
+#define TEST_CASE(group, name)                                                              \
+    static void test_##group##_##name();                                                    \
+    static TestRegistrar registrar_##group##_##name(#group, #name, &test_##group##_##name); \
+    static void test_##group##_##name()
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            std::fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #condition);    \
+            ++testFailures();                                                               \
+        }                                                                                   \
+    } while (0)
+
+// Bytes a partir de hexadecimal como nas RFCs ("8286 8441"); espaços são ignorados
+inline std::string fromHex(const std::string& hex) {
+    std::string bytes;
+    int high = -1;
+    for (char c : hex) {
+        int value;
+        if (c >= '0' && c <= '9') value = c - '0';
+        else if (c >= 'a' && c <= 'f') value = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value = c - 'A' + 10;
+        else continue;
+        if (high < 0) {
+            high = value;
+        } else {
+            bytes.push_back(static_cast<char>(high * 16 + value));
+            high = -1;
+        }
+    }
+    return bytes;
+}